@@ -0,0 +1,762 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsMemory.h"
+#include "RCUtilsThread.h"
+#include <algorithm>
+
+struct FBVHBuildSettings
+{
+	uint32 MaxLeafSize = 4;
+	uint32 NumBins = 16;
+	float TraversalCost = 1.0f;
+	float IntersectionCost = 1.0f;
+
+	// 0 = one per hardware thread
+	uint32 NumThreads = 0;
+
+	// Subtrees smaller than this are built on one thread
+	uint32 MinParallelPrimitives = 4096;
+};
+
+struct FBVHHit
+{
+	float T = FLT_MAX;
+	float U = 0.0f;
+	float V = 0.0f;
+	uint32 PrimitiveId = 0xffffffff;
+
+	bool IsValid() const
+	{
+		return PrimitiveId != 0xffffffff;
+	}
+};
+
+// 32 bytes; the two children of an interior node are always adjacent in the node array
+struct FBVHNode
+{
+	FVector3 Min;
+	uint32 FirstChildOrPrimitive;
+	FVector3 Max;
+	uint32 NumPrimitives;
+
+	bool IsLeaf() const
+	{
+		return NumPrimitives > 0;
+	}
+
+	FAABB GetBounds() const
+	{
+		return FAABB(Min, Max);
+	}
+
+	void SetBounds(const FAABB& Box)
+	{
+		Min = Box.Min;
+		Max = Box.Max;
+	}
+};
+
+// Binary BVH over an indexed triangle list built with binned SAH. The vertex and index arrays are not
+// copied and must outlive the BVH; Refit() can point it at new vertex positions with the same topology.
+class FBVH
+{
+public:
+	void Build(const FVector3* InVertices, const uint32* InIndices, uint32 NumTriangles, const FBVHBuildSettings& Settings = FBVHBuildSettings())
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		checkAlways(Settings.NumBins >= 2 && Settings.NumBins <= MaxBins);
+		Vertices = InVertices;
+		Indices = InIndices;
+		Nodes.clear();
+		PrimitiveIndices.resize(NumTriangles);
+		if (NumTriangles == 0)
+		{
+			return;
+		}
+
+		FBuildContext Context(Settings, NumTriangles);
+
+		uint32 NumThreads = Settings.NumThreads ? Settings.NumThreads : RCUtils::GetNumHardwareThreads();
+		const uint32 ChunkSize = 16384;
+		RCUtils::ParallelFor((NumTriangles + ChunkSize - 1) / ChunkSize, [&](uint32 Chunk)
+		{
+			uint32 End = Min(NumTriangles, (Chunk + 1) * ChunkSize);
+			for (uint32 Index = Chunk * ChunkSize; Index < End; ++Index)
+			{
+				PrimitiveIndices[Index] = Index;
+				Context.PrimitiveBounds[Index] = GetTriangleBounds(Index);
+				Context.Centroids[Index] = Context.PrimitiveBounds[Index].GetCenter();
+			}
+		}, NumThreads);
+
+		// A binary tree with N leaves has at most 2N - 1 nodes
+		Nodes.resize(2 * (size_t)NumTriangles);
+
+		// Split on one thread until there are enough large subtrees to keep every thread busy, then
+		// finish each subtree independently; nodes are handed out in pairs from an atomic counter
+		std::vector<FBuildTask> Tasks;
+		Tasks.push_back({0, 0, NumTriangles, 0});
+		while (!Tasks.empty() && Tasks.size() < NumThreads * 4)
+		{
+			auto Largest = std::max_element(Tasks.begin(), Tasks.end(), [](const FBuildTask& A, const FBuildTask& B) { return A.End - A.Begin < B.End - B.Begin; });
+			if (Largest->End - Largest->Begin < Settings.MinParallelPrimitives)
+			{
+				break;
+			}
+
+			FBuildTask Task = *Largest;
+			Tasks.erase(Largest);
+			FBuildTask Children[2];
+			if (SplitNode(Context, Task, Children))
+			{
+				Tasks.push_back(Children[0]);
+				Tasks.push_back(Children[1]);
+			}
+		}
+
+		RCUtils::ParallelFor((uint32)Tasks.size(), [&](uint32 TaskIndex)
+		{
+			BuildSubtree(Context, Tasks[TaskIndex]);
+		}, NumThreads);
+
+		Nodes.resize(Context.NextNode.load());
+	}
+
+	// Recomputes bounds bottom up after vertices moved; the tree topology is kept
+	void Refit(const FVector3* NewVertices = nullptr)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (NewVertices)
+		{
+			Vertices = NewVertices;
+		}
+
+		// Children are always allocated after their parent, so a reverse sweep sees children first
+		for (size_t NodeIndex = Nodes.size(); NodeIndex-- > 0;)
+		{
+			FBVHNode& Node = Nodes[NodeIndex];
+			FAABB Box = FAABB::GetEmpty();
+			if (Node.IsLeaf())
+			{
+				for (uint32 Index = 0; Index < Node.NumPrimitives; ++Index)
+				{
+					Box.Add(GetTriangleBounds(PrimitiveIndices[Node.FirstChildOrPrimitive + Index]));
+				}
+			}
+			else
+			{
+				Box.Add(Nodes[Node.FirstChildOrPrimitive].GetBounds());
+				Box.Add(Nodes[Node.FirstChildOrPrimitive + 1].GetBounds());
+			}
+			Node.SetBounds(Box);
+		}
+	}
+
+	// Closest hit; shortens Ray.TMax to the hit distance
+	bool Intersect(FRay& Ray, FBVHHit& OutHit) const
+	{
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		uint32 Stack[MaxStackDepth];
+		uint32 StackSize = 0;
+		uint32 NodeIndex = 0;
+		float TNear;
+		float TFar;
+		if (!IntersectRayAABB(Ray, Nodes[0].GetBounds(), TNear, TFar))
+		{
+			return false;
+		}
+
+		for (;;)
+		{
+			const FBVHNode& Node = Nodes[NodeIndex];
+			if (Node.IsLeaf())
+			{
+				for (uint32 Index = 0; Index < Node.NumPrimitives; ++Index)
+				{
+					uint32 Primitive = PrimitiveIndices[Node.FirstChildOrPrimitive + Index];
+					float T, U, V;
+					if (IntersectTriangle(Ray, Primitive, T, U, V))
+					{
+						Ray.TMax = T;
+						OutHit.T = T;
+						OutHit.U = U;
+						OutHit.V = V;
+						OutHit.PrimitiveId = Primitive;
+					}
+				}
+			}
+			else
+			{
+				// Visit the nearer child first, defer the other
+				uint32 Child0 = Node.FirstChildOrPrimitive;
+				uint32 Child1 = Child0 + 1;
+				float TNear0, TNear1;
+				bool bHit0 = IntersectRayAABB(Ray, Nodes[Child0].GetBounds(), TNear0, TFar);
+				bool bHit1 = IntersectRayAABB(Ray, Nodes[Child1].GetBounds(), TNear1, TFar);
+				if (bHit0 && bHit1)
+				{
+					if (TNear1 < TNear0)
+					{
+						std::swap(Child0, Child1);
+					}
+					check(StackSize < MaxStackDepth);
+					Stack[StackSize++] = Child1;
+					NodeIndex = Child0;
+					continue;
+				}
+				else if (bHit0 || bHit1)
+				{
+					NodeIndex = bHit0 ? Child0 : Child1;
+					continue;
+				}
+			}
+
+			// Pop, skipping nodes the ray has since been clipped away from
+			bool bFound = false;
+			while (StackSize > 0)
+			{
+				NodeIndex = Stack[--StackSize];
+				if (IntersectRayAABB(Ray, Nodes[NodeIndex].GetBounds(), TNear, TFar))
+				{
+					bFound = true;
+					break;
+				}
+			}
+			if (!bFound)
+			{
+				break;
+			}
+		}
+
+		return OutHit.IsValid();
+	}
+
+	// Any hit in [TMin, TMax] (shadow/occlusion rays); stops at the first one found
+	bool IntersectAny(const FRay& Ray) const
+	{
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		uint32 Stack[MaxStackDepth];
+		uint32 StackSize = 0;
+		Stack[StackSize++] = 0;
+		while (StackSize > 0)
+		{
+			const FBVHNode& Node = Nodes[Stack[--StackSize]];
+			float TNear, TFar;
+			if (!IntersectRayAABB(Ray, Node.GetBounds(), TNear, TFar))
+			{
+				continue;
+			}
+
+			if (Node.IsLeaf())
+			{
+				for (uint32 Index = 0; Index < Node.NumPrimitives; ++Index)
+				{
+					float T, U, V;
+					if (IntersectTriangle(Ray, PrimitiveIndices[Node.FirstChildOrPrimitive + Index], T, U, V))
+					{
+						return true;
+					}
+				}
+			}
+			else
+			{
+				check(StackSize + 2 <= MaxStackDepth);
+				Stack[StackSize++] = Node.FirstChildOrPrimitive + 1;
+				Stack[StackSize++] = Node.FirstChildOrPrimitive;
+			}
+		}
+		return false;
+	}
+
+	// Appends the triangles whose bounds overlap Box
+	void QueryOverlaps(const FAABB& Box, std::vector<uint32>& OutPrimitives) const
+	{
+		if (Nodes.empty())
+		{
+			return;
+		}
+
+		uint32 Stack[MaxStackDepth];
+		uint32 StackSize = 0;
+		Stack[StackSize++] = 0;
+		while (StackSize > 0)
+		{
+			const FBVHNode& Node = Nodes[Stack[--StackSize]];
+			if (!Node.GetBounds().Overlaps(Box))
+			{
+				continue;
+			}
+
+			if (Node.IsLeaf())
+			{
+				for (uint32 Index = 0; Index < Node.NumPrimitives; ++Index)
+				{
+					uint32 Primitive = PrimitiveIndices[Node.FirstChildOrPrimitive + Index];
+					if (GetTriangleBounds(Primitive).Overlaps(Box))
+					{
+						OutPrimitives.push_back(Primitive);
+					}
+				}
+			}
+			else
+			{
+				check(StackSize + 2 <= MaxStackDepth);
+				Stack[StackSize++] = Node.FirstChildOrPrimitive + 1;
+				Stack[StackSize++] = Node.FirstChildOrPrimitive;
+			}
+		}
+	}
+
+	bool IntersectTriangle(const FRay& Ray, uint32 Primitive, float& OutT, float& OutU, float& OutV) const
+	{
+		const uint32* Tri = Indices + Primitive * 3;
+		return IntersectRayTriangle(Ray, Vertices[Tri[0]], Vertices[Tri[1]], Vertices[Tri[2]], OutT, OutU, OutV);
+	}
+
+	FAABB GetTriangleBounds(uint32 Primitive) const
+	{
+		const uint32* Tri = Indices + Primitive * 3;
+		FAABB Box(Vertices[Tri[0]], Vertices[Tri[0]]);
+		Box.Add(Vertices[Tri[1]]);
+		Box.Add(Vertices[Tri[2]]);
+		return Box;
+	}
+
+	const std::vector<FBVHNode>& GetNodes() const
+	{
+		return Nodes;
+	}
+
+	const std::vector<uint32>& GetPrimitiveIndices() const
+	{
+		return PrimitiveIndices;
+	}
+
+	// Build() stops splitting at MaxStackDepth - 1 levels below the root, so the fixed traversal stacks can't
+	// overflow however degenerate the input is
+	enum
+	{
+		MaxBins = 64,
+		MaxStackDepth = 128,
+	};
+
+protected:
+	struct FBuildTask
+	{
+		uint32 NodeIndex;
+		uint32 Begin;
+		uint32 End;
+		uint32 Depth;
+	};
+
+	// Scratch for one Build(); keeping it out of the class leaves FBVH a plain copyable value
+	struct FBuildContext
+	{
+		FBuildContext(const FBVHBuildSettings& InSettings, uint32 NumTriangles)
+			: Settings(InSettings)
+			, PrimitiveBounds(NumTriangles)
+			, Centroids(NumTriangles)
+		{
+		}
+
+		const FBVHBuildSettings& Settings;
+		RCUtils::TTaggedVector<FAABB, RCUtils::EMemoryTag::Math> PrimitiveBounds;
+		RCUtils::TTaggedVector<FVector3, RCUtils::EMemoryTag::Math> Centroids;
+
+		// Nodes are handed out in pairs; 0 is the root
+		std::atomic<uint32> NextNode{1};
+	};
+
+	// Writes the node for Task; returns false if it became a leaf, otherwise the two child tasks
+	bool SplitNode(FBuildContext& Context, const FBuildTask& Task, FBuildTask (&OutChildren)[2])
+	{
+		const FBVHBuildSettings& Settings = Context.Settings;
+		const auto& PrimitiveBounds = Context.PrimitiveBounds;
+		const auto& Centroids = Context.Centroids;
+		uint32 Count = Task.End - Task.Begin;
+		FAABB Bounds = FAABB::GetEmpty();
+		FAABB CentroidBounds = FAABB::GetEmpty();
+		for (uint32 Index = Task.Begin; Index < Task.End; ++Index)
+		{
+			uint32 Primitive = PrimitiveIndices[Index];
+			Bounds.Add(PrimitiveBounds[Primitive]);
+			CentroidBounds.Add(Centroids[Primitive]);
+		}
+
+		FBVHNode& Node = Nodes[Task.NodeIndex];
+		Node.SetBounds(Bounds);
+		Node.FirstChildOrPrimitive = Task.Begin;
+		Node.NumPrimitives = Count;
+		if (Count <= 1 || Task.Depth + 2 > MaxStackDepth)
+		{
+			return false;
+		}
+
+		// Bin centroids along each axis and sweep for the cheapest SAH split
+		uint32 NumBins = Settings.NumBins;
+		float BestCost = FLT_MAX;
+		int32 BestAxis = -1;
+		uint32 BestSplit = 0;
+		FVector3 Extent = CentroidBounds.GetExtent();
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (Extent.Values[Axis] <= 0.0f)
+			{
+				continue;
+			}
+
+			FAABB BinBounds[MaxBins];
+			uint32 BinCounts[MaxBins] = {};
+			for (uint32 Bin = 0; Bin < NumBins; ++Bin)
+			{
+				BinBounds[Bin] = FAABB::GetEmpty();
+			}
+
+			float Scale = (float)NumBins / Extent.Values[Axis];
+			for (uint32 Index = Task.Begin; Index < Task.End; ++Index)
+			{
+				uint32 Primitive = PrimitiveIndices[Index];
+				uint32 Bin = GetBin(Centroids[Primitive].Values[Axis], CentroidBounds.Min.Values[Axis], Scale, NumBins);
+				++BinCounts[Bin];
+				BinBounds[Bin].Add(PrimitiveBounds[Primitive]);
+			}
+
+			// Right to left sweep stores suffix areas, left to right sweep evaluates each split plane
+			float RightAreas[MaxBins];
+			FAABB Right = FAABB::GetEmpty();
+			uint32 RightCount = 0;
+			for (uint32 Bin = NumBins - 1; Bin > 0; --Bin)
+			{
+				Right.Add(BinBounds[Bin]);
+				RightCount += BinCounts[Bin];
+				RightAreas[Bin] = RightCount > 0 ? Right.GetSurfaceArea() * RightCount : 0.0f;
+			}
+
+			FAABB Left = FAABB::GetEmpty();
+			uint32 LeftCount = 0;
+			for (uint32 Split = 1; Split < NumBins; ++Split)
+			{
+				Left.Add(BinBounds[Split - 1]);
+				LeftCount += BinCounts[Split - 1];
+				if (LeftCount == 0 || LeftCount == Count)
+				{
+					continue;
+				}
+
+				float Cost = Left.GetSurfaceArea() * LeftCount + RightAreas[Split];
+				if (Cost < BestCost)
+				{
+					BestCost = Cost;
+					BestAxis = Axis;
+					BestSplit = Split;
+				}
+			}
+		}
+
+		float LeafCost = Settings.IntersectionCost * Count;
+		float SplitCost = Settings.TraversalCost + Settings.IntersectionCost * BestCost / Max(Bounds.GetSurfaceArea(), FLT_MIN);
+		uint32 Middle;
+		if (BestAxis < 0)
+		{
+			// Every centroid coincides; split by count if the leaf would be too big
+			if (Count <= Settings.MaxLeafSize)
+			{
+				return false;
+			}
+			Middle = Task.Begin + Count / 2;
+		}
+		else
+		{
+			if (SplitCost >= LeafCost && Count <= Settings.MaxLeafSize)
+			{
+				return false;
+			}
+
+			float Scale = (float)NumBins / Extent.Values[BestAxis];
+			float AxisMin = CentroidBounds.Min.Values[BestAxis];
+			uint32* Mid = std::partition(PrimitiveIndices.data() + Task.Begin, PrimitiveIndices.data() + Task.End, [&](uint32 Primitive)
+			{
+				return GetBin(Centroids[Primitive].Values[BestAxis], AxisMin, Scale, NumBins) < BestSplit;
+			});
+			Middle = (uint32)(Mid - PrimitiveIndices.data());
+		}
+
+		uint32 FirstChild = Context.NextNode.fetch_add(2);
+		Node.FirstChildOrPrimitive = FirstChild;
+		Node.NumPrimitives = 0;
+		OutChildren[0] = { FirstChild, Task.Begin, Middle, Task.Depth + 1 };
+		OutChildren[1] = { FirstChild + 1, Middle, Task.End, Task.Depth + 1 };
+		return true;
+	}
+
+	void BuildSubtree(FBuildContext& Context, const FBuildTask& Root)
+	{
+		std::vector<FBuildTask> Stack;
+		Stack.push_back(Root);
+		while (!Stack.empty())
+		{
+			FBuildTask Task = Stack.back();
+			Stack.pop_back();
+			FBuildTask Children[2];
+			if (SplitNode(Context, Task, Children))
+			{
+				Stack.push_back(Children[1]);
+				Stack.push_back(Children[0]);
+			}
+		}
+	}
+
+	static uint32 GetBin(float Centroid, float AxisMin, float Scale, uint32 NumBins)
+	{
+		return Min((uint32)((Centroid - AxisMin) * Scale), NumBins - 1);
+	}
+
+	const FVector3* Vertices = nullptr;
+	const uint32* Indices = nullptr;
+	std::vector<FBVHNode> Nodes;
+	std::vector<uint32> PrimitiveIndices;
+};
+
+// N-wide BVH (4 or 8) collapsed from a binary one, so a single SIMD box test covers all children
+template <uint32 N>
+struct TWideBVHNode
+{
+	enum : uint32
+	{
+		EmptyChild = 0xffffffff,
+	};
+
+	TAABBSoA<N> Bounds;
+
+	// NumPrimitives == 0: Child is an inner node index (or EmptyChild); otherwise Child is the first primitive
+	uint32 Child[N];
+	uint32 NumPrimitives[N];
+};
+
+template <uint32 N>
+class TWideBVH
+{
+public:
+	// Rebuilding from a refit FBVH is linear, which is how animated geometry refits the wide tree
+	void Build(const FBVH& InBVH)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		BVH = &InBVH;
+		Nodes.clear();
+		const std::vector<FBVHNode>& BinaryNodes = InBVH.GetNodes();
+		if (BinaryNodes.empty())
+		{
+			return;
+		}
+
+		Nodes.reserve(BinaryNodes.size() / 2 + 1);
+		Nodes.emplace_back();
+		std::vector<std::pair<uint32, uint32>> Pending;
+		Pending.push_back(std::make_pair(0u, 0u));
+		while (!Pending.empty())
+		{
+			uint32 WideIndex = Pending.back().first;
+			uint32 BinaryIndex = Pending.back().second;
+			Pending.pop_back();
+
+			// Open the child with the largest surface area until there are N children
+			uint32 Children[N];
+			uint32 NumChildren = 0;
+			if (BinaryNodes[BinaryIndex].IsLeaf())
+			{
+				Children[NumChildren++] = BinaryIndex;
+			}
+			else
+			{
+				Children[NumChildren++] = BinaryNodes[BinaryIndex].FirstChildOrPrimitive;
+				Children[NumChildren++] = BinaryNodes[BinaryIndex].FirstChildOrPrimitive + 1;
+			}
+
+			while (NumChildren < N)
+			{
+				int32 BestChild = -1;
+				float BestArea = -1.0f;
+				for (uint32 Index = 0; Index < NumChildren; ++Index)
+				{
+					const FBVHNode& Node = BinaryNodes[Children[Index]];
+					float Area = Node.GetBounds().GetSurfaceArea();
+					if (!Node.IsLeaf() && Area > BestArea)
+					{
+						BestArea = Area;
+						BestChild = (int32)Index;
+					}
+				}
+				if (BestChild < 0)
+				{
+					break;
+				}
+
+				uint32 First = BinaryNodes[Children[BestChild]].FirstChildOrPrimitive;
+				Children[BestChild] = First;
+				Children[NumChildren++] = First + 1;
+			}
+
+			for (uint32 Lane = 0; Lane < N; ++Lane)
+			{
+				TWideBVHNode<N>& WideNode = Nodes[WideIndex];
+				if (Lane >= NumChildren)
+				{
+					WideNode.Bounds.SetEmpty(Lane);
+					WideNode.Child[Lane] = TWideBVHNode<N>::EmptyChild;
+					WideNode.NumPrimitives[Lane] = 0;
+					continue;
+				}
+
+				const FBVHNode& Node = BinaryNodes[Children[Lane]];
+				WideNode.Bounds.SetBox(Lane, Node.GetBounds());
+				if (Node.IsLeaf())
+				{
+					WideNode.Child[Lane] = Node.FirstChildOrPrimitive;
+					WideNode.NumPrimitives[Lane] = Node.NumPrimitives;
+				}
+				else
+				{
+					uint32 NewIndex = (uint32)Nodes.size();
+					Nodes.emplace_back();
+					Nodes[WideIndex].Child[Lane] = NewIndex;
+					Nodes[WideIndex].NumPrimitives[Lane] = 0;
+					Pending.push_back(std::make_pair(NewIndex, Children[Lane]));
+				}
+			}
+		}
+	}
+
+	bool Intersect(FRay& Ray, FBVHHit& OutHit) const
+	{
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		struct FEntry
+		{
+			uint32 Child;
+			uint32 NumPrimitives;
+			float TNear;
+		};
+
+		FEntry Stack[FBVH::MaxStackDepth * N];
+		uint32 StackSize = 0;
+		Stack[StackSize++] = { 0, 0, 0.0f };
+		const std::vector<uint32>& Primitives = BVH->GetPrimitiveIndices();
+		while (StackSize > 0)
+		{
+			FEntry Entry = Stack[--StackSize];
+			if (Entry.TNear > Ray.TMax)
+			{
+				continue;
+			}
+
+			if (Entry.NumPrimitives > 0)
+			{
+				for (uint32 Index = 0; Index < Entry.NumPrimitives; ++Index)
+				{
+					uint32 Primitive = Primitives[Entry.Child + Index];
+					float T, U, V;
+					if (BVH->IntersectTriangle(Ray, Primitive, T, U, V))
+					{
+						Ray.TMax = T;
+						OutHit.T = T;
+						OutHit.U = U;
+						OutHit.V = V;
+						OutHit.PrimitiveId = Primitive;
+					}
+				}
+				continue;
+			}
+
+			const TWideBVHNode<N>& Node = Nodes[Entry.Child];
+			float TNear[N];
+			uint32 Mask = IntersectRayAABBs(Ray, Node.Bounds, TNear);
+
+			// Push hits far to near so the nearest child is popped first
+			check(StackSize + N <= FBVH::MaxStackDepth * N);
+			uint32 First = StackSize;
+			for (uint32 Lane = 0; Lane < N; ++Lane)
+			{
+				if (Mask & (1u << Lane))
+				{
+					FEntry Child = { Node.Child[Lane], Node.NumPrimitives[Lane], TNear[Lane] };
+					uint32 Insert = StackSize++;
+					while (Insert > First && Stack[Insert - 1].TNear < Child.TNear)
+					{
+						Stack[Insert] = Stack[Insert - 1];
+						--Insert;
+					}
+					Stack[Insert] = Child;
+				}
+			}
+		}
+
+		return OutHit.IsValid();
+	}
+
+	bool IntersectAny(const FRay& Ray) const
+	{
+		if (Nodes.empty())
+		{
+			return false;
+		}
+
+		uint32 Stack[FBVH::MaxStackDepth * N];
+		uint32 StackSize = 0;
+		Stack[StackSize++] = 0;
+		const std::vector<uint32>& Primitives = BVH->GetPrimitiveIndices();
+		while (StackSize > 0)
+		{
+			const TWideBVHNode<N>& Node = Nodes[Stack[--StackSize]];
+			float TNear[N];
+			uint32 Mask = IntersectRayAABBs(Ray, Node.Bounds, TNear);
+			for (uint32 Lane = 0; Lane < N; ++Lane)
+			{
+				if (!(Mask & (1u << Lane)))
+				{
+					continue;
+				}
+
+				if (Node.NumPrimitives[Lane] == 0)
+				{
+					check(StackSize < FBVH::MaxStackDepth * N);
+					Stack[StackSize++] = Node.Child[Lane];
+					continue;
+				}
+
+				for (uint32 Index = 0; Index < Node.NumPrimitives[Lane]; ++Index)
+				{
+					float T, U, V;
+					if (BVH->IntersectTriangle(Ray, Primitives[Node.Child[Lane] + Index], T, U, V))
+					{
+						return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	const std::vector<TWideBVHNode<N>>& GetNodes() const
+	{
+		return Nodes;
+	}
+
+protected:
+	const FBVH* BVH = nullptr;
+	std::vector<TWideBVHNode<N>> Nodes;
+};
+
+typedef TWideBVH<4> FBVH4;
+typedef TWideBVH<8> FBVH8;
@@ -4,7 +4,9 @@
 
 #pragma warning(push)
 #pragma warning(disable:4530)
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <list>
 #include <vector>
@@ -19,7 +21,132 @@ typedef int32_t		int32;
 typedef uint64_t	uint64;
 typedef int64_t		int64;
 
-#define check(x) if (!(x)) __debugbreak();
+#if defined(_MSC_VER)
+#define RCUTILS_NOINLINE __declspec(noinline)
+#define RCUTILS_FORCEINLINE __forceinline
+#define RCUTILS_COLD
+#define RCUTILS_LIKELY(x) (x)
+#define RCUTILS_UNLIKELY(x) (x)
+#define RCUTILS_DEBUG_BREAK() __debugbreak()
+#else
+#define RCUTILS_NOINLINE __attribute__((noinline))
+#define RCUTILS_FORCEINLINE inline __attribute__((always_inline))
+#define RCUTILS_COLD __attribute__((cold))
+#define RCUTILS_LIKELY(x) __builtin_expect(!!(x), 1)
+#define RCUTILS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#if defined(__i386__) || defined(__x86_64__)
+#define RCUTILS_DEBUG_BREAK() __asm__ volatile("int3")
+#else
+#define RCUTILS_DEBUG_BREAK() __builtin_trap()
+#endif
+#endif
+
+// Assertion tiers, enabled up to RCUTILS_CHECK_LEVEL:
+//   1: checkAlways - cheap invariants and API misuse, kept in release builds
+//   2: check       - regular debug checks (default for debug builds)
+//   3: checkSlow   - paranoid checks in inner loops, opt in
+// Disabled checks do not evaluate their expression and generate no code.
+#ifndef RCUTILS_CHECK_LEVEL
+#if defined(_DEBUG) || !defined(NDEBUG)
+#define RCUTILS_CHECK_LEVEL 2
+#else
+#define RCUTILS_CHECK_LEVEL 1
+#endif
+#endif
+
+namespace RCUtils
+{
+	// Return true to break into the debugger, false to log and continue
+	typedef bool (*FCheckFailedHandler)(const char* Expression, const char* File, int Line);
+
+	inline FCheckFailedHandler& GetCheckFailedHandler()
+	{
+		static FCheckFailedHandler Handler = nullptr;
+		return Handler;
+	}
+
+	// nullptr restores the default (print to stderr and break)
+	inline void SetCheckFailedHandler(FCheckFailedHandler Handler)
+	{
+		GetCheckFailedHandler() = Handler;
+	}
+
+	namespace Internal
+	{
+		// Out of line so a check costs a compare and a never taken branch at the call site
+		RCUTILS_NOINLINE RCUTILS_COLD inline bool OnCheckFailed(const char* Expression, const char* File, int Line)
+		{
+			if (FCheckFailedHandler Handler = GetCheckFailedHandler())
+			{
+				return Handler(Expression, File, Line);
+			}
+
+			fprintf(stderr, "%s(%d): Check failed: %s\n", File, Line, Expression);
+			fflush(stderr);
+			return true;
+		}
+	}
+}
+
+// The break is expanded at the call site so the debugger stops on the failing line
+#define RCUTILS_CHECK_IMPL(x) \
+	do \
+	{ \
+		if (RCUTILS_UNLIKELY(!(x)) && RCUtils::Internal::OnCheckFailed(#x, __FILE__, __LINE__)) \
+		{ \
+			RCUTILS_DEBUG_BREAK(); \
+		} \
+	} while (0)
+#define RCUTILS_CHECK_DISABLED(x) ((void)sizeof(!(x)))
+
+#if RCUTILS_CHECK_LEVEL >= 1
+#define checkAlways(x) RCUTILS_CHECK_IMPL(x)
+#else
+#define checkAlways(x) RCUTILS_CHECK_DISABLED(x)
+#endif
+
+#if RCUTILS_CHECK_LEVEL >= 2
+#define check(x) RCUTILS_CHECK_IMPL(x)
+#else
+#define check(x) RCUTILS_CHECK_DISABLED(x)
+#endif
+
+#if RCUTILS_CHECK_LEVEL >= 3
+#define checkSlow(x) RCUTILS_CHECK_IMPL(x)
+#else
+#define checkSlow(x) RCUTILS_CHECK_DISABLED(x)
+#endif
+
+#define RCUTILS_JOIN_INNER(A, B) A##B
+#define RCUTILS_JOIN(A, B) RCUTILS_JOIN_INNER(A, B)
+
+// Scoped timing zones, compiled out unless RCUTILS_ENABLE_PROFILER is 1 (see RCUtilsProfiler.h).
+// Names must be string literals or otherwise outlive the capture.
+#ifndef RCUTILS_ENABLE_PROFILER
+#define RCUTILS_ENABLE_PROFILER 0
+#endif
+
+#if RCUTILS_ENABLE_PROFILER
+#define RCUTILS_PROFILE_SCOPE(Name) RCUtils::FProfileScope RCUTILS_JOIN(ProfileScope, __LINE__)(Name)
+#define RCUTILS_PROFILE_FUNCTION() RCUTILS_PROFILE_SCOPE(__FUNCTION__)
+#else
+#define RCUTILS_PROFILE_SCOPE(Name)
+#define RCUTILS_PROFILE_FUNCTION()
+#endif
+
+namespace RCUtils
+{
+	// fopen_s where the CRT wants it, plain fopen elsewhere; returns nullptr on failure
+	inline FILE* OpenStdioFile(const char* Filename, const char* Mode)
+	{
+#if defined(_MSC_VER)
+		FILE* File = nullptr;
+		return fopen_s(&File, Filename, Mode) == 0 ? File : nullptr;
+#else
+		return fopen(Filename, Mode);
+#endif
+	}
+}
 
 template <typename T>
 inline void MemZero(T& Struct)
@@ -55,3 +182,7 @@ inline void ZeroMem(T& Object)
 	const auto Size = sizeof(T);
 	memset(&Object, 0, Size);
 }
+
+#if RCUTILS_ENABLE_PROFILER
+#include "RCUtilsProfiler.h"
+#endif
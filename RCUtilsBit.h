@@ -2,6 +2,20 @@
 
 #include "RCUtilsBase.h"
 
+// pdep/pext are only worth it where they are single cycle; AMD before Zen 3 microcodes them, so those
+// builds should define RCUTILS_USE_BMI2=0
+#if !defined(RCUTILS_USE_BMI2)
+#if (defined(__BMI2__) || defined(__AVX2__)) && (defined(__x86_64__) || defined(_M_X64))
+#define RCUTILS_USE_BMI2 1
+#else
+#define RCUTILS_USE_BMI2 0
+#endif
+#endif
+
+#if RCUTILS_USE_BMI2
+#include <immintrin.h>
+#endif
+
 inline bool IsPowerOfTwo(uint64 N)
 {
 	return (N != 0) && !(N & (N - 1));
@@ -14,6 +28,23 @@ inline T Align(T Value, T Alignment)
 	return (Value + (Alignment - 1)) & ~(Alignment - 1);
 }
 
+inline uint64 RoundUpToPowerOfTwo(uint64 N)
+{
+	if (N <= 1)
+	{
+		return 1;
+	}
+
+	--N;
+	N |= N >> 1;
+	N |= N >> 2;
+	N |= N >> 4;
+	N |= N >> 8;
+	N |= N >> 16;
+	N |= N >> 32;
+	return N + 1;
+}
+
 
 // Naive implementation some compilers compile out to intrinsics
 template <typename T>
@@ -32,3 +63,96 @@ inline uint32 GetNumberOfBitsSet(T N)
 
 	return Count;
 }
+
+const uint64 MortonMask2 = 0x5555555555555555ull;
+const uint64 MortonMask3 = 0x1249249249249249ull;
+
+// Spreads the low 32 bits so there is a zero bit between each
+inline uint64 MortonSpread2(uint64 X)
+{
+	X &= 0xffffffffull;
+	X = (X | (X << 16)) & 0x0000ffff0000ffffull;
+	X = (X | (X << 8)) & 0x00ff00ff00ff00ffull;
+	X = (X | (X << 4)) & 0x0f0f0f0f0f0f0f0full;
+	X = (X | (X << 2)) & 0x3333333333333333ull;
+	X = (X | (X << 1)) & 0x5555555555555555ull;
+	return X;
+}
+
+inline uint32 MortonCompact2(uint64 X)
+{
+	X &= 0x5555555555555555ull;
+	X = (X | (X >> 1)) & 0x3333333333333333ull;
+	X = (X | (X >> 2)) & 0x0f0f0f0f0f0f0f0full;
+	X = (X | (X >> 4)) & 0x00ff00ff00ff00ffull;
+	X = (X | (X >> 8)) & 0x0000ffff0000ffffull;
+	X = (X | (X >> 16)) & 0x00000000ffffffffull;
+	return (uint32)X;
+}
+
+// Spreads the low 21 bits so there are two zero bits between each
+inline uint64 MortonSpread3(uint64 X)
+{
+	X &= 0x1fffffull;
+	X = (X | (X << 32)) & 0x001f00000000ffffull;
+	X = (X | (X << 16)) & 0x001f0000ff0000ffull;
+	X = (X | (X << 8)) & 0x100f00f00f00f00full;
+	X = (X | (X << 4)) & 0x10c30c30c30c30c3ull;
+	X = (X | (X << 2)) & 0x1249249249249249ull;
+	return X;
+}
+
+inline uint32 MortonCompact3(uint64 X)
+{
+	X &= 0x1249249249249249ull;
+	X = (X | (X >> 2)) & 0x10c30c30c30c30c3ull;
+	X = (X | (X >> 4)) & 0x100f00f00f00f00full;
+	X = (X | (X >> 8)) & 0x001f0000ff0000ffull;
+	X = (X | (X >> 16)) & 0x001f00000000ffffull;
+	X = (X | (X >> 32)) & 0x00000000001fffffull;
+	return (uint32)X;
+}
+
+// Z-order code of two 32 bit coordinates; X lands in the even bits
+inline uint64 MortonEncode2(uint32 X, uint32 Y)
+{
+#if RCUTILS_USE_BMI2
+	return _pdep_u64(X, MortonMask2) | _pdep_u64(Y, MortonMask2 << 1);
+#else
+	return MortonSpread2(X) | (MortonSpread2(Y) << 1);
+#endif
+}
+
+inline void MortonDecode2(uint64 Code, uint32& OutX, uint32& OutY)
+{
+#if RCUTILS_USE_BMI2
+	OutX = (uint32)_pext_u64(Code, MortonMask2);
+	OutY = (uint32)_pext_u64(Code, MortonMask2 << 1);
+#else
+	OutX = MortonCompact2(Code);
+	OutY = MortonCompact2(Code >> 1);
+#endif
+}
+
+// Z-order code of three 21 bit coordinates (higher bits are dropped); X lands in bit 0
+inline uint64 MortonEncode3(uint32 X, uint32 Y, uint32 Z)
+{
+#if RCUTILS_USE_BMI2
+	return _pdep_u64(X, MortonMask3) | _pdep_u64(Y, MortonMask3 << 1) | _pdep_u64(Z, MortonMask3 << 2);
+#else
+	return MortonSpread3(X) | (MortonSpread3(Y) << 1) | (MortonSpread3(Z) << 2);
+#endif
+}
+
+inline void MortonDecode3(uint64 Code, uint32& OutX, uint32& OutY, uint32& OutZ)
+{
+#if RCUTILS_USE_BMI2
+	OutX = (uint32)_pext_u64(Code, MortonMask3);
+	OutY = (uint32)_pext_u64(Code, MortonMask3 << 1);
+	OutZ = (uint32)_pext_u64(Code, MortonMask3 << 2);
+#else
+	OutX = MortonCompact3(Code);
+	OutY = MortonCompact3(Code >> 1);
+	OutZ = MortonCompact3(Code >> 2);
+#endif
+}
@@ -2,8 +2,64 @@
 
 #include "RCUtilsBase.h"
 
+#if !defined(_WIN32)
+#include <strings.h>
+#endif
+
 namespace RCUtils
 {
+	namespace Internal
+	{
+		inline int CompareNoCase(const char* A, const char* B)
+		{
+#if defined(_WIN32)
+			return _strcmpi(A, B);
+#else
+			return strcasecmp(A, B);
+#endif
+		}
+
+		inline int CompareNoCase(const char* A, const char* B, size_t Length)
+		{
+#if defined(_WIN32)
+			return _strnicmp(A, B, Length);
+#else
+			return strncasecmp(A, B, Length);
+#endif
+		}
+
+		// The CRT keeps the arguments in __argc/__argv; elsewhere they are read back from /proc where there is one
+		inline std::vector<std::string> GetProcessArguments()
+		{
+			std::vector<std::string> Arguments;
+#if defined(_WIN32)
+			for (int32 i = 0; i < __argc; ++i)
+			{
+				Arguments.push_back(__argv[i]);
+			}
+#elif defined(__linux__)
+			if (FILE* File = fopen("/proc/self/cmdline", "rb"))
+			{
+				std::string Argument;
+				for (int Char = fgetc(File); Char != EOF; Char = fgetc(File))
+				{
+					if (Char)
+					{
+						Argument += (char)Char;
+					}
+					else
+					{
+						Arguments.push_back(Argument);
+						Argument.clear();
+					}
+				}
+				fclose(File);
+			}
+#endif
+			return Arguments;
+		}
+	}
+
 	struct FCmdLine
 	{
 		static inline FCmdLine& Get()
@@ -14,14 +70,17 @@ namespace RCUtils
 
 		FCmdLine()
 		{
-			check(__argc > 0);
-			Exe = __argv[0];
+			std::vector<std::string> Arguments = Internal::GetProcessArguments();
+			if (!Arguments.empty())
+			{
+				Exe = Arguments[0];
+			}
 
-			for (int32 i = 1; i < __argc; ++i)
+			for (size_t i = 1; i < Arguments.size(); ++i)
 			{
-				FullCmdLine += __argv[i];
+				FullCmdLine += Arguments[i];
 				FullCmdLine += " ";
-				Args.push_back(__argv[i]);
+				Args.push_back(Arguments[i]);
 			}
 		}
 
@@ -30,7 +89,7 @@ namespace RCUtils
 			check(Value && *Value);
 			for (const auto& Arg : Args)
 			{
-				if (!_strcmpi(Value, Arg.c_str()))
+				if (!Internal::CompareNoCase(Value, Arg.c_str()))
 				{
 					return true;
 				}
@@ -45,7 +104,7 @@ namespace RCUtils
 			uint32 PrefixLength = (uint32)strlen(Prefix);
 			for (const auto& Arg : Args)
 			{
-				if (!_strnicmp(Arg.c_str(), Prefix, PrefixLength))
+				if (!Internal::CompareNoCase(Arg.c_str(), Prefix, PrefixLength))
 				{
 					const char* IntString = Arg.c_str() + PrefixLength;
 					return atoi(IntString);
@@ -61,7 +120,7 @@ namespace RCUtils
 			uint32 PrefixLength = (uint32)strlen(Prefix);
 			for (const auto& Arg : Args)
 			{
-				if (!_strnicmp(Arg.c_str(), Prefix, PrefixLength))
+				if (!Internal::CompareNoCase(Arg.c_str(), Prefix, PrefixLength))
 				{
 					const char* FloatString = Arg.c_str() + PrefixLength;
 					return (float)atof(FloatString);
@@ -77,7 +136,7 @@ namespace RCUtils
 			uint32 PrefixLength = (uint32)strlen(Prefix);
 			for (const auto& Arg : Args)
 			{
-				if (!_strnicmp(Arg.c_str(), Prefix, PrefixLength))
+				if (!Internal::CompareNoCase(Arg.c_str(), Prefix, PrefixLength))
 				{
 					OutValue = Arg.c_str() + PrefixLength;
 					return true;
@@ -0,0 +1,583 @@
+#pragma once
+
+#include "RCUtilsBase.h"
+#include "RCUtilsBit.h"
+#include "RCUtilsHash.h"
+#include "RCUtilsThread.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// LZ4 compatible block codec plus a framed container made of independently compressed blocks.
+//
+// Frame layout:
+//	FCompressedFrameHeader
+//	uint32 BlockSizes[NumBlocks]	Stored size of each block; top bit set when the block is stored raw
+//	Block payloads, back to back
+// Every block but the last decompresses to exactly BlockSize bytes, so block i always lands at
+// i * BlockSize in the output and blocks can be decoded in any order on any thread.
+namespace RCUtils
+{
+	enum class ECompressionLevel : uint8
+	{
+		// Single probe hash table, skips ahead faster on incompressible data
+		Fast,
+
+		// Hash chains with lazy matching; much slower to compress, same decompression speed
+		High,
+	};
+
+	struct FCompressedFrameHeader
+	{
+		enum
+		{
+			ExpectedMagic = 0x5A4C4352,	// 'RCLZ'
+			RawBlockFlag = 0x80000000,
+		};
+
+		uint32 Magic;
+		uint32 BlockSize;
+		uint64 ContentSize;
+		uint64 ContentHash;		// Hash64 of the uncompressed content
+		uint32 NumBlocks;
+		uint32 Flags;
+	};
+
+	namespace Internal
+	{
+		enum
+		{
+			LZMinMatch = 4,
+			LZLastLiterals = 5,
+			LZMatchFindLimit = 12,
+			LZMaxOffset = 65535,
+			LZFastHashLog = 12,
+			LZHighHashLog = 15,
+			LZHighMaxAttempts = 256,
+		};
+
+		inline uint32 LZHash(uint32 Sequence, uint32 HashLog)
+		{
+			return (Sequence * 2654435761u) >> (32 - HashLog);
+		}
+
+		inline uint32 LZCountMatch(const uint8* Ip, const uint8* Match, const uint8* Limit)
+		{
+			const uint8* Start = Ip;
+			while (Ip + 8 <= Limit)
+			{
+				uint64 Diff = ReadU64(Ip) ^ ReadU64(Match);
+				if (Diff)
+				{
+#if defined(_MSC_VER)
+					unsigned long Bit;
+					_BitScanForward64(&Bit, Diff);
+					return (uint32)(Ip - Start) + (uint32)(Bit >> 3);
+#else
+					return (uint32)(Ip - Start) + (uint32)(__builtin_ctzll(Diff) >> 3);
+#endif
+				}
+				Ip += 8;
+				Match += 8;
+			}
+
+			while (Ip < Limit && *Ip == *Match)
+			{
+				++Ip;
+				++Match;
+			}
+			return (uint32)(Ip - Start);
+		}
+
+		inline uint8* LZWriteLength(uint8* Op, uint32 Length)
+		{
+			while (Length >= 255)
+			{
+				*Op++ = 255;
+				Length -= 255;
+			}
+			*Op++ = (uint8)Length;
+			return Op;
+		}
+
+		inline uint8* LZWriteSequence(uint8* Op, const uint8* Anchor, uint32 NumLiterals, uint32 Offset, uint32 MatchLength)
+		{
+			uint8* Token = Op++;
+			uint32 MatchCode = MatchLength - LZMinMatch;
+			*Token = (uint8)((Min<uint32>(NumLiterals, 15) << 4) | Min<uint32>(MatchCode, 15));
+			if (NumLiterals >= 15)
+			{
+				Op = LZWriteLength(Op, NumLiterals - 15);
+			}
+			memcpy(Op, Anchor, NumLiterals);
+			Op += NumLiterals;
+			*Op++ = (uint8)(Offset & 0xff);
+			*Op++ = (uint8)(Offset >> 8);
+			if (MatchCode >= 15)
+			{
+				Op = LZWriteLength(Op, MatchCode - 15);
+			}
+			return Op;
+		}
+
+		inline uint8* LZWriteLastLiterals(uint8* Op, const uint8* Anchor, uint32 NumLiterals)
+		{
+			*Op++ = (uint8)(Min<uint32>(NumLiterals, 15) << 4);
+			if (NumLiterals >= 15)
+			{
+				Op = LZWriteLength(Op, NumLiterals - 15);
+			}
+			if (NumLiterals > 0)
+			{
+				memcpy(Op, Anchor, NumLiterals);
+			}
+			return Op + NumLiterals;
+		}
+
+		inline int32 LZCompressFast(const uint8* Src, int32 SrcSize, uint8* Dst)
+		{
+			const uint8* Ip = Src;
+			const uint8* Anchor = Src;
+			const uint8* End = Src + SrcSize;
+			uint8* Op = Dst;
+
+			if (SrcSize >= LZMatchFindLimit + 1)
+			{
+				const uint8* MatchFindLimit = End - LZMatchFindLimit;
+				const uint8* MatchLimit = End - LZLastLiterals;
+				uint32 HashTable[1 << LZFastHashLog] = {};
+
+				HashTable[LZHash(ReadU32(Ip), LZFastHashLog)] = 0;
+				++Ip;
+				for (;;)
+				{
+					// Look for a match, stepping further apart the longer nothing is found
+					const uint8* Match = nullptr;
+					uint32 SearchCount = 1 << 6;
+					for (;;)
+					{
+						uint32 Step = SearchCount++ >> 6;
+						uint32 Hash = LZHash(ReadU32(Ip), LZFastHashLog);
+						Match = Src + HashTable[Hash];
+						HashTable[Hash] = (uint32)(Ip - Src);
+						if (Ip - Match <= LZMaxOffset && Match < Ip && ReadU32(Match) == ReadU32(Ip))
+						{
+							break;
+						}
+
+						Ip += Step;
+						if (Ip > MatchFindLimit)
+						{
+							return (int32)(LZWriteLastLiterals(Op, Anchor, (uint32)(End - Anchor)) - Dst);
+						}
+					}
+
+					// Extend backwards into the pending literals
+					while (Ip > Anchor && Match > Src && Ip[-1] == Match[-1])
+					{
+						--Ip;
+						--Match;
+					}
+
+					uint32 MatchLength = LZMinMatch + LZCountMatch(Ip + LZMinMatch, Match + LZMinMatch, MatchLimit);
+					Op = LZWriteSequence(Op, Anchor, (uint32)(Ip - Anchor), (uint32)(Ip - Match), MatchLength);
+					Ip += MatchLength;
+					Anchor = Ip;
+					if (Ip > MatchFindLimit)
+					{
+						break;
+					}
+
+					HashTable[LZHash(ReadU32(Ip - 2), LZFastHashLog)] = (uint32)(Ip - 2 - Src);
+				}
+			}
+
+			return (int32)(LZWriteLastLiterals(Op, Anchor, (uint32)(End - Anchor)) - Dst);
+		}
+
+		struct FLZHighState
+		{
+			FLZHighState(const uint8* InSrc)
+				: Src(InSrc)
+				, HashTable(1 << LZHighHashLog, -1)
+				, ChainTable(1 << 16, 0)
+			{
+			}
+
+			void InsertUpTo(const uint8* Ip)
+			{
+				int32 Target = (int32)(Ip - Src);
+				for (; NextToUpdate < Target; ++NextToUpdate)
+				{
+					uint32 Hash = LZHash(ReadU32(Src + NextToUpdate), LZHighHashLog);
+					int32 Previous = HashTable[Hash];
+					// A zero delta ends the chain; anything further back than the window is useless anyway
+					int32 Delta = (Previous < 0 || NextToUpdate - Previous > LZMaxOffset) ? 0 : NextToUpdate - Previous;
+					ChainTable[NextToUpdate & 0xffff] = (uint16)Delta;
+					HashTable[Hash] = NextToUpdate;
+				}
+			}
+
+			uint32 FindBestMatch(const uint8* Ip, const uint8* MatchLimit, const uint8*& OutMatch)
+			{
+				InsertUpTo(Ip);
+				uint32 BestLength = 0;
+				int32 Pos = (int32)(Ip - Src);
+				int32 Candidate = HashTable[LZHash(ReadU32(Ip), LZHighHashLog)];
+				for (uint32 Attempt = 0; Attempt < LZHighMaxAttempts && Candidate >= 0 && Candidate < Pos && Pos - Candidate <= LZMaxOffset; ++Attempt)
+				{
+					const uint8* Match = Src + Candidate;
+					if (Match[BestLength] == Ip[BestLength] && ReadU32(Match) == ReadU32(Ip))
+					{
+						uint32 Length = LZMinMatch + LZCountMatch(Ip + LZMinMatch, Match + LZMinMatch, MatchLimit);
+						if (Length > BestLength)
+						{
+							BestLength = Length;
+							OutMatch = Match;
+						}
+					}
+
+					uint16 Delta = ChainTable[Candidate & 0xffff];
+					if (Delta == 0)
+					{
+						break;
+					}
+					Candidate -= Delta;
+				}
+				return BestLength;
+			}
+
+			const uint8* Src;
+			int32 NextToUpdate = 0;
+			std::vector<int32> HashTable;
+			std::vector<uint16> ChainTable;
+		};
+
+		inline int32 LZCompressHigh(const uint8* Src, int32 SrcSize, uint8* Dst)
+		{
+			const uint8* Ip = Src;
+			const uint8* Anchor = Src;
+			const uint8* End = Src + SrcSize;
+			uint8* Op = Dst;
+
+			if (SrcSize >= LZMatchFindLimit + 1)
+			{
+				const uint8* MatchFindLimit = End - LZMatchFindLimit;
+				const uint8* MatchLimit = End - LZLastLiterals;
+				FLZHighState State(Src);
+				while (Ip <= MatchFindLimit)
+				{
+					const uint8* Match = nullptr;
+					uint32 Length = State.FindBestMatch(Ip, MatchLimit, Match);
+					if (Length < LZMinMatch)
+					{
+						++Ip;
+						continue;
+					}
+
+					// Lazy matching: prefer a strictly longer match starting one byte later
+					while (Ip + 1 <= MatchFindLimit)
+					{
+						const uint8* NextMatch = nullptr;
+						uint32 NextLength = State.FindBestMatch(Ip + 1, MatchLimit, NextMatch);
+						if (NextLength <= Length)
+						{
+							break;
+						}
+						++Ip;
+						Match = NextMatch;
+						Length = NextLength;
+					}
+
+					Op = LZWriteSequence(Op, Anchor, (uint32)(Ip - Anchor), (uint32)(Ip - Match), Length);
+					Ip += Length;
+					Anchor = Ip;
+				}
+			}
+
+			return (int32)(LZWriteLastLiterals(Op, Anchor, (uint32)(End - Anchor)) - Dst);
+		}
+	}
+
+	// Worst case compressed size for SrcSize input bytes
+	inline int32 LZCompressBound(int32 SrcSize)
+	{
+		return SrcSize + SrcSize / 255 + 16;
+	}
+
+	// Returns the compressed size, or 0 if DstCapacity is smaller than LZCompressBound(SrcSize)
+	inline int32 LZCompressBlock(const void* Src, int32 SrcSize, void* Dst, int32 DstCapacity, ECompressionLevel Level = ECompressionLevel::Fast)
+	{
+		if (SrcSize < 0 || DstCapacity < LZCompressBound(SrcSize))
+		{
+			return 0;
+		}
+
+		return Level == ECompressionLevel::High
+			? Internal::LZCompressHigh((const uint8*)Src, SrcSize, (uint8*)Dst)
+			: Internal::LZCompressFast((const uint8*)Src, SrcSize, (uint8*)Dst);
+	}
+
+	// Bounds checked on both input and output, so corrupt data fails instead of overrunning.
+	// Returns the decompressed size or -1.
+	inline int32 LZDecompressBlock(const void* Src, int32 SrcSize, void* Dst, int32 DstCapacity)
+	{
+		const uint8* Ip = (const uint8*)Src;
+		const uint8* InEnd = Ip + SrcSize;
+		uint8* Op = (uint8*)Dst;
+		uint8* OutEnd = Op + DstCapacity;
+
+		for (;;)
+		{
+			if (Ip >= InEnd)
+			{
+				return -1;
+			}
+
+			uint32 Token = *Ip++;
+			size_t NumLiterals = Token >> 4;
+			if (NumLiterals == 15)
+			{
+				uint8 Byte;
+				do
+				{
+					if (Ip >= InEnd)
+					{
+						return -1;
+					}
+					Byte = *Ip++;
+					NumLiterals += Byte;
+				}
+				while (Byte == 255);
+			}
+
+			if (NumLiterals > (size_t)(InEnd - Ip) || NumLiterals > (size_t)(OutEnd - Op))
+			{
+				return -1;
+			}
+
+			// Short literal runs (the common case) are copied with one fixed size move when there is slack
+			if (NumLiterals <= 16 && InEnd - Ip >= 16 && OutEnd - Op >= 16)
+			{
+				memcpy(Op, Ip, 16);
+			}
+			else
+			{
+				memcpy(Op, Ip, NumLiterals);
+			}
+			Op += NumLiterals;
+			Ip += NumLiterals;
+
+			if (Ip == InEnd)
+			{
+				// Last sequence has no match
+				break;
+			}
+
+			if (InEnd - Ip < 2)
+			{
+				return -1;
+			}
+
+			size_t Offset = (size_t)Ip[0] | ((size_t)Ip[1] << 8);
+			Ip += 2;
+			if (Offset == 0 || Offset > (size_t)(Op - (uint8*)Dst))
+			{
+				return -1;
+			}
+
+			size_t MatchLength = Token & 15;
+			if (MatchLength == 15)
+			{
+				uint8 Byte;
+				do
+				{
+					if (Ip >= InEnd)
+					{
+						return -1;
+					}
+					Byte = *Ip++;
+					MatchLength += Byte;
+				}
+				while (Byte == 255);
+			}
+			MatchLength += Internal::LZMinMatch;
+
+			if (MatchLength > (size_t)(OutEnd - Op))
+			{
+				return -1;
+			}
+
+			const uint8* Match = Op - Offset;
+			uint8* MatchEnd = Op + MatchLength;
+			if (Offset >= 8 && OutEnd - MatchEnd >= 8)
+			{
+				// Chunks never overlap their own source when Offset >= 8, so 8 byte moves may overshoot safely
+				do
+				{
+					memcpy(Op, Match, 8);
+					Op += 8;
+					Match += 8;
+				}
+				while (Op < MatchEnd);
+			}
+			else
+			{
+				while (Op < MatchEnd)
+				{
+					*Op++ = *Match++;
+				}
+			}
+			Op = MatchEnd;
+		}
+
+		return (int32)(Op - (uint8*)Dst);
+	}
+
+	inline bool IsCompressedFrame(const void* Data, size_t Size)
+	{
+		return Size >= sizeof(FCompressedFrameHeader) && ((const FCompressedFrameHeader*)Data)->Magic == FCompressedFrameHeader::ExpectedMagic;
+	}
+
+	// Returns the size the frame decompresses to, or false if the header is malformed
+	inline bool GetCompressedFrameContentSize(const void* Data, size_t Size, uint64& OutContentSize)
+	{
+		if (!IsCompressedFrame(Data, Size))
+		{
+			return false;
+		}
+
+		const FCompressedFrameHeader* Header = (const FCompressedFrameHeader*)Data;
+		if (Header->BlockSize == 0 || Header->NumBlocks != (Header->ContentSize + Header->BlockSize - 1) / Header->BlockSize
+			|| sizeof(FCompressedFrameHeader) + (uint64)Header->NumBlocks * sizeof(uint32) > Size)
+		{
+			return false;
+		}
+
+		OutContentSize = Header->ContentSize;
+		return true;
+	}
+
+	// Blocks are compressed on up to NumThreads threads (0 = all hardware threads)
+	inline std::vector<uint8> CompressFrame(const void* Data, size_t Size, ECompressionLevel Level = ECompressionLevel::Fast, uint32 BlockSize = 256 * 1024, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		checkAlways(BlockSize > 0 && BlockSize < FCompressedFrameHeader::RawBlockFlag && (uint64)BlockSize <= 0x7fffffff);
+		const uint8* Src = (const uint8*)Data;
+		uint32 NumBlocks = (uint32)((Size + BlockSize - 1) / BlockSize);
+
+		std::vector<std::vector<uint8>> Blocks(NumBlocks);
+		std::vector<uint32> BlockSizes(NumBlocks);
+		ParallelFor(NumBlocks, [&](uint32 BlockIndex)
+		{
+			const uint8* BlockSrc = Src + (size_t)BlockIndex * BlockSize;
+			int32 BlockSrcSize = (int32)Min<size_t>(BlockSize, Size - (size_t)BlockIndex * BlockSize);
+			std::vector<uint8>& Block = Blocks[BlockIndex];
+			Block.resize(LZCompressBound(BlockSrcSize));
+			int32 CompressedSize = LZCompressBlock(BlockSrc, BlockSrcSize, Block.data(), (int32)Block.size(), Level);
+			if (CompressedSize <= 0 || CompressedSize >= BlockSrcSize)
+			{
+				// Incompressible, keep it raw
+				Block.assign(BlockSrc, BlockSrc + BlockSrcSize);
+				BlockSizes[BlockIndex] = (uint32)BlockSrcSize | FCompressedFrameHeader::RawBlockFlag;
+			}
+			else
+			{
+				Block.resize(CompressedSize);
+				BlockSizes[BlockIndex] = (uint32)CompressedSize;
+			}
+		}, NumThreads);
+
+		FCompressedFrameHeader Header;
+		MemZero(Header);
+		Header.Magic = FCompressedFrameHeader::ExpectedMagic;
+		Header.BlockSize = BlockSize;
+		Header.ContentSize = Size;
+		Header.ContentHash = Hash64(Data, Size);
+		Header.NumBlocks = NumBlocks;
+
+		size_t TotalSize = sizeof(Header) + NumBlocks * sizeof(uint32);
+		for (const auto& Block : Blocks)
+		{
+			TotalSize += Block.size();
+		}
+
+		std::vector<uint8> Out(TotalSize);
+		uint8* Op = Out.data();
+		memcpy(Op, &Header, sizeof(Header));
+		Op += sizeof(Header);
+		if (NumBlocks > 0)
+		{
+			memcpy(Op, BlockSizes.data(), NumBlocks * sizeof(uint32));
+			Op += NumBlocks * sizeof(uint32);
+		}
+		for (const auto& Block : Blocks)
+		{
+			if (!Block.empty())
+			{
+				memcpy(Op, Block.data(), Block.size());
+				Op += Block.size();
+			}
+		}
+		return Out;
+	}
+
+	// Decompresses straight into Dst, which needs at least the frame's content size. Blocks are decoded
+	// on up to NumThreads threads (0 = all hardware threads).
+	inline bool DecompressFrame(const void* Src, size_t SrcSize, void* Dst, size_t DstCapacity, bool bVerifyHash = false, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		uint64 ContentSize = 0;
+		if (!GetCompressedFrameContentSize(Src, SrcSize, ContentSize) || ContentSize > DstCapacity)
+		{
+			return false;
+		}
+
+		const FCompressedFrameHeader* Header = (const FCompressedFrameHeader*)Src;
+		const uint32* BlockSizes = (const uint32*)((const uint8*)Src + sizeof(FCompressedFrameHeader));
+		uint32 NumBlocks = Header->NumBlocks;
+
+		std::vector<uint64> BlockOffsets(NumBlocks);
+		uint64 Offset = sizeof(FCompressedFrameHeader) + (uint64)NumBlocks * sizeof(uint32);
+		for (uint32 BlockIndex = 0; BlockIndex < NumBlocks; ++BlockIndex)
+		{
+			BlockOffsets[BlockIndex] = Offset;
+			Offset += BlockSizes[BlockIndex] & ~(uint32)FCompressedFrameHeader::RawBlockFlag;
+		}
+		if (Offset > SrcSize)
+		{
+			return false;
+		}
+
+		std::atomic<bool> bFailed{false};
+		ParallelFor(NumBlocks, [&](uint32 BlockIndex)
+		{
+			uint64 DstOffset = (uint64)BlockIndex * Header->BlockSize;
+			uint32 ExpectedSize = (uint32)Min<uint64>(Header->BlockSize, ContentSize - DstOffset);
+			uint32 StoredSize = BlockSizes[BlockIndex] & ~(uint32)FCompressedFrameHeader::RawBlockFlag;
+			const uint8* BlockSrc = (const uint8*)Src + BlockOffsets[BlockIndex];
+			uint8* BlockDst = (uint8*)Dst + DstOffset;
+			if (BlockSizes[BlockIndex] & FCompressedFrameHeader::RawBlockFlag)
+			{
+				if (StoredSize != ExpectedSize)
+				{
+					bFailed = true;
+					return;
+				}
+				memcpy(BlockDst, BlockSrc, StoredSize);
+			}
+			else if (LZDecompressBlock(BlockSrc, (int32)StoredSize, BlockDst, (int32)ExpectedSize) != (int32)ExpectedSize)
+			{
+				bFailed = true;
+			}
+		}, NumThreads);
+
+		if (bFailed)
+		{
+			return false;
+		}
+
+		return !bVerifyHash || Hash64(Dst, (size_t)ContentSize) == Header->ContentHash;
+	}
+}
@@ -0,0 +1,550 @@
+#pragma once
+
+#include "RCUtilsBit.h"
+#include "RCUtilsMemory.h"
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace RCUtils
+{
+	// Specialize for types that can be moved to a new address with a plain memcpy (eg types holding
+	// pointers only to heap memory). Trivially copyable types are always relocatable.
+	template <typename T>
+	struct TIsTriviallyRelocatable
+	{
+		static const bool Value = std::is_trivially_copyable<T>::value;
+	};
+
+	namespace Internal
+	{
+		template <typename T>
+		inline void DestructElements(T* Elements, uint32 Num)
+		{
+			if (!std::is_trivially_destructible<T>::value)
+			{
+				for (uint32 Index = 0; Index < Num; ++Index)
+				{
+					Elements[Index].~T();
+				}
+			}
+		}
+
+		// Moves Num elements into uninitialized Dst memory; Src is left destroyed
+		template <typename T>
+		inline void RelocateElements(T* Dst, T* Src, uint32 Num)
+		{
+			if (TIsTriviallyRelocatable<T>::Value)
+			{
+				if (Num > 0)
+				{
+					memcpy((void*)Dst, (const void*)Src, sizeof(T) * Num);
+				}
+			}
+			else
+			{
+				for (uint32 Index = 0; Index < Num; ++Index)
+				{
+					new (Dst + Index) T(std::move(Src[Index]));
+					Src[Index].~T();
+				}
+			}
+		}
+
+		template <typename T>
+		inline void CopyConstructElements(T* Dst, const T* Src, uint32 Num)
+		{
+			if (std::is_trivially_copyable<T>::value)
+			{
+				if (Num > 0)
+				{
+					memcpy((void*)Dst, (const void*)Src, sizeof(T) * Num);
+				}
+			}
+			else
+			{
+				for (uint32 Index = 0; Index < Num; ++Index)
+				{
+					new (Dst + Index) T(Src[Index]);
+				}
+			}
+		}
+	}
+
+	// Vector with storage for N elements inside the object; never touches the heap
+	template <typename T, uint32 N>
+	class TFixedVector
+	{
+	public:
+		TFixedVector() = default;
+
+		TFixedVector(const TFixedVector& Other)
+		{
+			Internal::CopyConstructElements(data(), Other.data(), Other.Num);
+			Num = Other.Num;
+		}
+
+		TFixedVector(TFixedVector&& Other) noexcept
+		{
+			Internal::RelocateElements(data(), Other.data(), Other.Num);
+			Num = Other.Num;
+			Other.Num = 0;
+		}
+
+		~TFixedVector()
+		{
+			clear();
+		}
+
+		TFixedVector& operator = (const TFixedVector& Other)
+		{
+			if (this != &Other)
+			{
+				clear();
+				Internal::CopyConstructElements(data(), Other.data(), Other.Num);
+				Num = Other.Num;
+			}
+			return *this;
+		}
+
+		TFixedVector& operator = (TFixedVector&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				clear();
+				Internal::RelocateElements(data(), Other.data(), Other.Num);
+				Num = Other.Num;
+				Other.Num = 0;
+			}
+			return *this;
+		}
+
+		template <typename... TArgs>
+		T& emplace_back(TArgs&&... Args)
+		{
+			check(Num < N);
+			T* Element = new (data() + Num) T(std::forward<TArgs>(Args)...);
+			++Num;
+			return *Element;
+		}
+
+		void push_back(const T& Value)
+		{
+			emplace_back(Value);
+		}
+
+		void push_back(T&& Value)
+		{
+			emplace_back(std::move(Value));
+		}
+
+		void pop_back()
+		{
+			check(Num > 0);
+			--Num;
+			data()[Num].~T();
+		}
+
+		void resize(uint32 NewNum)
+		{
+			check(NewNum <= N);
+			while (Num > NewNum)
+			{
+				pop_back();
+			}
+			while (Num < NewNum)
+			{
+				emplace_back();
+			}
+		}
+
+		void clear()
+		{
+			Internal::DestructElements(data(), Num);
+			Num = 0;
+		}
+
+		T& operator[](uint32 Index)
+		{
+			check(Index < Num);
+			return data()[Index];
+		}
+
+		const T& operator[](uint32 Index) const
+		{
+			check(Index < Num);
+			return data()[Index];
+		}
+
+		T* data() { return (T*)Storage; }
+		const T* data() const { return (const T*)Storage; }
+		T* begin() { return data(); }
+		T* end() { return data() + Num; }
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + Num; }
+		T& front() { return (*this)[0]; }
+		T& back() { return (*this)[Num - 1]; }
+		const T& front() const { return (*this)[0]; }
+		const T& back() const { return (*this)[Num - 1]; }
+		uint32 size() const { return Num; }
+		uint32 capacity() const { return N; }
+		bool empty() const { return Num == 0; }
+		bool full() const { return Num == N; }
+
+	protected:
+		alignas(T) uint8 Storage[sizeof(T) * N];
+		uint32 Num = 0;
+	};
+
+	// Vector that keeps up to N elements inside the object and spills to the heap past that
+	template <typename T, uint32 N>
+	class TInlineVector
+	{
+	public:
+		TInlineVector() = default;
+
+		TInlineVector(const TInlineVector& Other)
+		{
+			reserve(Other.Num);
+			Internal::CopyConstructElements(Data, Other.Data, Other.Num);
+			Num = Other.Num;
+		}
+
+		TInlineVector(TInlineVector&& Other) noexcept
+		{
+			MoveFrom(Other);
+		}
+
+		~TInlineVector()
+		{
+			clear();
+			FreeHeap();
+		}
+
+		TInlineVector& operator = (const TInlineVector& Other)
+		{
+			if (this != &Other)
+			{
+				clear();
+				reserve(Other.Num);
+				Internal::CopyConstructElements(Data, Other.Data, Other.Num);
+				Num = Other.Num;
+			}
+			return *this;
+		}
+
+		TInlineVector& operator = (TInlineVector&& Other) noexcept
+		{
+			if (this != &Other)
+			{
+				clear();
+				FreeHeap();
+				MoveFrom(Other);
+			}
+			return *this;
+		}
+
+		template <typename... TArgs>
+		T& emplace_back(TArgs&&... Args)
+		{
+			if (Num == Capacity)
+			{
+				// Args may refer to an element (push_back(V[0])), so build the value before Grow frees it
+				T Value(std::forward<TArgs>(Args)...);
+				Grow(Capacity * 2);
+				return *new (Data + Num++) T(std::move(Value));
+			}
+			T* Element = new (Data + Num) T(std::forward<TArgs>(Args)...);
+			++Num;
+			return *Element;
+		}
+
+		void push_back(const T& Value)
+		{
+			emplace_back(Value);
+		}
+
+		void push_back(T&& Value)
+		{
+			emplace_back(std::move(Value));
+		}
+
+		void pop_back()
+		{
+			check(Num > 0);
+			--Num;
+			Data[Num].~T();
+		}
+
+		void reserve(uint32 NewCapacity)
+		{
+			if (NewCapacity > Capacity)
+			{
+				Grow(NewCapacity);
+			}
+		}
+
+		void resize(uint32 NewNum)
+		{
+			reserve(NewNum);
+			while (Num > NewNum)
+			{
+				pop_back();
+			}
+			while (Num < NewNum)
+			{
+				emplace_back();
+			}
+		}
+
+		void clear()
+		{
+			Internal::DestructElements(Data, Num);
+			Num = 0;
+		}
+
+		T& operator[](uint32 Index)
+		{
+			check(Index < Num);
+			return Data[Index];
+		}
+
+		const T& operator[](uint32 Index) const
+		{
+			check(Index < Num);
+			return Data[Index];
+		}
+
+		T* data() { return Data; }
+		const T* data() const { return Data; }
+		T* begin() { return Data; }
+		T* end() { return Data + Num; }
+		const T* begin() const { return Data; }
+		const T* end() const { return Data + Num; }
+		T& front() { return (*this)[0]; }
+		T& back() { return (*this)[Num - 1]; }
+		const T& front() const { return (*this)[0]; }
+		const T& back() const { return (*this)[Num - 1]; }
+		uint32 size() const { return Num; }
+		uint32 capacity() const { return Capacity; }
+		bool empty() const { return Num == 0; }
+		bool IsInline() const { return Data == GetInlineData(); }
+
+	protected:
+		T* GetInlineData() { return (T*)InlineStorage; }
+		const T* GetInlineData() const { return (const T*)InlineStorage; }
+
+		void Grow(uint32 NewCapacity)
+		{
+			NewCapacity = Max<uint32>(NewCapacity, 1);
+			T* NewData = (T*)TaggedAlloc(EMemoryTag::Containers, sizeof(T) * NewCapacity, alignof(T));
+			Internal::RelocateElements(NewData, Data, Num);
+			FreeHeap();
+			Data = NewData;
+			Capacity = NewCapacity;
+		}
+
+		void FreeHeap()
+		{
+			if (!IsInline())
+			{
+				TaggedFree(EMemoryTag::Containers, Data, sizeof(T) * Capacity, alignof(T));
+				Data = GetInlineData();
+				Capacity = N;
+			}
+		}
+
+		// Expects this to be empty and inline
+		void MoveFrom(TInlineVector& Other)
+		{
+			if (Other.IsInline())
+			{
+				Internal::RelocateElements(Data, Other.Data, Other.Num);
+			}
+			else
+			{
+				Data = Other.Data;
+				Capacity = Other.Capacity;
+				Other.Data = Other.GetInlineData();
+				Other.Capacity = N;
+			}
+			Num = Other.Num;
+			Other.Num = 0;
+		}
+
+		T* Data = GetInlineData();
+		uint32 Num = 0;
+		uint32 Capacity = N;
+		alignas(T) uint8 InlineStorage[sizeof(T) * N];
+	};
+
+	// FIFO over a power-of-two sized array; indices wrap with a mask instead of a modulo
+	template <typename T>
+	class TRingBuffer
+	{
+	public:
+		TRingBuffer() = default;
+
+		explicit TRingBuffer(uint32 InCapacity)
+		{
+			reserve(InCapacity);
+		}
+
+		TRingBuffer(const TRingBuffer& Other)
+		{
+			reserve(Other.Capacity);
+			for (uint32 Index = 0; Index < Other.size(); ++Index)
+			{
+				push_back(Other[Index]);
+			}
+		}
+
+		TRingBuffer(TRingBuffer&& Other) noexcept
+		{
+			Swap(Other);
+		}
+
+		~TRingBuffer()
+		{
+			clear();
+			TaggedFree(EMemoryTag::Containers, Data, sizeof(T) * Capacity, alignof(T));
+		}
+
+		// Copies are made when the argument is built, so the assignment itself can't throw
+		TRingBuffer& operator = (TRingBuffer Other) noexcept
+		{
+			Swap(Other);
+			return *this;
+		}
+
+		void Swap(TRingBuffer& Other) noexcept
+		{
+			std::swap(Data, Other.Data);
+			std::swap(Capacity, Other.Capacity);
+			std::swap(Head, Other.Head);
+			std::swap(Tail, Other.Tail);
+		}
+
+		// Capacity is rounded up to the next power of two
+		void reserve(uint32 NewCapacity)
+		{
+			if (NewCapacity <= Capacity)
+			{
+				return;
+			}
+
+			NewCapacity = (uint32)RoundUpToPowerOfTwo(NewCapacity);
+			check(IsPowerOfTwo(NewCapacity));
+			T* NewData = (T*)TaggedAlloc(EMemoryTag::Containers, sizeof(T) * NewCapacity, alignof(T));
+			uint32 Num = size();
+			if (Num > 0)
+			{
+				// Relocate the (up to) two contiguous runs so the new buffer starts at index 0
+				uint32 First = Head & (Capacity - 1);
+				uint32 FirstRun = Min(Num, Capacity - First);
+				Internal::RelocateElements(NewData, Data + First, FirstRun);
+				Internal::RelocateElements(NewData + FirstRun, Data, Num - FirstRun);
+			}
+			TaggedFree(EMemoryTag::Containers, Data, sizeof(T) * Capacity, alignof(T));
+			Data = NewData;
+			Capacity = NewCapacity;
+			Head = 0;
+			Tail = Num;
+		}
+
+		template <typename... TArgs>
+		T& emplace_back(TArgs&&... Args)
+		{
+			if (size() == Capacity)
+			{
+				// Same as TInlineVector: Args may live in the buffer that reserve frees
+				T Value(std::forward<TArgs>(Args)...);
+				reserve(Max<uint32>(Capacity * 2, 16));
+				return *new (Data + (Tail++ & (Capacity - 1))) T(std::move(Value));
+			}
+			T* Element = new (Data + (Tail & (Capacity - 1))) T(std::forward<TArgs>(Args)...);
+			++Tail;
+			return *Element;
+		}
+
+		void push_back(const T& Value)
+		{
+			emplace_back(Value);
+		}
+
+		void push_back(T&& Value)
+		{
+			emplace_back(std::move(Value));
+		}
+
+		// Returns false instead of growing when full
+		bool TryPush(T&& Value)
+		{
+			if (size() == Capacity)
+			{
+				return false;
+			}
+			emplace_back(std::move(Value));
+			return true;
+		}
+
+		bool TryPop(T& OutValue)
+		{
+			if (empty())
+			{
+				return false;
+			}
+			T& Element = front();
+			OutValue = std::move(Element);
+			Element.~T();
+			++Head;
+			return true;
+		}
+
+		void pop_front()
+		{
+			check(!empty());
+			front().~T();
+			++Head;
+		}
+
+		void clear()
+		{
+			while (!empty())
+			{
+				pop_front();
+			}
+			Head = 0;
+			Tail = 0;
+		}
+
+		// Index 0 is the oldest element
+		T& operator[](uint32 Index)
+		{
+			check(Index < size());
+			return Data[(Head + Index) & (Capacity - 1)];
+		}
+
+		const T& operator[](uint32 Index) const
+		{
+			check(Index < size());
+			return Data[(Head + Index) & (Capacity - 1)];
+		}
+
+		T& front() { return (*this)[0]; }
+		T& back() { return (*this)[size() - 1]; }
+		const T& front() const { return (*this)[0]; }
+		const T& back() const { return (*this)[size() - 1]; }
+		uint32 size() const { return Tail - Head; }
+		uint32 capacity() const { return Capacity; }
+		bool empty() const { return Head == Tail; }
+
+	protected:
+		T* Data = nullptr;
+		uint32 Capacity = 0;
+
+		// Free-running counters; only masked on access so wrap-around at 2^32 is harmless
+		uint32 Head = 0;
+		uint32 Tail = 0;
+	};
+}
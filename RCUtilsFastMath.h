@@ -0,0 +1,387 @@
+#pragma once
+
+#include "RCUtilsBase.h"
+#include <float.h>
+#include <limits>
+#include <math.h>
+#include <string.h>
+
+#if !defined(RCUTILS_FAST_MATH_SSE)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RCUTILS_FAST_MATH_SSE 1
+#else
+#define RCUTILS_FAST_MATH_SSE 0
+#endif
+#endif
+
+#if RCUTILS_FAST_MATH_SSE
+#include <emmintrin.h>
+#endif
+
+// Float approximations of the libm functions, as scalar calls and as SSE2 batches over arrays. Both use the
+// same polynomials, so results match up to rounding of the range reduction. Errors are the maximum observed
+// against double precision over the documented domain and are absolute unless noted; NaN inputs are not
+// handled.
+
+namespace FastMathInternal
+{
+	const float TwoOverPi = 0.636619772367581343f;
+
+	// pi/2 split in three so multiples of it subtract exactly (Cody-Waite)
+	const float PiOverTwo1 = 1.5703125f;
+	const float PiOverTwo2 = 4.837512969970703125e-4f;
+	const float PiOverTwo3 = 7.54978995489188216e-8f;
+
+	inline uint32 FloatToBits(float Value)
+	{
+		uint32 Bits;
+		memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits;
+	}
+
+	inline float BitsToFloat(uint32 Bits)
+	{
+		float Value;
+		memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	// 2^N for N in [-126, 127]
+	inline float Pow2i(int32 N)
+	{
+		return BitsToFloat((uint32)(N + 127) << 23);
+	}
+}
+
+// Max error 1e-7 for |X| <= 8192; accuracy degrades linearly beyond that as the range reduction loses bits
+inline void FastSinCos(float X, float& OutSin, float& OutCos)
+{
+	using namespace FastMathInternal;
+
+	// Reduce to [-pi/4, pi/4] and remember the quadrant
+	float Quadrant = floorf(X * TwoOverPi + 0.5f);
+	float Y = ((X - Quadrant * PiOverTwo1) - Quadrant * PiOverTwo2) - Quadrant * PiOverTwo3;
+	int32 Q = (int32)Quadrant;
+
+	float Y2 = Y * Y;
+	float Sin = Y + Y * Y2 * (-1.6666654611e-1f + Y2 * (8.3321608736e-3f + Y2 * -1.9515295891e-4f));
+	float Cos = 1.0f - 0.5f * Y2 + Y2 * Y2 * (4.166664568298827e-2f + Y2 * (-1.388731625493765e-3f + Y2 * 2.443315711809948e-5f));
+
+	// Odd quadrants swap sin and cos; the sign follows the quadrant
+	bool bSwap = (Q & 1) != 0;
+	float S = bSwap ? Cos : Sin;
+	float C = bSwap ? Sin : Cos;
+	OutSin = BitsToFloat(FloatToBits(S) ^ ((uint32)(Q & 2) << 30));
+	OutCos = BitsToFloat(FloatToBits(C) ^ ((uint32)((Q + 1) & 2) << 30));
+}
+
+inline float FastSin(float X)
+{
+	float Sin, Cos;
+	FastSinCos(X, Sin, Cos);
+	return Sin;
+}
+
+inline float FastCos(float X)
+{
+	float Sin, Cos;
+	FastSinCos(X, Sin, Cos);
+	return Cos;
+}
+
+// Relative error 3e-7 away from the poles
+inline float FastTan(float X)
+{
+	float Sin, Cos;
+	FastSinCos(X, Sin, Cos);
+	return Sin / Cos;
+}
+
+// Relative error 3e-7 (SSE estimate plus one Newton step) or 5e-6 (bit trick plus two Newton steps); X > 0
+inline float FastRsqrt(float X)
+{
+#if RCUTILS_FAST_MATH_SSE
+	float Y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(X)));
+	return Y * (1.5f - 0.5f * X * Y * Y);
+#else
+	float Y = FastMathInternal::BitsToFloat(0x5f375a86 - (FastMathInternal::FloatToBits(X) >> 1));
+	Y = Y * (1.5f - 0.5f * X * Y * Y);
+	return Y * (1.5f - 0.5f * X * Y * Y);
+#endif
+}
+
+// Relative error 1e-7; overflows to +inf above 88.72 and bottoms out at the smallest denormal below -103.9
+inline float FastExp(float X)
+{
+	using namespace FastMathInternal;
+	float Clamped = Min(Max(X, -103.9f), 88.72283f);
+
+	// e^X = 2^N * e^R with |R| <= ln(2) / 2
+	float N = floorf(Clamped * 1.44269504088896341f + 0.5f);
+	float R = (Clamped - N * 0.693359375f) + N * 2.12194440e-4f;
+	float P = ((((1.9875691500e-4f * R + 1.3981999507e-3f) * R + 8.3334519073e-3f) * R + 4.1665795894e-2f) * R + 1.6666665459e-1f) * R + 5.0000001201e-1f;
+	float Result = P * R * R + R + 1.0f;
+
+	// Scale in two halves so both stay normal at the ends of the range
+	int32 Exponent = (int32)N;
+	int32 Half = Exponent >> 1;
+	Result = Result * Pow2i(Half) * Pow2i(Exponent - Half);
+	return X > 88.72283f ? std::numeric_limits<float>::infinity() : Result;
+}
+
+// Absolute error 1e-7 for X in [0.5, 2], relative error 2e-7 elsewhere; X must be positive and normal
+inline float FastLog(float X)
+{
+	using namespace FastMathInternal;
+	uint32 Bits = FloatToBits(X);
+	int32 Exponent = (int32)(Bits >> 23) - 126;
+
+	// Mantissa in [sqrt(0.5), sqrt(2)) keeps the polynomial argument centered on zero
+	float M = BitsToFloat((Bits & 0x007fffff) | 0x3f000000);
+	bool bSmall = M < 0.707106781186547524f;
+	Exponent -= bSmall ? 1 : 0;
+	float F = (bSmall ? M + M : M) - 1.0f;
+
+	float Z = F * F;
+	float P = ((((((((7.0376836292e-2f * F - 1.1514610310e-1f) * F + 1.1676998740e-1f) * F - 1.2420140846e-1f) * F + 1.4249322787e-1f) * F - 1.6668057665e-1f) * F + 2.0000714765e-1f) * F - 2.4999993993e-1f) * F + 3.3333331174e-1f);
+	float E = (float)Exponent;
+	float Y = F * Z * P - 2.12194440e-4f * E - 0.5f * Z;
+	float Result = F + Y + 0.693359375f * E;
+	return X > 0.0f ? Result : (X == 0.0f ? -std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN());
+}
+
+// Max error 2e-6 radians; FastAtan2(0, 0) is 0
+inline float FastAtan2(float Y, float X)
+{
+	float AbsX = fabsf(X);
+	float AbsY = fabsf(Y);
+	float MaxAbs = Max(AbsX, AbsY);
+	float A = Min(AbsX, AbsY) / Max(MaxAbs, FLT_MIN);
+
+	// Minimax atan on [0, 1]
+	float S = A * A;
+	float R = A * (0.99997726f + S * (-0.33262347f + S * (0.19354346f + S * (-0.11643287f + S * (0.05265332f + S * -0.01172120f)))));
+
+	R = AbsY > AbsX ? 1.57079637f - R : R;
+	R = X < 0.0f ? 3.14159274f - R : R;
+	return Y < 0.0f ? -R : R;
+}
+
+#if RCUTILS_FAST_MATH_SSE
+namespace FastMathInternal
+{
+	inline __m128 Select(__m128 Mask, __m128 A, __m128 B)
+	{
+		return _mm_or_ps(_mm_and_ps(Mask, A), _mm_andnot_ps(Mask, B));
+	}
+
+	inline __m128 Pow2i(__m128i N)
+	{
+		return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(N, _mm_set1_epi32(127)), 23));
+	}
+
+	inline void SinCos4(__m128 X, __m128& OutSin, __m128& OutCos)
+	{
+		__m128i Q = _mm_cvtps_epi32(_mm_mul_ps(X, _mm_set1_ps(TwoOverPi)));
+		__m128 Quadrant = _mm_cvtepi32_ps(Q);
+		__m128 Y = _mm_sub_ps(X, _mm_mul_ps(Quadrant, _mm_set1_ps(PiOverTwo1)));
+		Y = _mm_sub_ps(Y, _mm_mul_ps(Quadrant, _mm_set1_ps(PiOverTwo2)));
+		Y = _mm_sub_ps(Y, _mm_mul_ps(Quadrant, _mm_set1_ps(PiOverTwo3)));
+
+		__m128 Y2 = _mm_mul_ps(Y, Y);
+		__m128 Sin = _mm_add_ps(_mm_mul_ps(Y2, _mm_set1_ps(-1.9515295891e-4f)), _mm_set1_ps(8.3321608736e-3f));
+		Sin = _mm_add_ps(_mm_mul_ps(Sin, Y2), _mm_set1_ps(-1.6666654611e-1f));
+		Sin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(Sin, Y2), Y), Y);
+		__m128 Cos = _mm_add_ps(_mm_mul_ps(Y2, _mm_set1_ps(2.443315711809948e-5f)), _mm_set1_ps(-1.388731625493765e-3f));
+		Cos = _mm_add_ps(_mm_mul_ps(Cos, Y2), _mm_set1_ps(4.166664568298827e-2f));
+		Cos = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(Cos, Y2), Y2), _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(Y2, _mm_set1_ps(0.5f))));
+
+		__m128i One = _mm_set1_epi32(1);
+		__m128i Two = _mm_set1_epi32(2);
+		__m128 Swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Q, One), One));
+		__m128 SinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(Q, Two), 30));
+		__m128 CosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(Q, One), Two), 30));
+		OutSin = _mm_xor_ps(Select(Swap, Cos, Sin), SinSign);
+		OutCos = _mm_xor_ps(Select(Swap, Sin, Cos), CosSign);
+	}
+
+	inline __m128 Tan4(__m128 X)
+	{
+		__m128 Sin, Cos;
+		SinCos4(X, Sin, Cos);
+		return _mm_div_ps(Sin, Cos);
+	}
+
+	inline __m128 Exp4(__m128 X)
+	{
+		__m128 Clamped = _mm_min_ps(_mm_max_ps(X, _mm_set1_ps(-103.9f)), _mm_set1_ps(88.72283f));
+		__m128i N = _mm_cvtps_epi32(_mm_mul_ps(Clamped, _mm_set1_ps(1.44269504088896341f)));
+		__m128 NF = _mm_cvtepi32_ps(N);
+		__m128 R = _mm_sub_ps(Clamped, _mm_mul_ps(NF, _mm_set1_ps(0.693359375f)));
+		R = _mm_add_ps(R, _mm_mul_ps(NF, _mm_set1_ps(2.12194440e-4f)));
+
+		__m128 P = _mm_add_ps(_mm_mul_ps(R, _mm_set1_ps(1.9875691500e-4f)), _mm_set1_ps(1.3981999507e-3f));
+		P = _mm_add_ps(_mm_mul_ps(P, R), _mm_set1_ps(8.3334519073e-3f));
+		P = _mm_add_ps(_mm_mul_ps(P, R), _mm_set1_ps(4.1665795894e-2f));
+		P = _mm_add_ps(_mm_mul_ps(P, R), _mm_set1_ps(1.6666665459e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, R), _mm_set1_ps(5.0000001201e-1f));
+		__m128 Result = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(P, R), R), R), _mm_set1_ps(1.0f));
+
+		__m128i Half = _mm_srai_epi32(N, 1);
+		Result = _mm_mul_ps(_mm_mul_ps(Result, Pow2i(Half)), Pow2i(_mm_sub_epi32(N, Half)));
+		return Select(_mm_cmpgt_ps(X, _mm_set1_ps(88.72283f)), _mm_set1_ps(std::numeric_limits<float>::infinity()), Result);
+	}
+
+	inline __m128 Log4(__m128 X)
+	{
+		__m128i Bits = _mm_castps_si128(X);
+		__m128i Exponent = _mm_sub_epi32(_mm_srli_epi32(Bits, 23), _mm_set1_epi32(126));
+		__m128 M = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(Bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f000000)));
+		__m128 Small = _mm_cmplt_ps(M, _mm_set1_ps(0.707106781186547524f));
+		Exponent = _mm_add_epi32(Exponent, _mm_castps_si128(Small));
+		__m128 F = _mm_sub_ps(_mm_add_ps(M, _mm_and_ps(Small, M)), _mm_set1_ps(1.0f));
+
+		__m128 Z = _mm_mul_ps(F, F);
+		__m128 P = _mm_add_ps(_mm_mul_ps(F, _mm_set1_ps(7.0376836292e-2f)), _mm_set1_ps(-1.1514610310e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(1.1676998740e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(-1.2420140846e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(1.4249322787e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(-1.6668057665e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(2.0000714765e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(-2.4999993993e-1f));
+		P = _mm_add_ps(_mm_mul_ps(P, F), _mm_set1_ps(3.3333331174e-1f));
+
+		__m128 E = _mm_cvtepi32_ps(Exponent);
+		__m128 Y = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(F, Z), P), _mm_mul_ps(E, _mm_set1_ps(2.12194440e-4f)));
+		Y = _mm_sub_ps(Y, _mm_mul_ps(Z, _mm_set1_ps(0.5f)));
+		__m128 Result = _mm_add_ps(_mm_add_ps(F, Y), _mm_mul_ps(E, _mm_set1_ps(0.693359375f)));
+
+		__m128 Zero = _mm_setzero_ps();
+		__m128 Invalid = Select(_mm_cmpeq_ps(X, Zero), _mm_set1_ps(-std::numeric_limits<float>::infinity()), _mm_set1_ps(std::numeric_limits<float>::quiet_NaN()));
+		return Select(_mm_cmpgt_ps(X, Zero), Result, Invalid);
+	}
+
+	inline __m128 Atan2_4(__m128 Y, __m128 X)
+	{
+		__m128 SignMask = _mm_set1_ps(-0.0f);
+		__m128 AbsX = _mm_andnot_ps(SignMask, X);
+		__m128 AbsY = _mm_andnot_ps(SignMask, Y);
+		__m128 A = _mm_div_ps(_mm_min_ps(AbsX, AbsY), _mm_max_ps(_mm_max_ps(AbsX, AbsY), _mm_set1_ps(FLT_MIN)));
+
+		__m128 S = _mm_mul_ps(A, A);
+		__m128 R = _mm_add_ps(_mm_mul_ps(S, _mm_set1_ps(-0.01172120f)), _mm_set1_ps(0.05265332f));
+		R = _mm_add_ps(_mm_mul_ps(R, S), _mm_set1_ps(-0.11643287f));
+		R = _mm_add_ps(_mm_mul_ps(R, S), _mm_set1_ps(0.19354346f));
+		R = _mm_add_ps(_mm_mul_ps(R, S), _mm_set1_ps(-0.33262347f));
+		R = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(R, S), _mm_set1_ps(0.99997726f)), A);
+
+		R = Select(_mm_cmpgt_ps(AbsY, AbsX), _mm_sub_ps(_mm_set1_ps(1.57079637f), R), R);
+		R = Select(_mm_cmplt_ps(X, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(3.14159274f), R), R);
+		return _mm_xor_ps(R, _mm_and_ps(_mm_cmplt_ps(Y, _mm_setzero_ps()), SignMask));
+	}
+}
+#endif
+
+// Batched versions; In and Out may alias
+
+inline void FastSinCos(const float* In, float* OutSin, float* OutCos, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		__m128 Sin, Cos;
+		FastMathInternal::SinCos4(_mm_loadu_ps(In + Index), Sin, Cos);
+		_mm_storeu_ps(OutSin + Index, Sin);
+		_mm_storeu_ps(OutCos + Index, Cos);
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		FastSinCos(In[Index], OutSin[Index], OutCos[Index]);
+	}
+}
+
+inline void FastTan(const float* In, float* Out, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		_mm_storeu_ps(Out + Index, FastMathInternal::Tan4(_mm_loadu_ps(In + Index)));
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		Out[Index] = FastTan(In[Index]);
+	}
+}
+
+inline void FastExp(const float* In, float* Out, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		_mm_storeu_ps(Out + Index, FastMathInternal::Exp4(_mm_loadu_ps(In + Index)));
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		Out[Index] = FastExp(In[Index]);
+	}
+}
+
+inline void FastLog(const float* In, float* Out, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		_mm_storeu_ps(Out + Index, FastMathInternal::Log4(_mm_loadu_ps(In + Index)));
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		Out[Index] = FastLog(In[Index]);
+	}
+}
+
+inline void FastAtan2(const float* InY, const float* InX, float* Out, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		_mm_storeu_ps(Out + Index, FastMathInternal::Atan2_4(_mm_loadu_ps(InY + Index), _mm_loadu_ps(InX + Index)));
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		Out[Index] = FastAtan2(InY[Index], InX[Index]);
+	}
+}
+
+inline void FastRsqrt(const float* In, float* Out, size_t Num)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		__m128 X = _mm_loadu_ps(In + Index);
+		__m128 Y = _mm_rsqrt_ps(X);
+		Y = _mm_mul_ps(Y, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), X), _mm_mul_ps(Y, Y))));
+		_mm_storeu_ps(Out + Index, Y);
+	}
+#endif
+	for (; Index < Num; ++Index)
+	{
+		Out[Index] = FastRsqrt(In[Index]);
+	}
+}
@@ -1,25 +1,56 @@
 #pragma once
 
 #include "RCUtilsBase.h"
+#include "RCUtilsBit.h"
+#include "RCUtilsCompression.h"
+#include "RCUtilsHash.h"
+#include "RCUtilsMemory.h"
+#include "RCUtilsThread.h"
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
 
 namespace RCUtils
 {
+	// The loaders return plain std containers whether or not tracking is on; their buffers are recorded as
+	// hand offs of the File and String tags (see RecordHandOff)
 	inline std::vector<char> LoadFileToArray(const char* Filename, bool* OutSuccess = nullptr)
 	{
+		RCUTILS_PROFILE_FUNCTION();
 		std::vector<char> OutData;
 		bool bSuccess = false;
-		FILE* File = nullptr;
-		fopen_s(&File, Filename, "rb");
+		FILE* File = OpenStdioFile(Filename, "rb");
 		if (File)
 		{
 			fseek(File, 0, SEEK_END);
 			long Size = ftell(File);
 			fseek(File, 0, SEEK_SET);
-			check(Size > 0);
-			OutData.resize(Size);
-			fread(&OutData[0], 1, Size, File);
+
+			// An empty file loads as an empty array
+			if (Size >= 0)
+			{
+				OutData.resize(Size);
+				bSuccess = Size == 0 || fread(OutData.data(), 1, Size, File) == (size_t)Size;
+			}
 			fclose(File);
-			bSuccess = true;
+			if (!bSuccess)
+			{
+				OutData.clear();
+			}
+			RecordHandOff(EMemoryTag::File, OutData.capacity());
 		}
 
 		if (OutSuccess)
@@ -32,22 +63,28 @@ namespace RCUtils
 
 	inline std::string LoadFileToString(const char* Filename, bool* OutSuccess = nullptr)
 	{
+		RCUTILS_PROFILE_FUNCTION();
 		bool bSuccess = false;
 		std::string OutString;
-		FILE* File;
-		fopen_s(&File, Filename, "rb");
+		FILE* File = OpenStdioFile(Filename, "rb");
 		if (File)
 		{
 			fseek(File, 0, SEEK_END);
 			long Size = ftell(File);
-			check(Size > 0);
-			std::vector<char> Data(Size);
 			fseek(File, 0, SEEK_SET);
-			fread(&Data[0], 1, Size, File);
+
+			// Read straight into the string instead of going through a temporary buffer
+			if (Size >= 0)
+			{
+				OutString.resize(Size);
+				bSuccess = Size == 0 || fread(&OutString[0], 1, Size, File) == (size_t)Size;
+			}
 			fclose(File);
-			OutString.resize(Size);
-			OutString = &Data[0];
-			bSuccess = true;
+			if (!bSuccess)
+			{
+				OutString.clear();
+			}
+			RecordHandOff(EMemoryTag::String, OutString.size());
 		}
 
 		if (OutSuccess)
@@ -58,9 +95,103 @@ namespace RCUtils
 		return OutString;
 	}
 
+	// Same as LoadFileToArray, but files written as compressed frames (see CompressFrame) are decompressed and
+	// checked against the frame's content hash; a mismatch fails the load
+	inline std::vector<char> LoadCompressedFileToArray(const char* Filename, bool* OutSuccess = nullptr, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		bool bSuccess = false;
+		std::vector<char> Data = LoadFileToArray(Filename, &bSuccess);
+		uint64 ContentSize = 0;
+		if (bSuccess && GetCompressedFrameContentSize(Data.data(), Data.size(), ContentSize))
+		{
+			std::vector<char> Decompressed((size_t)ContentSize);
+			RecordHandOff(EMemoryTag::File, Decompressed.size());
+			bSuccess = DecompressFrame(Data.data(), Data.size(), Decompressed.data(), Decompressed.size(), true, NumThreads);
+			Data.swap(Decompressed);
+			if (!bSuccess)
+			{
+				Data.clear();
+			}
+		}
+
+		if (OutSuccess)
+		{
+			*OutSuccess = bSuccess;
+		}
+
+		return Data;
+	}
+
+#if defined(_WIN32)
+	const char PathSeparator = '\\';
+#else
+	const char PathSeparator = '/';
+#endif
+
+	inline bool IsPathSeparator(char Char)
+	{
+		return Char == '/' || Char == '\\';
+	}
+
+	namespace Internal
+	{
+#if !defined(_WIN32)
+		// Lexical like GetFullPathName: relative paths are made absolute against the working directory and "."
+		// and ".." are resolved without touching the file system, so the path doesn't have to exist
+		inline std::string GetFullPath(const std::string& Path)
+		{
+			std::string Input = Path;
+			if (Input.empty() || Input[0] != '/')
+			{
+				char Buffer[4096];
+				Input = (getcwd(Buffer, sizeof(Buffer)) ? std::string(Buffer) : std::string()) + "/" + Input;
+			}
+
+			std::string Out;
+			size_t Begin = 0;
+			while (Begin < Input.size())
+			{
+				size_t End = Input.find('/', Begin);
+				End = End == std::string::npos ? Input.size() : End;
+				size_t Length = End - Begin;
+				if (Length == 2 && Input.compare(Begin, 2, "..") == 0)
+				{
+					Out.resize(Out.empty() ? 0 : Out.rfind('/'));
+				}
+				else if (Length > 0 && !(Length == 1 && Input[Begin] == '.'))
+				{
+					Out += '/';
+					Out.append(Input, Begin, Length);
+				}
+				Begin = End + 1;
+			}
+
+			// Keeps a trailing separator, which means there is no file name
+			if (Out.empty() || Input.back() == '/')
+			{
+				Out += '/';
+			}
+			return Out;
+		}
+
+		inline int64 GetModifiedTime(const struct stat& Stat)
+		{
+#if defined(__APPLE__)
+			return (int64)Stat.st_mtimespec.tv_sec * 1000000000ll + Stat.st_mtimespec.tv_nsec;
+#else
+			return (int64)Stat.st_mtim.tv_sec * 1000000000ll + Stat.st_mtim.tv_nsec;
+#endif
+		}
+#endif
+	}
+
 	// Returns Extension
 	inline std::string SplitPath(const std::string& FullPathToFilename, std::string& OutPath, std::string& OutFilename, bool bIncludeExtension)
 	{
+		RCUTILS_PROFILE_FUNCTION();
+		OutFilename.clear();
+#if defined(_WIN32)
 		char Buffer[1024];
 		char* PtrFilename = nullptr;
 		::GetFullPathNameA(FullPathToFilename.c_str(), sizeof(Buffer), Buffer, &PtrFilename);
@@ -70,6 +201,12 @@ namespace RCUtils
 			OutPath.resize(PtrFilename - Buffer);
 			OutFilename = PtrFilename;
 		}
+#else
+		OutPath = Internal::GetFullPath(FullPathToFilename);
+		size_t FilenameStart = OutPath.rfind('/') + 1;
+		OutFilename = OutPath.substr(FilenameStart);
+		OutPath.resize(FilenameStart);
+#endif
 
 		std::string Extension;
 
@@ -104,24 +241,28 @@ namespace RCUtils
 
 	inline void RemoveQuotes(std::string& Path)
 	{
-		if (Path.size() > 2 && Path.front() == '"')
+		// Paths come from users and command lines, so a missing closing quote is tolerated
+		if (!Path.empty() && Path.front() == '"')
 		{
-			check(Path.back() == '"');
-			Path.pop_back();
-			Path = Path.substr(1);
+			Path.erase(0, 1);
+			if (!Path.empty() && Path.back() == '"')
+			{
+				Path.pop_back();
+			}
 		}
 	}
 
 	inline std::string MakePath(const std::string& Root, const std::string& DirOrFile)
 	{
+		RCUTILS_PROFILE_FUNCTION();
 		std::string Out;
 		if (!Root.empty())
 		{
 			Out = Root;
 			RemoveQuotes(Out);
-			if (Root.back() != '\\')
+			if (!Out.empty() && !IsPathSeparator(Out.back()))
 			{
-				Out += '\\';
+				Out += PathSeparator;
 			}
 		}
 
@@ -134,7 +275,10 @@ namespace RCUtils
 		std::string Path = InPath;
 		if (Path.size() > 2 && Path.front() == '"')
 		{
-			check(Path.back() == '"');
+			if (Path.back() != '"')
+			{
+				Path += '"';
+			}
 		}
 		else
 		{
@@ -148,6 +292,8 @@ namespace RCUtils
 	// Returns true is Src is newer than Dst or if Dst doesn't exist
 	inline bool IsNewerThan(const std::string& Src, const std::string& Dst)
 	{
+		RCUTILS_PROFILE_FUNCTION();
+#if defined(_WIN32)
 		HANDLE SrcHandle = ::CreateFileA(Src.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
 		if (SrcHandle == INVALID_HANDLE_VALUE)
 		{
@@ -162,17 +308,11 @@ namespace RCUtils
 		}
 
 		FILETIME SrcTime, DstTime;
-		if (!::GetFileTime(SrcHandle, nullptr, nullptr, &SrcTime))
-		{
-			auto Error = ::GetLastError();
-			check(0);
-			return false;
-		}
-
-		if (!::GetFileTime(DstHandle, nullptr, nullptr, &DstTime))
+		bool bHasTimes = ::GetFileTime(SrcHandle, nullptr, nullptr, &SrcTime) && ::GetFileTime(DstHandle, nullptr, nullptr, &DstTime);
+		::CloseHandle(DstHandle);
+		::CloseHandle(SrcHandle);
+		if (!bHasTimes)
 		{
-			auto Error = ::GetLastError();
-			check(0);
 			return false;
 		}
 
@@ -190,8 +330,1698 @@ namespace RCUtils
 			bResult = true;
 		}
 
-		::CloseHandle(DstHandle);
-		::CloseHandle(SrcHandle);
 		return bResult;
+#else
+		struct stat SrcStat;
+		struct stat DstStat;
+		if (stat(Src.c_str(), &SrcStat) != 0)
+		{
+			return false;
+		}
+
+		if (stat(Dst.c_str(), &DstStat) != 0)
+		{
+			return true;
+		}
+
+		return Internal::GetModifiedTime(SrcStat) > Internal::GetModifiedTime(DstStat);
+#endif
+	}
+
+	// Read only view of a whole file mapped into the address space
+	class FMappedFile
+	{
+	public:
+		FMappedFile() = default;
+		FMappedFile(const FMappedFile&) = delete;
+		FMappedFile& operator = (const FMappedFile&) = delete;
+
+		~FMappedFile()
+		{
+			Close();
+		}
+
+		bool Open(const char* Filename)
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			Close();
+#if defined(_WIN32)
+			FileHandle = ::CreateFileA(Filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (FileHandle == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			LARGE_INTEGER FileSize;
+			if (!::GetFileSizeEx(FileHandle, &FileSize) || FileSize.QuadPart == 0)
+			{
+				Close();
+				return false;
+			}
+
+			MappingHandle = ::CreateFileMappingA(FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (!MappingHandle)
+			{
+				Close();
+				return false;
+			}
+
+			Data = (const uint8*)::MapViewOfFile(MappingHandle, FILE_MAP_READ, 0, 0, 0);
+			Size = (uint64)FileSize.QuadPart;
+#else
+			FileDescriptor = open(Filename, O_RDONLY);
+			if (FileDescriptor < 0)
+			{
+				return false;
+			}
+
+			struct stat Stat;
+			if (fstat(FileDescriptor, &Stat) != 0 || Stat.st_size == 0)
+			{
+				Close();
+				return false;
+			}
+
+			void* Mapping = mmap(nullptr, (size_t)Stat.st_size, PROT_READ, MAP_SHARED, FileDescriptor, 0);
+			Data = Mapping == MAP_FAILED ? nullptr : (const uint8*)Mapping;
+			Size = (uint64)Stat.st_size;
+#endif
+			if (!Data)
+			{
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void Close()
+		{
+#if defined(_WIN32)
+			if (Data)
+			{
+				::UnmapViewOfFile(Data);
+			}
+			if (MappingHandle)
+			{
+				::CloseHandle(MappingHandle);
+				MappingHandle = nullptr;
+			}
+			if (FileHandle != INVALID_HANDLE_VALUE)
+			{
+				::CloseHandle(FileHandle);
+				FileHandle = INVALID_HANDLE_VALUE;
+			}
+#else
+			if (Data)
+			{
+				munmap((void*)Data, (size_t)Size);
+			}
+			if (FileDescriptor >= 0)
+			{
+				close(FileDescriptor);
+				FileDescriptor = -1;
+			}
+#endif
+			Data = nullptr;
+			Size = 0;
+		}
+
+		bool IsOpen() const
+		{
+			return Data != nullptr;
+		}
+
+		const uint8* GetData() const
+		{
+			return Data;
+		}
+
+		uint64 GetSize() const
+		{
+			return Size;
+		}
+
+	protected:
+		const uint8* Data = nullptr;
+		uint64 Size = 0;
+#if defined(_WIN32)
+		HANDLE FileHandle = INVALID_HANDLE_VALUE;
+		HANDLE MappingHandle = nullptr;
+#else
+		int FileDescriptor = -1;
+#endif
+	};
+
+	struct FDirectoryScanSettings
+	{
+		// Filename wildcards ('*' and '?'), several separated by ';', e.g. "*.png;*.tga". Matched against
+		// the name only; nullptr or "" matches everything.
+		const char* Pattern = nullptr;
+		bool bCaseSensitive = false;
+		bool bRecursive = true;
+
+		// Also report directories that match Pattern; they are always descended into regardless
+		bool bIncludeDirectories = false;
+
+		// Worker threads finish in any order; sorting makes the result deterministic
+		bool bSortByPath = true;
+
+		// 0 = one per hardware thread
+		uint32 NumThreads = 0;
+	};
+
+	struct FDirectoryEntry
+	{
+		uint64 Size;
+		int64 ModifiedTime;		// Nanoseconds since 1970-01-01 UTC
+		size_t PathOffset;		// Into FDirectoryListing::Paths, null terminated
+		uint32 PathLength;
+		bool bDirectory;
+	};
+
+	// Paths are Root + '/' + relative path, stored back to back in one buffer
+	struct FDirectoryListing
+	{
+		std::vector<FDirectoryEntry> Entries;
+		std::string Paths;
+		size_t RootLength = 0;
+
+		const char* GetPath(const FDirectoryEntry& Entry) const
+		{
+			return Paths.data() + Entry.PathOffset;
+		}
+
+		const char* GetRelativePath(const FDirectoryEntry& Entry) const
+		{
+			return Paths.data() + Entry.PathOffset + RootLength + 1;
+		}
+
+		void Clear()
+		{
+			Entries.clear();
+			Paths.clear();
+			RootLength = 0;
+		}
+	};
+
+	namespace Internal
+	{
+		inline char ToLowerAscii(char Char)
+		{
+			return (Char >= 'A' && Char <= 'Z') ? (char)(Char - 'A' + 'a') : Char;
+		}
+
+		// Iterative '*' backtracking: only the position after the last '*' is ever revisited
+		inline bool MatchWildcard(const char* Pattern, const char* PatternEnd, const char* Name, bool bCaseSensitive)
+		{
+			const char* StarPattern = nullptr;
+			const char* StarName = nullptr;
+			while (*Name)
+			{
+				if (Pattern < PatternEnd && *Pattern == '*')
+				{
+					StarPattern = ++Pattern;
+					StarName = Name;
+				}
+				else if (Pattern < PatternEnd && (*Pattern == '?' || *Pattern == *Name || (!bCaseSensitive && ToLowerAscii(*Pattern) == ToLowerAscii(*Name))))
+				{
+					++Pattern;
+					++Name;
+				}
+				else if (StarPattern)
+				{
+					Pattern = StarPattern;
+					Name = ++StarName;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			while (Pattern < PatternEnd && *Pattern == '*')
+			{
+				++Pattern;
+			}
+			return Pattern == PatternEnd;
+		}
+
+		inline bool MatchWildcardList(const char* Patterns, const char* Name, bool bCaseSensitive)
+		{
+			if (!Patterns || !*Patterns)
+			{
+				return true;
+			}
+
+			for (;;)
+			{
+				const char* End = strchr(Patterns, ';');
+				const char* PatternEnd = End ? End : Patterns + strlen(Patterns);
+				if (MatchWildcard(Patterns, PatternEnd, Name, bCaseSensitive))
+				{
+					return true;
+				}
+				if (!End)
+				{
+					return false;
+				}
+				Patterns = End + 1;
+			}
+		}
+
+		// A root such as "/" already ends in a separator
+		inline void AppendPath(std::string& Out, const std::string& Directory, const char* Name)
+		{
+			Out += Directory;
+			if (Directory.empty() || !IsPathSeparator(Directory.back()))
+			{
+				Out += '/';
+			}
+			Out += Name;
+		}
+
+		struct FDirectoryScanWorker
+		{
+			std::vector<FDirectoryEntry> Entries;
+			std::string Paths;
+			std::vector<std::string> Subdirectories;
+			std::vector<char> Buffer;
+
+			void Add(const std::string& Directory, const char* Name, uint64 Size, int64 ModifiedTime, bool bDirectory)
+			{
+				FDirectoryEntry Entry;
+				Entry.Size = Size;
+				Entry.ModifiedTime = ModifiedTime;
+				Entry.PathOffset = Paths.size();
+				Entry.bDirectory = bDirectory;
+				AppendPath(Paths, Directory, Name);
+				Entry.PathLength = (uint32)(Paths.size() - Entry.PathOffset);
+				Paths += '\0';
+				Entries.push_back(Entry);
+			}
+
+			void AddSubdirectory(const std::string& Directory, const char* Name)
+			{
+				Subdirectories.emplace_back();
+				std::string& Path = Subdirectories.back();
+				Path.reserve(Directory.size() + strlen(Name) + 1);
+				AppendPath(Path, Directory, Name);
+			}
+		};
+
+		inline bool IsDotOrDotDot(const char* Name)
+		{
+			return Name[0] == '.' && (Name[1] == 0 || (Name[1] == '.' && Name[2] == 0));
+		}
+
+#if defined(_WIN32)
+		// FILETIME counts 100ns intervals since 1601
+		inline int64 FileTimeToUnixNanoseconds(const FILETIME& Time)
+		{
+			int64 Ticks = (int64)(((uint64)Time.dwHighDateTime << 32) | Time.dwLowDateTime);
+			return (Ticks - 116444736000000000ll) * 100;
+		}
+
+		inline bool ScanSingleDirectory(const std::string& Directory, const FDirectoryScanSettings& Settings, FDirectoryScanWorker& Worker)
+		{
+			// Basic info skips the 8.3 name and large fetch asks for bigger batches per kernel call
+			std::string Search = Directory + "/*";
+			WIN32_FIND_DATAA Data;
+			HANDLE Find = ::FindFirstFileExA(Search.c_str(), FindExInfoBasic, &Data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+			if (Find == INVALID_HANDLE_VALUE)
+			{
+				return false;
+			}
+
+			do
+			{
+				if (IsDotOrDotDot(Data.cFileName))
+				{
+					continue;
+				}
+
+				bool bDirectory = (Data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+				bool bMatch = (!bDirectory || Settings.bIncludeDirectories) && MatchWildcardList(Settings.Pattern, Data.cFileName, Settings.bCaseSensitive);
+				if (bMatch)
+				{
+					uint64 Size = bDirectory ? 0 : (((uint64)Data.nFileSizeHigh << 32) | Data.nFileSizeLow);
+					Worker.Add(Directory, Data.cFileName, Size, FileTimeToUnixNanoseconds(Data.ftLastWriteTime), bDirectory);
+				}
+
+				// Junctions and directory symlinks can form cycles
+				if (bDirectory && Settings.bRecursive && !(Data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT))
+				{
+					Worker.AddSubdirectory(Directory, Data.cFileName);
+				}
+			}
+			while (::FindNextFileA(Find, &Data));
+
+			::FindClose(Find);
+			return true;
+		}
+#else
+		// DT_UNKNOWN comes from file systems that don't fill in the type; symlinks are followed for files but
+		// never descended into, which rules out cycles
+		inline void ScanDirectoryEntry(int DirectoryDescriptor, const std::string& Directory, const char* Name, uint8 Type, const FDirectoryScanSettings& Settings, FDirectoryScanWorker& Worker)
+		{
+			if (IsDotOrDotDot(Name))
+			{
+				return;
+			}
+
+			bool bMatch = MatchWildcardList(Settings.Pattern, Name, Settings.bCaseSensitive);
+			bool bNeedsStat = Type == DT_UNKNOWN || Type == DT_LNK || (bMatch && (Type == DT_REG || Settings.bIncludeDirectories));
+			struct stat Stat;
+			if (bNeedsStat)
+			{
+				if (fstatat(DirectoryDescriptor, Name, &Stat, Type == DT_LNK ? 0 : AT_SYMLINK_NOFOLLOW) != 0)
+				{
+					return;
+				}
+				if (Type == DT_UNKNOWN)
+				{
+					Type = S_ISDIR(Stat.st_mode) ? DT_DIR : (S_ISREG(Stat.st_mode) ? DT_REG : DT_UNKNOWN);
+				}
+			}
+
+			bool bDirectory = Type == DT_DIR;
+			bool bFile = Type == DT_REG || (Type == DT_LNK && S_ISREG(Stat.st_mode));
+			if (bMatch && (bFile || (bDirectory && Settings.bIncludeDirectories)))
+			{
+				Worker.Add(Directory, Name, bFile ? (uint64)Stat.st_size : 0, GetModifiedTime(Stat), bDirectory);
+			}
+
+			if (bDirectory && Settings.bRecursive)
+			{
+				Worker.AddSubdirectory(Directory, Name);
+			}
+		}
+
+#if defined(__linux__)
+		struct FLinuxDirent64
+		{
+			uint64 Inode;
+			int64 Offset;
+			uint16 RecordLength;
+			uint8 Type;
+			char Name[1];
+		};
+#endif
+
+		// Stats go through the open directory so the kernel never walks the full path again
+		inline bool ScanSingleDirectory(const std::string& Directory, const FDirectoryScanSettings& Settings, FDirectoryScanWorker& Worker)
+		{
+			int DirectoryDescriptor = open(Directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (DirectoryDescriptor < 0)
+			{
+				return false;
+			}
+
+#if defined(__linux__)
+			// getdents64 fills a whole buffer of names per call instead of readdir's libc round trips
+			Worker.Buffer.resize(64 * 1024);
+			for (;;)
+			{
+				long NumBytes = syscall(SYS_getdents64, DirectoryDescriptor, Worker.Buffer.data(), Worker.Buffer.size());
+				if (NumBytes <= 0)
+				{
+					break;
+				}
+
+				for (long Position = 0; Position < NumBytes;)
+				{
+					const FLinuxDirent64* Dirent = (const FLinuxDirent64*)(Worker.Buffer.data() + Position);
+					Position += Dirent->RecordLength;
+					ScanDirectoryEntry(DirectoryDescriptor, Directory, Dirent->Name, Dirent->Type, Settings, Worker);
+				}
+			}
+			close(DirectoryDescriptor);
+#else
+			DIR* Dir = fdopendir(DirectoryDescriptor);
+			if (!Dir)
+			{
+				close(DirectoryDescriptor);
+				return false;
+			}
+			while (const dirent* Dirent = readdir(Dir))
+			{
+				ScanDirectoryEntry(dirfd(Dir), Directory, Dirent->d_name, Dirent->d_type, Settings, Worker);
+			}
+			closedir(Dir);
+#endif
+			return true;
+		}
+#endif
+	}
+
+	// Lists the files under Root (and its subdirectories unless bRecursive is off) in a single pass, with
+	// size and modification time. Subdirectories are shared between worker threads through a stack so wide
+	// and deep trees both keep every thread busy. Unreadable subdirectories are skipped; returns false only
+	// if Root itself can't be opened.
+	inline bool ScanDirectory(const char* Root, FDirectoryListing& OutListing, const FDirectoryScanSettings& Settings = FDirectoryScanSettings())
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		OutListing.Clear();
+		std::string RootPath = Root;
+		while (RootPath.size() > 1 && (RootPath.back() == '/' || RootPath.back() == '\\'))
+		{
+			RootPath.pop_back();
+		}
+		// Relative paths start one past RootLength, which for "/" is the root's own separator
+		OutListing.RootLength = !RootPath.empty() && IsPathSeparator(RootPath.back()) ? RootPath.size() - 1 : RootPath.size();
+
+		uint32 NumThreads = Settings.NumThreads ? Settings.NumThreads : GetNumHardwareThreads();
+		std::vector<Internal::FDirectoryScanWorker> Workers(NumThreads);
+		if (!Internal::ScanSingleDirectory(RootPath, Settings, Workers[0]))
+		{
+			return false;
+		}
+
+		std::mutex Mutex;
+		std::condition_variable Condition;
+		std::vector<std::string> Pending;
+		Pending.swap(Workers[0].Subdirectories);
+		uint32 NumActive = 0;
+		ParallelFor(NumThreads, [&](uint32 WorkerIndex)
+		{
+			Internal::FDirectoryScanWorker& Worker = Workers[WorkerIndex];
+			std::string Directory;
+			for (;;)
+			{
+				{
+					// Done once nothing is queued and nobody is scanning a directory that could add more
+					std::unique_lock<std::mutex> Lock(Mutex);
+					Condition.wait(Lock, [&]() { return !Pending.empty() || NumActive == 0; });
+					if (Pending.empty())
+					{
+						return;
+					}
+					Directory.swap(Pending.back());
+					Pending.pop_back();
+					++NumActive;
+				}
+
+				Internal::ScanSingleDirectory(Directory, Settings, Worker);
+
+				bool bWake = false;
+				{
+					std::lock_guard<std::mutex> Lock(Mutex);
+					for (std::string& Subdirectory : Worker.Subdirectories)
+					{
+						Pending.push_back(std::move(Subdirectory));
+					}
+					--NumActive;
+					bWake = !Worker.Subdirectories.empty() || NumActive == 0;
+				}
+				Worker.Subdirectories.clear();
+				if (bWake)
+				{
+					Condition.notify_all();
+				}
+			}
+		}, NumThreads);
+
+		size_t NumEntries = 0;
+		size_t PathsSize = 0;
+		for (const Internal::FDirectoryScanWorker& Worker : Workers)
+		{
+			NumEntries += Worker.Entries.size();
+			PathsSize += Worker.Paths.size();
+		}
+		OutListing.Entries.reserve(NumEntries);
+		OutListing.Paths.reserve(PathsSize);
+		for (const Internal::FDirectoryScanWorker& Worker : Workers)
+		{
+			size_t Base = OutListing.Paths.size();
+			OutListing.Paths += Worker.Paths;
+			for (FDirectoryEntry Entry : Worker.Entries)
+			{
+				Entry.PathOffset += Base;
+				OutListing.Entries.push_back(Entry);
+			}
+		}
+
+		if (Settings.bSortByPath)
+		{
+			const char* Paths = OutListing.Paths.data();
+			std::sort(OutListing.Entries.begin(), OutListing.Entries.end(), [Paths](const FDirectoryEntry& A, const FDirectoryEntry& B)
+			{
+				return strcmp(Paths + A.PathOffset, Paths + B.PathOffset) < 0;
+			});
+		}
+		return true;
+	}
+
+	struct FFileWriterSettings
+	{
+		// Rounded up to a multiple of DirectIOAlignment
+		size_t BufferSize = 4 * 1024 * 1024;
+
+		// Write to a temporary file next to the target and rename it over the target on Commit, so readers
+		// and crashes never see a partial file
+		bool bAtomic = true;
+
+		// Also flush to the device before the rename so the file survives power loss (fsync/FlushFileBuffers)
+		bool bSyncOnCommit = false;
+
+		// Bypass the OS page cache (O_DIRECT / FILE_FLAG_NO_BUFFERING); only worth it for outputs much larger
+		// than the cache. Silently falls back to buffered I/O where unsupported.
+		bool bDirectIO = false;
+
+		// Flush on a background thread while the caller fills a second buffer
+		bool bAsync = false;
+
+		// Reserve disk space up front (fallocate / FileAllocationInfo) to reduce fragmentation; the file size
+		// itself is unaffected
+		uint64 PreallocateSize = 0;
+	};
+
+	namespace Internal
+	{
+#if defined(_WIN32)
+		typedef HANDLE FFileWriterHandle;
+		const FFileWriterHandle InvalidFileWriterHandle = INVALID_HANDLE_VALUE;
+
+		inline FFileWriterHandle OpenFileForWrite(const char* Filename, bool bExclusive, bool bDirectIO)
+		{
+			DWORD Flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | (bDirectIO ? FILE_FLAG_NO_BUFFERING : 0);
+			return ::CreateFileA(Filename, GENERIC_WRITE, 0, nullptr, bExclusive ? CREATE_NEW : CREATE_ALWAYS, Flags, nullptr);
+		}
+
+		inline bool WriteToFile(FFileWriterHandle Handle, const void* Data, size_t Size)
+		{
+			const uint8* Bytes = (const uint8*)Data;
+			while (Size > 0)
+			{
+				DWORD Chunk = (DWORD)Min<size_t>(Size, 1u << 30);
+				DWORD Written = 0;
+				if (!::WriteFile(Handle, Bytes, Chunk, &Written, nullptr) || Written == 0)
+				{
+					return false;
+				}
+				Bytes += Written;
+				Size -= Written;
+			}
+			return true;
+		}
+
+		inline bool WriteToFile(FFileWriterHandle Handle, const void* DataA, size_t SizeA, const void* DataB, size_t SizeB)
+		{
+			return WriteToFile(Handle, DataA, SizeA) && WriteToFile(Handle, DataB, SizeB);
+		}
+
+		inline void PreallocateFile(FFileWriterHandle Handle, uint64 Size)
+		{
+			FILE_ALLOCATION_INFO Info;
+			Info.AllocationSize.QuadPart = (LONGLONG)Size;
+			::SetFileInformationByHandle(Handle, FileAllocationInfo, &Info, sizeof(Info));
+		}
+
+		inline bool TruncateFile(FFileWriterHandle Handle, uint64 Size)
+		{
+			FILE_END_OF_FILE_INFO Info;
+			Info.EndOfFile.QuadPart = (LONGLONG)Size;
+			return ::SetFileInformationByHandle(Handle, FileEndOfFileInfo, &Info, sizeof(Info)) != 0;
+		}
+
+		inline bool SyncFile(FFileWriterHandle Handle)
+		{
+			return ::FlushFileBuffers(Handle) != 0;
+		}
+
+		inline bool CloseFile(FFileWriterHandle Handle)
+		{
+			return ::CloseHandle(Handle) != 0;
+		}
+
+		inline bool MoveFileOver(const char* From, const char* To)
+		{
+			return ::MoveFileExA(From, To, MOVEFILE_REPLACE_EXISTING) != 0;
+		}
+
+		inline void RemoveFile(const char* Filename)
+		{
+			::DeleteFileA(Filename);
+		}
+
+		inline uint32 GetProcessIdForTempName()
+		{
+			return (uint32)::GetCurrentProcessId();
+		}
+#else
+		typedef int FFileWriterHandle;
+		const FFileWriterHandle InvalidFileWriterHandle = -1;
+
+		inline FFileWriterHandle OpenFileForWrite(const char* Filename, bool bExclusive, bool bDirectIO)
+		{
+			int Flags = O_WRONLY | O_CREAT | O_CLOEXEC | (bExclusive ? O_EXCL : O_TRUNC);
+#if defined(O_DIRECT)
+			Flags |= bDirectIO ? O_DIRECT : 0;
+#else
+			(void)bDirectIO;
+#endif
+			return open(Filename, Flags, 0644);
+		}
+
+		// writev with the partial write bookkeeping; iovcnt is at most 2 here
+		inline bool WriteToFile(FFileWriterHandle Handle, const void* DataA, size_t SizeA, const void* DataB, size_t SizeB)
+		{
+			iovec Vectors[2] = { { (void*)DataA, SizeA }, { (void*)DataB, SizeB } };
+			iovec* Next = Vectors;
+			int NumVectors = 2;
+			while (NumVectors > 0)
+			{
+				ssize_t Written = writev(Handle, Next, NumVectors);
+				if (Written < 0)
+				{
+					if (errno == EINTR)
+					{
+						continue;
+					}
+					return false;
+				}
+
+				while (NumVectors > 0 && (size_t)Written >= Next->iov_len)
+				{
+					Written -= (ssize_t)Next->iov_len;
+					++Next;
+					--NumVectors;
+				}
+				if (NumVectors > 0)
+				{
+					Next->iov_base = (uint8*)Next->iov_base + Written;
+					Next->iov_len -= (size_t)Written;
+				}
+			}
+			return true;
+		}
+
+		inline bool WriteToFile(FFileWriterHandle Handle, const void* Data, size_t Size)
+		{
+			return WriteToFile(Handle, Data, Size, nullptr, 0);
+		}
+
+		inline void PreallocateFile(FFileWriterHandle Handle, uint64 Size)
+		{
+#if defined(__linux__)
+			fallocate(Handle, FALLOC_FL_KEEP_SIZE, 0, (off_t)Size);
+#else
+			(void)Handle;
+			(void)Size;
+#endif
+		}
+
+		inline bool TruncateFile(FFileWriterHandle Handle, uint64 Size)
+		{
+			return ftruncate(Handle, (off_t)Size) == 0;
+		}
+
+		inline bool SyncFile(FFileWriterHandle Handle)
+		{
+			return fsync(Handle) == 0;
+		}
+
+		inline bool CloseFile(FFileWriterHandle Handle)
+		{
+			return close(Handle) == 0;
+		}
+
+		inline bool MoveFileOver(const char* From, const char* To)
+		{
+			return rename(From, To) == 0;
+		}
+
+		inline void RemoveFile(const char* Filename)
+		{
+			unlink(Filename);
+		}
+
+		inline uint32 GetProcessIdForTempName()
+		{
+			return (uint32)getpid();
+		}
+#endif
+	}
+
+	// Buffered sequential writer for cooked output. Small writes are copied into the buffer; a write that
+	// doesn't fit goes out together with the buffered bytes in one vectored call instead of being copied.
+	// Nothing is visible at Filename until Commit() succeeds (in atomic mode); destroying the writer
+	// without committing discards the output.
+	//
+	//	RCUtils::FFileWriter Writer;
+	//	bool bSuccess = Writer.Open("out.bin") && Writer.Write(Header) && Writer.Write(Data, Size) && Writer.Commit();
+	class FFileWriter
+	{
+	public:
+		enum
+		{
+			// Sector/page multiple required by unbuffered I/O for buffer addresses, sizes and offsets
+			DirectIOAlignment = 4096,
+		};
+
+		FFileWriter() = default;
+		FFileWriter(const FFileWriter&) = delete;
+		FFileWriter& operator = (const FFileWriter&) = delete;
+
+		~FFileWriter()
+		{
+			Abort();
+		}
+
+		bool Open(const char* InFilename, const FFileWriterSettings& InSettings = FFileWriterSettings())
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			Abort();
+			Settings = InSettings;
+			Filename = InFilename;
+			if (Settings.bAtomic)
+			{
+				// Same directory as the target so the rename never crosses file systems
+				static std::atomic<uint32> Counter{0};
+				char Suffix[32];
+				snprintf(Suffix, sizeof(Suffix), ".tmp%x_%x", Internal::GetProcessIdForTempName(), Counter.fetch_add(1, std::memory_order_relaxed));
+				WritePath = Filename + Suffix;
+			}
+			else
+			{
+				WritePath = Filename;
+			}
+
+			bDirectIO = Settings.bDirectIO;
+			Handle = Internal::OpenFileForWrite(WritePath.c_str(), Settings.bAtomic, bDirectIO);
+			if (Handle == Internal::InvalidFileWriterHandle && bDirectIO)
+			{
+				bDirectIO = false;
+				Handle = Internal::OpenFileForWrite(WritePath.c_str(), Settings.bAtomic, false);
+			}
+			if (Handle == Internal::InvalidFileWriterHandle)
+			{
+				return false;
+			}
+
+			if (Settings.PreallocateSize > 0)
+			{
+				Internal::PreallocateFile(Handle, Settings.PreallocateSize);
+			}
+
+			BufferCapacity = Align<size_t>(Max<size_t>(Settings.BufferSize, DirectIOAlignment), DirectIOAlignment);
+			Buffer = AllocateBuffer();
+			BufferUsed = 0;
+			Size = 0;
+			bError = false;
+			if (Settings.bAsync)
+			{
+				BackBuffer = AllocateBuffer();
+				bBackgroundBusy = false;
+				bBackgroundStop = false;
+				bBackgroundError = false;
+				BackgroundThread = std::thread([this]() { BackgroundLoop(); });
+			}
+			return true;
+		}
+
+		bool Write(const void* Data, size_t NumBytes)
+		{
+			// Common case first: fits in the buffer. A closed writer has no capacity, so it never gets here.
+			if (NumBytes < BufferCapacity - BufferUsed && !bError)
+			{
+				memcpy(Buffer + BufferUsed, Data, NumBytes);
+				BufferUsed += NumBytes;
+				Size += NumBytes;
+				return true;
+			}
+
+			if (!IsOpen() || bError)
+			{
+				bError = true;
+				return false;
+			}
+
+			Size += NumBytes;
+			const uint8* Bytes = (const uint8*)Data;
+
+			// Large writes skip the copy; unbuffered and async writes need the data in the aligned buffer
+			if (!bDirectIO && !Settings.bAsync && NumBytes >= BufferCapacity - BufferUsed && NumBytes >= BufferCapacity / 2)
+			{
+				bError = !Internal::WriteToFile(Handle, Buffer, BufferUsed, Bytes, NumBytes);
+				BufferUsed = 0;
+				return !bError;
+			}
+
+			while (NumBytes > 0)
+			{
+				size_t Chunk = Min(NumBytes, BufferCapacity - BufferUsed);
+				memcpy(Buffer + BufferUsed, Bytes, Chunk);
+				BufferUsed += Chunk;
+				Bytes += Chunk;
+				NumBytes -= Chunk;
+				if (BufferUsed == BufferCapacity && !FlushBuffer(false))
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		template <typename T>
+		bool Write(const T& Value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Write(Value) needs a trivially copyable type");
+			return Write(&Value, sizeof(T));
+		}
+
+		// Hands the buffered bytes to the OS (in async mode, to the background thread)
+		bool Flush()
+		{
+			return IsOpen() && !bError && FlushBuffer(false);
+		}
+
+		// Writes out everything, closes the file and moves it into place. The writer is closed either way.
+		bool Commit()
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			if (!IsOpen())
+			{
+				return false;
+			}
+
+			bool bSuccess = !bError && FlushBuffer(true) && WaitForBackground();
+			StopBackground();
+
+			// Unbuffered writes are padded to whole sectors; cut the file back to what was written
+			if (bSuccess && bDirectIO)
+			{
+				bSuccess = Internal::TruncateFile(Handle, Size);
+			}
+			if (bSuccess && Settings.bSyncOnCommit)
+			{
+				bSuccess = Internal::SyncFile(Handle);
+			}
+			bSuccess = Internal::CloseFile(Handle) && bSuccess;
+			Handle = Internal::InvalidFileWriterHandle;
+			if (bSuccess && Settings.bAtomic)
+			{
+				bSuccess = Internal::MoveFileOver(WritePath.c_str(), Filename.c_str());
+			}
+			if (!bSuccess)
+			{
+				Internal::RemoveFile(WritePath.c_str());
+			}
+
+			FreeBuffers();
+			return bSuccess;
+		}
+
+		// Closes and deletes the output without touching Filename (in atomic mode)
+		void Abort()
+		{
+			if (!IsOpen())
+			{
+				return;
+			}
+
+			StopBackground();
+			Internal::CloseFile(Handle);
+			Handle = Internal::InvalidFileWriterHandle;
+			Internal::RemoveFile(WritePath.c_str());
+			FreeBuffers();
+		}
+
+		bool IsOpen() const
+		{
+			return Handle != Internal::InvalidFileWriterHandle;
+		}
+
+		// Sticky: once a write fails every later call fails and Commit discards the file
+		bool HasError() const
+		{
+			return bError;
+		}
+
+		// Bytes written so far, buffered or not
+		uint64 GetSize() const
+		{
+			return Size;
+		}
+
+	protected:
+		// The unaligned allocation pointer is stashed right before the aligned buffer
+		uint8* AllocateBuffer()
+		{
+			uint8* Allocation = (uint8*)TaggedAlloc(EMemoryTag::File, BufferCapacity + DirectIOAlignment + sizeof(void*));
+			uint8* Aligned = (uint8*)Align<uintptr_t>((uintptr_t)Allocation + sizeof(void*), DirectIOAlignment);
+			memcpy(Aligned - sizeof(void*), &Allocation, sizeof(void*));
+			return Aligned;
+		}
+
+		void FreeBuffer(uint8*& InOutBuffer)
+		{
+			if (InOutBuffer)
+			{
+				uint8* Allocation;
+				memcpy(&Allocation, InOutBuffer - sizeof(void*), sizeof(void*));
+				TaggedFree(EMemoryTag::File, Allocation, BufferCapacity + DirectIOAlignment + sizeof(void*));
+				InOutBuffer = nullptr;
+			}
+		}
+
+		void FreeBuffers()
+		{
+			FreeBuffer(Buffer);
+			FreeBuffer(BackBuffer);
+			BufferUsed = 0;
+			BufferCapacity = 0;
+		}
+
+		// Unbuffered files only take whole sectors: intermediate flushes keep the unaligned tail buffered and
+		// the final one pads it with zeros (trimmed again in Commit)
+		bool FlushBuffer(bool bFinal)
+		{
+			size_t WriteSize = BufferUsed;
+			size_t Remainder = 0;
+			if (bDirectIO)
+			{
+				if (bFinal)
+				{
+					WriteSize = Align<size_t>(BufferUsed, DirectIOAlignment);
+					memset(Buffer + BufferUsed, 0, WriteSize - BufferUsed);
+				}
+				else
+				{
+					Remainder = BufferUsed & (DirectIOAlignment - 1);
+					WriteSize = BufferUsed - Remainder;
+				}
+			}
+
+			if (Settings.bAsync)
+			{
+				if (!WaitForBackground())
+				{
+					return false;
+				}
+
+				std::swap(Buffer, BackBuffer);
+				memcpy(Buffer, BackBuffer + WriteSize, Remainder);
+				{
+					std::lock_guard<std::mutex> Lock(BackgroundMutex);
+					BackgroundSize = WriteSize;
+					bBackgroundBusy = true;
+				}
+				BackgroundCondition.notify_all();
+			}
+			else
+			{
+				bError = !Internal::WriteToFile(Handle, Buffer, WriteSize);
+				memmove(Buffer, Buffer + WriteSize, Remainder);
+			}
+
+			BufferUsed = Remainder;
+			return !bError;
+		}
+
+		bool WaitForBackground()
+		{
+			if (Settings.bAsync)
+			{
+				std::unique_lock<std::mutex> Lock(BackgroundMutex);
+				BackgroundCondition.wait(Lock, [this]() { return !bBackgroundBusy; });
+				bError |= bBackgroundError;
+			}
+			return !bError;
+		}
+
+		void StopBackground()
+		{
+			if (BackgroundThread.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> Lock(BackgroundMutex);
+					bBackgroundStop = true;
+				}
+				BackgroundCondition.notify_all();
+				BackgroundThread.join();
+			}
+		}
+
+		void BackgroundLoop()
+		{
+			std::unique_lock<std::mutex> Lock(BackgroundMutex);
+			for (;;)
+			{
+				BackgroundCondition.wait(Lock, [this]() { return bBackgroundBusy || bBackgroundStop; });
+				if (!bBackgroundBusy)
+				{
+					return;
+				}
+
+				// BackBuffer is owned by this thread until bBackgroundBusy is cleared
+				Lock.unlock();
+				bool bSuccess = Internal::WriteToFile(Handle, BackBuffer, BackgroundSize);
+				Lock.lock();
+				bBackgroundError |= !bSuccess;
+				bBackgroundBusy = false;
+				BackgroundCondition.notify_all();
+			}
+		}
+
+		FFileWriterSettings Settings;
+		std::string Filename;
+		std::string WritePath;
+		Internal::FFileWriterHandle Handle = Internal::InvalidFileWriterHandle;
+		bool bDirectIO = false;
+		bool bError = false;
+		uint64 Size = 0;
+		uint8* Buffer = nullptr;
+		size_t BufferUsed = 0;
+		size_t BufferCapacity = 0;
+
+		// Async mode
+		uint8* BackBuffer = nullptr;
+		size_t BackgroundSize = 0;
+		bool bBackgroundBusy = false;
+		bool bBackgroundStop = false;
+		bool bBackgroundError = false;
+		std::mutex BackgroundMutex;
+		std::condition_variable BackgroundCondition;
+		std::thread BackgroundThread;
+	};
+
+	// Counterpart of LoadFileToArray; atomic by default, see FFileWriterSettings
+	inline bool SaveArrayToFile(const char* Filename, const void* Data, size_t Size, const FFileWriterSettings& Settings = FFileWriterSettings())
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		FFileWriter Writer;
+		return Writer.Open(Filename, Settings) && Writer.Write(Data, Size) && Writer.Commit();
+	}
+
+	template <typename TArray>
+	inline bool SaveArrayToFile(const char* Filename, const TArray& Array, const FFileWriterSettings& Settings = FFileWriterSettings())
+	{
+		return SaveArrayToFile(Filename, Array.data(), Array.size() * sizeof(*Array.data()), Settings);
+	}
+
+	// Packed archive layout:
+	//	FArchiveHeader
+	//	Entry payloads, each starting on a DataAlignment boundary
+	//	FArchiveEntry[NumEntries], sorted by PathHash
+	//	uint32 HashSlots[NumHashSlots], open addressed by PathHash, holding entry index + 1 (0 = empty)
+	//	Normalized entry paths (lower case, '/' separators), not null terminated
+	enum class EArchiveCompression : uint8
+	{
+		None,
+
+		// Payload is a compressed frame (RCUtilsCompression.h); entries that don't shrink are stored as None
+		Fast,
+		High,
+	};
+
+	struct FArchiveHeader
+	{
+		enum
+		{
+			ExpectedMagic = 0x52414352,	// 'RCAR'
+			ExpectedVersion = 1,
+		};
+
+		uint32 Magic;
+		uint32 Version;
+		uint32 NumEntries;
+		uint32 NumHashSlots;
+		uint64 EntriesOffset;
+		uint64 HashSlotsOffset;
+		uint64 NamesOffset;
+		uint64 NamesSize;
+	};
+
+	struct FArchiveEntry
+	{
+		uint64 PathHash;
+		uint64 ContentHash;		// Hash64 of the uncompressed bytes
+		uint64 Offset;			// From the start of the archive
+		uint64 Size;			// Uncompressed size
+		uint64 StoredSize;		// Size in the archive
+		uint32 NameOffset;
+		uint16 NameLength;
+		EArchiveCompression Compression;
+		uint8 Pad;
+	};
+
+	namespace Internal
+	{
+		inline char NormalizeArchivePathChar(char Char)
+		{
+			if (Char == '\\')
+			{
+				return '/';
+			}
+			return (Char >= 'A' && Char <= 'Z') ? (char)(Char - 'A' + 'a') : Char;
+		}
+
+		inline const char* SkipArchivePathPrefix(const char* Path)
+		{
+			while (*Path == '/' || *Path == '\\')
+			{
+				++Path;
+			}
+			return Path;
+		}
+
+		// FNV-1a over the normalized characters, so lookups never have to build a normalized copy
+		inline uint64 HashArchivePath(const char* Path)
+		{
+			uint64 Hash = 0xcbf29ce484222325ull;
+			for (Path = SkipArchivePathPrefix(Path); *Path; ++Path)
+			{
+				Hash ^= (uint8)NormalizeArchivePathChar(*Path);
+				Hash *= 0x100000001b3ull;
+			}
+			return HashMix64(Hash);
+		}
+
+		inline std::string NormalizeArchivePath(const char* Path)
+		{
+			std::string Out;
+			for (Path = SkipArchivePathPrefix(Path); *Path; ++Path)
+			{
+				Out += NormalizeArchivePathChar(*Path);
+			}
+			return Out;
+		}
+
+		// Offset + Num * ElementSize <= Size, without overflowing on hostile values
+		inline bool IsArchiveRangeValid(uint64 Offset, uint64 Num, uint64 ElementSize, uint64 Size)
+		{
+			return Offset <= Size && Num <= (Size - Offset) / ElementSize;
+		}
+
+		inline bool WritePadding(FILE* File, uint64 Size)
+		{
+			static const uint8 Zeros[256] = {};
+			while (Size > 0)
+			{
+				size_t Chunk = (size_t)Min<uint64>(Size, sizeof(Zeros));
+				if (fwrite(Zeros, 1, Chunk, File) != Chunk)
+				{
+					return false;
+				}
+				Size -= Chunk;
+			}
+			return true;
+		}
+	}
+
+	class FArchiveWriter
+	{
+	public:
+		// SourceFilename is only read when Write() runs
+		void AddFile(const std::string& ArchivePath, const std::string& SourceFilename, EArchiveCompression Compression = EArchiveCompression::None)
+		{
+			Pending.emplace_back();
+			Pending.back().Path = ArchivePath;
+			Pending.back().SourceFilename = SourceFilename;
+			Pending.back().Compression = Compression;
+		}
+
+		void AddData(const std::string& ArchivePath, const void* Data, size_t Size, EArchiveCompression Compression = EArchiveCompression::None)
+		{
+			Pending.emplace_back();
+			Pending.back().Path = ArchivePath;
+			Pending.back().Data.assign((const char*)Data, (const char*)Data + Size);
+			Pending.back().Compression = Compression;
+		}
+
+		// Fails on unreadable inputs or on two paths that normalize to the same key
+		bool Write(const char* Filename, uint32 DataAlignment = 16)
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			checkAlways(IsPowerOfTwo(DataAlignment));
+
+			std::vector<FArchiveEntry> Entries(Pending.size());
+			std::vector<std::string> Names(Pending.size());
+			for (size_t Index = 0; Index < Pending.size(); ++Index)
+			{
+				MemZero(Entries[Index]);
+				Names[Index] = Internal::NormalizeArchivePath(Pending[Index].Path.c_str());
+				Entries[Index].PathHash = Internal::HashArchivePath(Names[Index].c_str());
+				Entries[Index].Compression = Pending[Index].Compression;
+				if (Names[Index].empty() || Names[Index].size() > 0xffff)
+				{
+					return false;
+				}
+			}
+
+			// Sort by hash (then name) so the table is deterministic and can be binary searched too
+			std::vector<uint32> Order(Pending.size());
+			for (uint32 Index = 0; Index < (uint32)Order.size(); ++Index)
+			{
+				Order[Index] = Index;
+			}
+			std::sort(Order.begin(), Order.end(), [&](uint32 A, uint32 B)
+			{
+				return Entries[A].PathHash != Entries[B].PathHash ? Entries[A].PathHash < Entries[B].PathHash : Names[A] < Names[B];
+			});
+			for (size_t Index = 1; Index < Order.size(); ++Index)
+			{
+				if (Names[Order[Index - 1]] == Names[Order[Index]])
+				{
+					return false;
+				}
+			}
+
+			FILE* File = OpenStdioFile(Filename, "wb");
+			if (!File)
+			{
+				return false;
+			}
+
+			FArchiveHeader Header;
+			MemZero(Header);
+			bool bSuccess = fwrite(&Header, sizeof(Header), 1, File) == 1;
+			uint64 Offset = sizeof(Header);
+
+			std::vector<FArchiveEntry> SortedEntries;
+			std::string NamesBlob;
+			for (uint32 SourceIndex : Order)
+			{
+				if (!bSuccess)
+				{
+					break;
+				}
+
+				FPendingEntry& Source = Pending[SourceIndex];
+				FArchiveEntry Entry = Entries[SourceIndex];
+				if (!Source.SourceFilename.empty())
+				{
+					bool bLoaded = false;
+					std::vector<char> Loaded = LoadFileToArray(Source.SourceFilename.c_str(), &bLoaded);
+					if (!bLoaded)
+					{
+						bSuccess = false;
+						break;
+					}
+					Source.Data.assign(Loaded.begin(), Loaded.end());
+				}
+
+				// Empty payloads are stored as is; there is nothing to compress and no bytes to write
+				std::vector<char> Compressed;
+				if (Source.Data.empty())
+				{
+					Entry.Compression = EArchiveCompression::None;
+				}
+				else if (Entry.Compression != EArchiveCompression::None)
+				{
+					ECompressionLevel Level = Entry.Compression == EArchiveCompression::High ? ECompressionLevel::High : ECompressionLevel::Fast;
+					std::vector<uint8> Frame = CompressFrame(Source.Data.data(), Source.Data.size(), Level);
+					if (Frame.size() < Source.Data.size())
+					{
+						Compressed.assign(Frame.begin(), Frame.end());
+					}
+					else
+					{
+						Entry.Compression = EArchiveCompression::None;
+					}
+				}
+
+				const std::vector<char>& Stored = Entry.Compression != EArchiveCompression::None ? Compressed : Source.Data;
+				Entry.Size = Source.Data.size();
+				Entry.ContentHash = Hash64(Source.Data.data(), Source.Data.size());
+				Entry.StoredSize = Stored.size();
+
+				// Frames are parsed in place, so they keep at least their header's alignment
+				uint64 EntryAlignment = Entry.Compression != EArchiveCompression::None ? Max<uint64>(DataAlignment, alignof(FCompressedFrameHeader)) : DataAlignment;
+				uint64 AlignedOffset = Align<uint64>(Offset, EntryAlignment);
+				bSuccess = Internal::WritePadding(File, AlignedOffset - Offset) && (Stored.empty() || fwrite(Stored.data(), 1, Stored.size(), File) == Stored.size());
+				Entry.Offset = AlignedOffset;
+				Offset = AlignedOffset + Stored.size();
+
+				Entry.NameOffset = (uint32)NamesBlob.size();
+				Entry.NameLength = (uint16)Names[SourceIndex].size();
+				NamesBlob += Names[SourceIndex];
+				SortedEntries.push_back(Entry);
+
+				// Don't keep every payload alive until the end
+				std::vector<char>().swap(Source.Data);
+			}
+
+			uint32 NumHashSlots = (uint32)RoundUpToPowerOfTwo(Max<uint64>(SortedEntries.size() * 2, 1));
+			std::vector<uint32> HashSlots(NumHashSlots, 0);
+			for (uint32 Index = 0; Index < (uint32)SortedEntries.size(); ++Index)
+			{
+				uint32 Slot = (uint32)SortedEntries[Index].PathHash & (NumHashSlots - 1);
+				while (HashSlots[Slot] != 0)
+				{
+					Slot = (Slot + 1) & (NumHashSlots - 1);
+				}
+				HashSlots[Slot] = Index + 1;
+			}
+
+			if (bSuccess)
+			{
+				uint64 EntriesOffset = Align<uint64>(Offset, 8);
+				Header.Magic = FArchiveHeader::ExpectedMagic;
+				Header.Version = FArchiveHeader::ExpectedVersion;
+				Header.NumEntries = (uint32)SortedEntries.size();
+				Header.NumHashSlots = NumHashSlots;
+				Header.EntriesOffset = EntriesOffset;
+				Header.HashSlotsOffset = EntriesOffset + SortedEntries.size() * sizeof(FArchiveEntry);
+				Header.NamesOffset = Header.HashSlotsOffset + HashSlots.size() * sizeof(uint32);
+				Header.NamesSize = NamesBlob.size();
+
+				bSuccess = Internal::WritePadding(File, EntriesOffset - Offset)
+					&& fwrite(SortedEntries.data(), sizeof(FArchiveEntry), SortedEntries.size(), File) == SortedEntries.size()
+					&& fwrite(HashSlots.data(), sizeof(uint32), HashSlots.size(), File) == HashSlots.size()
+					&& fwrite(NamesBlob.data(), 1, NamesBlob.size(), File) == NamesBlob.size()
+					&& fseek(File, 0, SEEK_SET) == 0
+					&& fwrite(&Header, sizeof(Header), 1, File) == 1;
+			}
+
+			bSuccess = (fclose(File) == 0) && bSuccess;
+			if (!bSuccess)
+			{
+				remove(Filename);
+			}
+			return bSuccess;
+		}
+
+	protected:
+		struct FPendingEntry
+		{
+			std::string Path;
+			std::string SourceFilename;
+			std::vector<char> Data;
+			EArchiveCompression Compression = EArchiveCompression::None;
+		};
+
+		std::vector<FPendingEntry> Pending;
+	};
+
+	class FArchiveReader
+	{
+	public:
+		bool Open(const char* Filename)
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			Close();
+			if (!File.Open(Filename) || File.GetSize() < sizeof(FArchiveHeader))
+			{
+				Close();
+				return false;
+			}
+
+			// Everything the lookups trust is validated once here, so a truncated or hostile archive fails to open
+			// instead of reading out of bounds later
+			const uint8* Base = File.GetData();
+			uint64 Size = File.GetSize();
+			Header = (const FArchiveHeader*)Base;
+			if (Header->Magic != FArchiveHeader::ExpectedMagic || Header->Version != FArchiveHeader::ExpectedVersion
+				|| Header->NumHashSlots == 0 || !IsPowerOfTwo(Header->NumHashSlots)
+				|| Header->EntriesOffset % alignof(FArchiveEntry) != 0 || Header->HashSlotsOffset % alignof(uint32) != 0
+				|| !Internal::IsArchiveRangeValid(Header->EntriesOffset, Header->NumEntries, sizeof(FArchiveEntry), Size)
+				|| !Internal::IsArchiveRangeValid(Header->HashSlotsOffset, Header->NumHashSlots, sizeof(uint32), Size)
+				|| !Internal::IsArchiveRangeValid(Header->NamesOffset, Header->NamesSize, 1, Size))
+			{
+				Close();
+				return false;
+			}
+
+			Entries = (const FArchiveEntry*)(Base + Header->EntriesOffset);
+			HashSlots = (const uint32*)(Base + Header->HashSlotsOffset);
+			Names = (const char*)(Base + Header->NamesOffset);
+			if (!ValidateTables(Size))
+			{
+				Close();
+				return false;
+			}
+			return true;
+		}
+
+		void Close()
+		{
+			File.Close();
+			Header = nullptr;
+			Entries = nullptr;
+			HashSlots = nullptr;
+			Names = nullptr;
+		}
+
+		bool IsOpen() const
+		{
+			return Header != nullptr;
+		}
+
+		// Path is matched case insensitively with either separator
+		const FArchiveEntry* FindEntry(const char* Path) const
+		{
+			if (!Header)
+			{
+				return nullptr;
+			}
+
+			uint64 PathHash = Internal::HashArchivePath(Path);
+			uint32 Mask = Header->NumHashSlots - 1;
+			for (uint32 Slot = (uint32)PathHash & Mask; HashSlots[Slot] != 0; Slot = (Slot + 1) & Mask)
+			{
+				const FArchiveEntry& Entry = Entries[HashSlots[Slot] - 1];
+				if (Entry.PathHash == PathHash && MatchesPath(Entry, Path))
+				{
+					return &Entry;
+				}
+			}
+			return nullptr;
+		}
+
+		// Zero copy view of an uncompressed entry; the pointer lives as long as the archive stays open
+		bool GetView(const char* Path, const uint8*& OutData, uint64& OutSize) const
+		{
+			const FArchiveEntry* Entry = FindEntry(Path);
+			if (!Entry || Entry->Compression != EArchiveCompression::None)
+			{
+				return false;
+			}
+
+			OutData = GetStoredData(*Entry);
+			OutSize = Entry->Size;
+			return OutData != nullptr;
+		}
+
+		// Copies (and if needed decompresses) an entry
+		bool ReadEntry(const FArchiveEntry& Entry, std::vector<char>& OutData) const
+		{
+			const uint8* Stored = GetStoredData(Entry);
+			if (!Stored)
+			{
+				return false;
+			}
+			if (Entry.Compression == EArchiveCompression::None)
+			{
+				OutData.assign((const char*)Stored, (const char*)Stored + Entry.StoredSize);
+				return true;
+			}
+
+			OutData.resize((size_t)Entry.Size);
+			return DecompressFrame(Stored, (size_t)Entry.StoredSize, OutData.data(), OutData.size());
+		}
+
+		// Decompresses into caller owned memory (eg an arena); OutData needs Entry.Size bytes
+		bool ReadEntry(const FArchiveEntry& Entry, void* OutData, uint64 Capacity) const
+		{
+			if (Capacity < Entry.Size)
+			{
+				return false;
+			}
+
+			const uint8* Stored = GetStoredData(Entry);
+			if (!Stored)
+			{
+				return false;
+			}
+			if (Entry.Compression == EArchiveCompression::None)
+			{
+				if (Entry.StoredSize != Entry.Size)
+				{
+					return false;
+				}
+				memcpy(OutData, Stored, (size_t)Entry.Size);
+				return true;
+			}
+
+			return DecompressFrame(Stored, (size_t)Entry.StoredSize, OutData, (size_t)Capacity);
+		}
+
+		// Checks the stored content hash against the uncompressed bytes
+		bool Validate(const FArchiveEntry& Entry) const
+		{
+			std::vector<char> Data;
+			return ReadEntry(Entry, Data) && Hash64(Data.data(), Data.size()) == Entry.ContentHash;
+		}
+
+		uint32 GetNumEntries() const
+		{
+			return Header ? Header->NumEntries : 0;
+		}
+
+		const FArchiveEntry& GetEntry(uint32 Index) const
+		{
+			checkAlways(Index < GetNumEntries());
+			return Entries[Index];
+		}
+
+		std::string GetEntryPath(const FArchiveEntry& Entry) const
+		{
+			return std::string(Names + Entry.NameOffset, Entry.NameLength);
+		}
+
+		// Null if Entry's stored range is not inside the archive (only possible for entries from elsewhere)
+		const uint8* GetStoredData(const FArchiveEntry& Entry) const
+		{
+			if (!Header || !Internal::IsArchiveRangeValid(Entry.Offset, Entry.StoredSize, 1, File.GetSize()))
+			{
+				return nullptr;
+			}
+			return File.GetData() + Entry.Offset;
+		}
+
+	protected:
+		bool ValidateTables(uint64 Size) const
+		{
+			for (uint32 Index = 0; Index < Header->NumEntries; ++Index)
+			{
+				const FArchiveEntry& Entry = Entries[Index];
+				if ((uint64)Entry.NameOffset + Entry.NameLength > Header->NamesSize
+					|| !Internal::IsArchiveRangeValid(Entry.Offset, Entry.StoredSize, 1, Size)
+					|| Entry.Compression > EArchiveCompression::High
+					|| (Entry.Compression == EArchiveCompression::None && Entry.StoredSize != Entry.Size))
+				{
+					return false;
+				}
+
+				// ReadEntry allocates Entry.Size up front, so it has to agree with the frame and be a size the
+				// stored bytes can actually expand to (an LZ4 sequence byte covers at most 255 output bytes)
+				uint64 ContentSize = 0;
+				if (Entry.Compression != EArchiveCompression::None
+					&& (Entry.Offset % alignof(FCompressedFrameHeader) != 0
+						|| !GetCompressedFrameContentSize(File.GetData() + Entry.Offset, (size_t)Entry.StoredSize, ContentSize)
+						|| ContentSize != Entry.Size || Entry.Size / 256 > Entry.StoredSize))
+				{
+					return false;
+				}
+			}
+
+			// Probes stop at an empty slot, so there has to be one
+			bool bHasEmptySlot = false;
+			for (uint32 Slot = 0; Slot < Header->NumHashSlots; ++Slot)
+			{
+				if (HashSlots[Slot] > Header->NumEntries)
+				{
+					return false;
+				}
+				bHasEmptySlot |= HashSlots[Slot] == 0;
+			}
+			return bHasEmptySlot;
+		}
+
+		bool MatchesPath(const FArchiveEntry& Entry, const char* Path) const
+		{
+			const char* Name = Names + Entry.NameOffset;
+			Path = Internal::SkipArchivePathPrefix(Path);
+			for (uint32 Index = 0; Index < Entry.NameLength; ++Index, ++Path)
+			{
+				if (!*Path || Internal::NormalizeArchivePathChar(*Path) != Name[Index])
+				{
+					return false;
+				}
+			}
+			return *Path == 0;
+		}
+
+		FMappedFile File;
+		const FArchiveHeader* Header = nullptr;
+		const FArchiveEntry* Entries = nullptr;
+		const uint32* HashSlots = nullptr;
+		const char* Names = nullptr;
+	};
+
+	// Command line style front end for FArchiveWriter:
+	//	-out=<archive> [-root=<dir>] [-align=<bytes>] [-compress[=high]] <file|@listfile>...
+	// Inputs (and the lines of a list file) are paths relative to -root and are stored under that name.
+	// Returns 0 on success.
+	inline int32 RunArchiveBuilder(int32 ArgC, const char* const* ArgV)
+	{
+		std::string OutFilename;
+		std::string Root;
+		uint32 DataAlignment = 16;
+		EArchiveCompression Compression = EArchiveCompression::None;
+		std::vector<std::string> Inputs;
+		for (int32 Index = 0; Index < ArgC; ++Index)
+		{
+			const char* Arg = ArgV[Index];
+			if (!strncmp(Arg, "-out=", 5))
+			{
+				OutFilename = Arg + 5;
+			}
+			else if (!strncmp(Arg, "-root=", 6))
+			{
+				Root = Arg + 6;
+			}
+			else if (!strncmp(Arg, "-align=", 7))
+			{
+				DataAlignment = (uint32)atoi(Arg + 7);
+			}
+			else if (!strcmp(Arg, "-compress"))
+			{
+				Compression = EArchiveCompression::Fast;
+			}
+			else if (!strcmp(Arg, "-compress=high"))
+			{
+				Compression = EArchiveCompression::High;
+			}
+			else if (Arg[0] == '@')
+			{
+				bool bLoaded = false;
+				std::string List = LoadFileToString(Arg + 1, &bLoaded);
+				if (!bLoaded)
+				{
+					fprintf(stderr, "Unable to read list file '%s'\n", Arg + 1);
+					return 1;
+				}
+
+				size_t Start = 0;
+				while (Start < List.size())
+				{
+					size_t End = List.find_first_of("\r\n", Start);
+					End = End == std::string::npos ? List.size() : End;
+					if (End > Start)
+					{
+						Inputs.push_back(std::string(List.c_str() + Start, End - Start));
+					}
+					Start = End + 1;
+				}
+			}
+			else
+			{
+				Inputs.push_back(Arg);
+			}
+		}
+
+		if (OutFilename.empty() || Inputs.empty() || !IsPowerOfTwo(DataAlignment))
+		{
+			fprintf(stderr, "Usage: -out=<archive> [-root=<dir>] [-align=<bytes>] [-compress[=high]] <file|@listfile>...\n");
+			return 1;
+		}
+
+		FArchiveWriter Writer;
+		for (const auto& Input : Inputs)
+		{
+			Writer.AddFile(Input, MakePath(Root, Input), Compression);
+		}
+
+		if (!Writer.Write(OutFilename.c_str(), DataAlignment))
+		{
+			fprintf(stderr, "Failed to write archive '%s'\n", OutFilename.c_str());
+			return 1;
+		}
+
+		return 0;
 	}
 }
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "RCUtilsBase.h"
+
+namespace RCUtils
+{
+	namespace Internal
+	{
+		const uint64 XXH64Prime1 = 0x9E3779B185EBCA87ull;
+		const uint64 XXH64Prime2 = 0xC2B2AE3D27D4EB4Full;
+		const uint64 XXH64Prime3 = 0x165667B19E3779F9ull;
+		const uint64 XXH64Prime4 = 0x85EBCA77C2B2AE63ull;
+		const uint64 XXH64Prime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64 RotateLeft64(uint64 Value, uint32 Bits)
+		{
+			return (Value << Bits) | (Value >> (64 - Bits));
+		}
+
+		inline uint64 ReadU64(const uint8* Ptr)
+		{
+			uint64 Value;
+			memcpy(&Value, Ptr, sizeof(Value));
+			return Value;
+		}
+
+		inline uint32 ReadU32(const uint8* Ptr)
+		{
+			uint32 Value;
+			memcpy(&Value, Ptr, sizeof(Value));
+			return Value;
+		}
+
+		inline uint64 XXH64Round(uint64 Acc, uint64 Input)
+		{
+			Acc += Input * XXH64Prime2;
+			Acc = RotateLeft64(Acc, 31);
+			return Acc * XXH64Prime1;
+		}
+
+		inline uint64 XXH64MergeRound(uint64 Acc, uint64 Value)
+		{
+			Acc ^= XXH64Round(0, Value);
+			return Acc * XXH64Prime1 + XXH64Prime4;
+		}
+	}
+
+	// XXH64 (little endian); matches the reference implementation
+	inline uint64 Hash64(const void* Data, size_t Size, uint64 Seed = 0)
+	{
+		using namespace Internal;
+		const uint8* Ptr = (const uint8*)Data;
+		const uint8* End = Ptr + Size;
+		uint64 Hash;
+
+		if (Size >= 32)
+		{
+			uint64 V1 = Seed + XXH64Prime1 + XXH64Prime2;
+			uint64 V2 = Seed + XXH64Prime2;
+			uint64 V3 = Seed;
+			uint64 V4 = Seed - XXH64Prime1;
+			const uint8* Limit = End - 32;
+			do
+			{
+				V1 = XXH64Round(V1, ReadU64(Ptr));
+				V2 = XXH64Round(V2, ReadU64(Ptr + 8));
+				V3 = XXH64Round(V3, ReadU64(Ptr + 16));
+				V4 = XXH64Round(V4, ReadU64(Ptr + 24));
+				Ptr += 32;
+			}
+			while (Ptr <= Limit);
+
+			Hash = RotateLeft64(V1, 1) + RotateLeft64(V2, 7) + RotateLeft64(V3, 12) + RotateLeft64(V4, 18);
+			Hash = XXH64MergeRound(Hash, V1);
+			Hash = XXH64MergeRound(Hash, V2);
+			Hash = XXH64MergeRound(Hash, V3);
+			Hash = XXH64MergeRound(Hash, V4);
+		}
+		else
+		{
+			Hash = Seed + XXH64Prime5;
+		}
+
+		Hash += (uint64)Size;
+
+		while (Ptr + 8 <= End)
+		{
+			Hash ^= XXH64Round(0, ReadU64(Ptr));
+			Hash = RotateLeft64(Hash, 27) * XXH64Prime1 + XXH64Prime4;
+			Ptr += 8;
+		}
+
+		if (Ptr + 4 <= End)
+		{
+			Hash ^= (uint64)ReadU32(Ptr) * XXH64Prime1;
+			Hash = RotateLeft64(Hash, 23) * XXH64Prime2 + XXH64Prime3;
+			Ptr += 4;
+		}
+
+		while (Ptr < End)
+		{
+			Hash ^= (*Ptr) * XXH64Prime5;
+			Hash = RotateLeft64(Hash, 11) * XXH64Prime1;
+			++Ptr;
+		}
+
+		Hash ^= Hash >> 33;
+		Hash *= XXH64Prime2;
+		Hash ^= Hash >> 29;
+		Hash *= XXH64Prime3;
+		Hash ^= Hash >> 32;
+		return Hash;
+	}
+
+	// Cheap finalizer for integer keys (splitmix64)
+	inline uint64 HashMix64(uint64 Value)
+	{
+		Value ^= Value >> 30;
+		Value *= 0xBF58476D1CE4E5B9ull;
+		Value ^= Value >> 27;
+		Value *= 0x94D049BB133111EBull;
+		Value ^= Value >> 31;
+		return Value;
+	}
+}
@@ -2,7 +2,10 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <float.h>
 #include "RCUtilsBase.h"
+#include "RCUtilsBit.h"
+#include "RCUtilsFastMath.h"
 
 inline float ToRadians(float Deg)
 {
@@ -193,6 +196,13 @@ struct FVector3
 		float InvLen = (float)(1.0 / sqrt(Dot(*this, *this)));
 		return FVector3(x * InvLen, y * InvLen, z * InvLen);
 	}
+
+	// Single precision reciprocal square root estimate; relative error around 3e-7
+	FVector3 GetNormalizedFast() const
+	{
+		float InvLen = FastRsqrt(Dot(*this, *this));
+		return FVector3(x * InvLen, y * InvLen, z * InvLen);
+	}
 };
 
 inline FVector3 operator + (const FVector3& A, const FVector3& B)
@@ -306,6 +316,13 @@ struct FVector4
 		return FVector4(x * InvLen, y * InvLen, z * InvLen, w * InvLen);
 	}
 
+	// Single precision reciprocal square root estimate; relative error around 3e-7
+	FVector4 GetNormalizedFast() const
+	{
+		float InvLen = FastRsqrt(Dot(*this, *this));
+		return FVector4(x * InvLen, y * InvLen, z * InvLen, w * InvLen);
+	}
+
 	static float Dot(const FVector4& A, const FVector4& B)
 	{
 		return A.x * B.x + A.y * B.y + A.z * B.z + A.w * B.w;
@@ -376,20 +393,83 @@ struct FIntVector3
 
 	int GetMaxComponent()
 	{
-		return Max(x, Max(y, z));
+		return ::Max(x, ::Max(y, z));
 	}
 
 	int GetMinComponent()
 	{
-		return Min(x, Min(y, z));
+		return ::Min(x, ::Min(y, z));
+	}
+
+	FIntVector3& operator += (const FIntVector3& V)
+	{
+		x += V.x;
+		y += V.y;
+		z += V.z;
+		return *this;
+	}
+
+	FIntVector3& operator -= (const FIntVector3& V)
+	{
+		x -= V.x;
+		y -= V.y;
+		z -= V.z;
+		return *this;
+	}
+
+	static FIntVector3 Min(const FIntVector3& A, const FIntVector3& B)
+	{
+		return FIntVector3(::Min(A.x, B.x), ::Min(A.y, B.y), ::Min(A.z, B.z));
+	}
+
+	static FIntVector3 Max(const FIntVector3& A, const FIntVector3& B)
+	{
+		return FIntVector3(::Max(A.x, B.x), ::Max(A.y, B.y), ::Max(A.z, B.z));
+	}
+
+	// Cell containing P for a grid with cells of size 1 / InvCellSize
+	static FIntVector3 FloorToCell(const FVector3& P, float InvCellSize)
+	{
+		return FIntVector3((int32)floorf(P.x * InvCellSize), (int32)floorf(P.y * InvCellSize), (int32)floorf(P.z * InvCellSize));
+	}
+
+	// Multiplicative hash; the three large primes decorrelate neighbouring cells
+	uint32 GetHash() const
+	{
+		return ((uint32)x * 73856093u) ^ ((uint32)y * 19349663u) ^ ((uint32)z * 83492791u);
 	}
 };
 
+inline FIntVector3 operator + (const FIntVector3& A, const FIntVector3& B)
+{
+	return FIntVector3(A.x + B.x, A.y + B.y, A.z + B.z);
+}
+
 inline FIntVector3 operator - (const FIntVector3& A, const FIntVector3& B)
 {
 	return FIntVector3(A.x - B.x, A.y - B.y, A.z - B.z);
 }
 
+inline FIntVector3 operator * (const FIntVector3& A, const FIntVector3& B)
+{
+	return FIntVector3(A.x * B.x, A.y * B.y, A.z * B.z);
+}
+
+inline FIntVector3 operator * (const FIntVector3& A, int32 Scale)
+{
+	return FIntVector3(A.x * Scale, A.y * Scale, A.z * Scale);
+}
+
+inline bool operator == (const FIntVector3& A, const FIntVector3& B)
+{
+	return ((A.x ^ B.x) | (A.y ^ B.y) | (A.z ^ B.z)) == 0;
+}
+
+inline bool operator != (const FIntVector3& A, const FIntVector3& B)
+{
+	return !(A == B);
+}
+
 
 struct FIntVector4
 {
@@ -423,6 +503,55 @@ struct FIntVector4
 		z = InZ;
 		w = InW;
 	}
+
+	uint32 GetHash() const
+	{
+		return ((uint32)x * 73856093u) ^ ((uint32)y * 19349663u) ^ ((uint32)z * 83492791u) ^ ((uint32)w * 2654435761u);
+	}
+};
+
+inline FIntVector4 operator + (const FIntVector4& A, const FIntVector4& B)
+{
+	return FIntVector4(A.x + B.x, A.y + B.y, A.z + B.z, A.w + B.w);
+}
+
+inline FIntVector4 operator - (const FIntVector4& A, const FIntVector4& B)
+{
+	return FIntVector4(A.x - B.x, A.y - B.y, A.z - B.z, A.w - B.w);
+}
+
+inline FIntVector4 operator * (const FIntVector4& A, const FIntVector4& B)
+{
+	return FIntVector4(A.x * B.x, A.y * B.y, A.z * B.z, A.w * B.w);
+}
+
+inline FIntVector4 operator * (const FIntVector4& A, int32 Scale)
+{
+	return FIntVector4(A.x * Scale, A.y * Scale, A.z * Scale, A.w * Scale);
+}
+
+inline bool operator == (const FIntVector4& A, const FIntVector4& B)
+{
+	return ((A.x ^ B.x) | (A.y ^ B.y) | (A.z ^ B.z) | (A.w ^ B.w)) == 0;
+}
+
+inline bool operator != (const FIntVector4& A, const FIntVector4& B)
+{
+	return !(A == B);
+}
+
+// For std::unordered_map and friends
+struct FIntVectorHash
+{
+	size_t operator()(const FIntVector3& V) const
+	{
+		return V.GetHash();
+	}
+
+	size_t operator()(const FIntVector4& V) const
+	{
+		return V.GetHash();
+	}
 };
 
 struct FMatrix3x3
@@ -467,11 +596,21 @@ struct FMatrix3x3
 	}
 
 	static FMatrix3x3 GetRotationX(float AngleRad)
+	{
+		return GetRotationX((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix3x3 GetRotationXFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationX(Sin, Cos);
+	}
+
+	static FMatrix3x3 GetRotationX(float Sin, float Cos)
 	{
 		FMatrix3x3 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = 1;
 		New.Rows[1].y = Cos;
 		New.Rows[1].z = -Sin;
@@ -481,11 +620,21 @@ struct FMatrix3x3
 	}
 
 	static FMatrix3x3 GetRotationY(float AngleRad)
+	{
+		return GetRotationY((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix3x3 GetRotationYFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationY(Sin, Cos);
+	}
+
+	static FMatrix3x3 GetRotationY(float Sin, float Cos)
 	{
 		FMatrix3x3 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = Cos;
 		New.Rows[0].z = Sin;
 		New.Rows[1].y = 1;
@@ -495,11 +644,21 @@ struct FMatrix3x3
 	}
 
 	static FMatrix3x3 GetRotationZ(float AngleRad)
+	{
+		return GetRotationZ((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix3x3 GetRotationZFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationZ(Sin, Cos);
+	}
+
+	static FMatrix3x3 GetRotationZ(float Sin, float Cos)
 	{
 		FMatrix3x3 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = Cos;
 		New.Rows[0].y = -Sin;
 		New.Rows[1].x = Sin;
@@ -512,6 +671,68 @@ struct FMatrix3x3
 	{
 		Values[Row * 3 + Col] = Value;
 	}
+
+	FVector3 Col(int32 Index) const
+	{
+		return FVector3(Rows[0].Values[Index], Rows[1].Values[Index], Rows[2].Values[Index]);
+	}
+
+	FMatrix3x3& operator *=(const FMatrix3x3& M)
+	{
+		*this = Multiply(*this, M);
+		return *this;
+	}
+
+	// Row vectors like FMatrix4x4: transforming by the result applies M0 first
+	static FMatrix3x3 Multiply(const FMatrix3x3& M0, const FMatrix3x3& M1)
+	{
+		FMatrix3x3 M;
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			M.Rows[Row] = M1.Rows[0] * M0.Rows[Row].x + M1.Rows[1] * M0.Rows[Row].y + M1.Rows[2] * M0.Rows[Row].z;
+		}
+		return M;
+	}
+
+	float GetDeterminant() const
+	{
+		return FVector3::Dot(Rows[0], FVector3::Cross(Rows[1], Rows[2]));
+	}
+
+	// The columns of the inverse are the cross products of the rows over the determinant
+	static FMatrix3x3 GetInverse(const FMatrix3x3& M)
+	{
+		FVector3 BC = FVector3::Cross(M.Rows[1], M.Rows[2]);
+		FVector3 CA = FVector3::Cross(M.Rows[2], M.Rows[0]);
+		FVector3 AB = FVector3::Cross(M.Rows[0], M.Rows[1]);
+		float InvDet = 1.0f / FVector3::Dot(M.Rows[0], BC);
+
+		FMatrix3x3 Out;
+		Out.Rows[0] = FVector3(BC.x, CA.x, AB.x) * InvDet;
+		Out.Rows[1] = FVector3(BC.y, CA.y, AB.y) * InvDet;
+		Out.Rows[2] = FVector3(BC.z, CA.z, AB.z) * InvDet;
+		return Out;
+	}
+
+	// Exact inverse transpose, for transforming normals: GetInverse() with the transpose folded in. Non uniform
+	// scale still changes their length, so renormalize the transformed normals.
+	FMatrix3x3 GetNormalMatrix() const
+	{
+		FMatrix3x3 Out;
+		Out.Rows[0] = FVector3::Cross(Rows[1], Rows[2]);
+		Out.Rows[1] = FVector3::Cross(Rows[2], Rows[0]);
+		Out.Rows[2] = FVector3::Cross(Rows[0], Rows[1]);
+		float InvDet = 1.0f / FVector3::Dot(Rows[0], Out.Rows[0]);
+		Out.Rows[0] *= InvDet;
+		Out.Rows[1] *= InvDet;
+		Out.Rows[2] *= InvDet;
+		return Out;
+	}
+
+	FVector3 Transform(const FVector3& In) const
+	{
+		return Rows[0] * In.x + Rows[1] * In.y + Rows[2] * In.z;
+	}
 };
 
 struct FMatrix4x4
@@ -577,11 +798,21 @@ struct FMatrix4x4
 	}
 
 	static FMatrix4x4 GetRotationX(float AngleRad)
+	{
+		return GetRotationX((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix4x4 GetRotationXFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationX(Sin, Cos);
+	}
+
+	static FMatrix4x4 GetRotationX(float Sin, float Cos)
 	{
 		FMatrix4x4 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = 1;
 		New.Rows[1].y = Cos;
 		New.Rows[1].z = -Sin;
@@ -592,11 +823,21 @@ struct FMatrix4x4
 	}
 
 	static FMatrix4x4 GetRotationY(float AngleRad)
+	{
+		return GetRotationY((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix4x4 GetRotationYFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationY(Sin, Cos);
+	}
+
+	static FMatrix4x4 GetRotationY(float Sin, float Cos)
 	{
 		FMatrix4x4 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = Cos;
 		New.Rows[0].z = Sin;
 		New.Rows[1].y = 1;
@@ -607,11 +848,21 @@ struct FMatrix4x4
 	}
 
 	static FMatrix4x4 GetRotationZ(float AngleRad)
+	{
+		return GetRotationZ((float)sin(AngleRad), (float)cos(AngleRad));
+	}
+
+	static FMatrix4x4 GetRotationZFast(float AngleRad)
+	{
+		float Sin, Cos;
+		FastSinCos(AngleRad, Sin, Cos);
+		return GetRotationZ(Sin, Cos);
+	}
+
+	static FMatrix4x4 GetRotationZ(float Sin, float Cos)
 	{
 		FMatrix4x4 New;
 		MemZero(New);
-		float Cos = (float)cos(AngleRad);
-		float Sin = (float)sin(AngleRad);
 		New.Rows[0].x = Cos;
 		New.Rows[0].y = -Sin;
 		New.Rows[1].x = Sin;
@@ -666,10 +917,11 @@ struct FMatrix4x4
 
 	static FMatrix4x4 GetInverse(const FMatrix4x4& M)
 	{
-		FVector3 a = M.Rows[0].GetVector3();
-		FVector3 b = M.Rows[1].GetVector3();
-		FVector3 c = M.Rows[2].GetVector3();
-		FVector3 d = M.Rows[3].GetVector3();
+		// Lengyel's formulation: a..d are the upper three entries of the columns, x..w the bottom row
+		FVector3 a = M.Col(0).GetVector3();
+		FVector3 b = M.Col(1).GetVector3();
+		FVector3 c = M.Col(2).GetVector3();
+		FVector3 d = M.Col(3).GetVector3();
 
 		float x = M.Rows[3].x;
 		float y = M.Rows[3].y;
@@ -710,6 +962,249 @@ struct FMatrix4x4
 	}
 };
 
+// Affine transform without the constant (0, 0, 0, 1) column of FMatrix4x4: 48 instead of 64 bytes. Stored
+// transposed, so each row is one output coordinate ([Linear | Translation] in column vector terms) and a
+// point transform is three 4 wide dot products. Composition and conversion follow FMatrix4x4, i.e.
+// Multiply(A, B) applies A first and FromMatrix4x4/ToMatrix4x4 are exact.
+struct FMatrix3x4
+{
+	union
+	{
+		float Values[12];
+		FVector4 Rows[3];
+	};
+
+	FMatrix3x4() {}
+
+	FMatrix3x4(const FMatrix3x3& Linear, const FVector3& Translation)
+	{
+		Rows[0] = FVector4(Linear.Col(0), Translation.x);
+		Rows[1] = FVector4(Linear.Col(1), Translation.y);
+		Rows[2] = FVector4(Linear.Col(2), Translation.z);
+	}
+
+	static FMatrix3x4 GetIdentity()
+	{
+		FMatrix3x4 New;
+		MemZero(New);
+		New.Values[0] = 1;
+		New.Values[5] = 1;
+		New.Values[10] = 1;
+		return New;
+	}
+
+	// M must be affine (last column 0, 0, 0, 1)
+	static FMatrix3x4 FromMatrix4x4(const FMatrix4x4& M)
+	{
+		checkSlow(M.Values[3] == 0.0f && M.Values[7] == 0.0f && M.Values[11] == 0.0f && M.Values[15] == 1.0f);
+		FMatrix3x4 New;
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			New.Rows[Row] = M.Col(Row);
+		}
+		return New;
+	}
+
+	FMatrix4x4 ToMatrix4x4() const
+	{
+		FMatrix4x4 New;
+		for (int32 Row = 0; Row < 4; ++Row)
+		{
+			New.Rows[Row] = FVector4(Rows[0].Values[Row], Rows[1].Values[Row], Rows[2].Values[Row], Row == 3 ? 1.0f : 0.0f);
+		}
+		return New;
+	}
+
+	// Upper 3x3 in the row vector layout of FMatrix3x3/FMatrix4x4
+	FMatrix3x3 GetLinear() const
+	{
+		FMatrix3x3 New;
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			New.Rows[Row] = FVector3(Rows[0].Values[Row], Rows[1].Values[Row], Rows[2].Values[Row]);
+		}
+		return New;
+	}
+
+	FVector3 GetTranslation() const
+	{
+		return FVector3(Rows[0].w, Rows[1].w, Rows[2].w);
+	}
+
+	FMatrix3x3 GetNormalMatrix() const
+	{
+		return GetLinear().GetNormalMatrix();
+	}
+
+	FVector3 TransformPoint(const FVector3& P) const
+	{
+		return FVector3(
+			Rows[0].x * P.x + Rows[0].y * P.y + Rows[0].z * P.z + Rows[0].w,
+			Rows[1].x * P.x + Rows[1].y * P.y + Rows[1].z * P.z + Rows[1].w,
+			Rows[2].x * P.x + Rows[2].y * P.y + Rows[2].z * P.z + Rows[2].w);
+	}
+
+	FVector3 TransformDirection(const FVector3& D) const
+	{
+		return FVector3(
+			Rows[0].x * D.x + Rows[0].y * D.y + Rows[0].z * D.z,
+			Rows[1].x * D.x + Rows[1].y * D.y + Rows[1].z * D.z,
+			Rows[2].x * D.x + Rows[2].y * D.y + Rows[2].z * D.z);
+	}
+
+	FMatrix3x4& operator *=(const FMatrix3x4& M)
+	{
+		*this = Multiply(*this, M);
+		return *this;
+	}
+
+	// Each output row is a combination of A's rows weighted by one row of B, plus B's translation
+	static FMatrix3x4 Multiply(const FMatrix3x4& A, const FMatrix3x4& B)
+	{
+		FMatrix3x4 Out;
+#if RCUTILS_FAST_MATH_SSE
+		__m128 A0 = _mm_loadu_ps(A.Values);
+		__m128 A1 = _mm_loadu_ps(A.Values + 4);
+		__m128 A2 = _mm_loadu_ps(A.Values + 8);
+		const __m128 W = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			__m128 BRow = _mm_loadu_ps(B.Values + Row * 4);
+			__m128 Result = _mm_mul_ps(_mm_shuffle_ps(BRow, BRow, _MM_SHUFFLE(0, 0, 0, 0)), A0);
+			Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(BRow, BRow, _MM_SHUFFLE(1, 1, 1, 1)), A1));
+			Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(BRow, BRow, _MM_SHUFFLE(2, 2, 2, 2)), A2));
+			Result = _mm_add_ps(Result, _mm_mul_ps(_mm_shuffle_ps(BRow, BRow, _MM_SHUFFLE(3, 3, 3, 3)), W));
+			_mm_storeu_ps(Out.Values + Row * 4, Result);
+		}
+#else
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			const FVector4& BRow = B.Rows[Row];
+			Out.Rows[Row] = A.Rows[0] * BRow.x + A.Rows[1] * BRow.y + A.Rows[2] * BRow.z;
+			Out.Rows[Row].w += BRow.w;
+		}
+#endif
+		return Out;
+	}
+
+	// [L | t]^-1 = [L^-1 | -L^-1 t], with L^-1 from cross products; no 4x4 cofactors needed
+	static FMatrix3x4 GetInverse(const FMatrix3x4& M)
+	{
+		FVector3 A = M.Rows[0].GetVector3();
+		FVector3 B = M.Rows[1].GetVector3();
+		FVector3 C = M.Rows[2].GetVector3();
+		FVector3 BC = FVector3::Cross(B, C);
+		FVector3 CA = FVector3::Cross(C, A);
+		FVector3 AB = FVector3::Cross(A, B);
+		float InvDet = 1.0f / FVector3::Dot(A, BC);
+		BC *= InvDet;
+		CA *= InvDet;
+		AB *= InvDet;
+
+		FVector3 T = M.GetTranslation();
+		FMatrix3x4 Out;
+		Out.Rows[0] = FVector4(BC.x, CA.x, AB.x, -(BC.x * T.x + CA.x * T.y + AB.x * T.z));
+		Out.Rows[1] = FVector4(BC.y, CA.y, AB.y, -(BC.y * T.x + CA.y * T.y + AB.y * T.z));
+		Out.Rows[2] = FVector4(BC.z, CA.z, AB.z, -(BC.z * T.x + CA.z * T.y + AB.z * T.z));
+		return Out;
+	}
+
+	// Rotation + translation only: the inverse of the linear part is its transpose
+	static FMatrix3x4 GetInverseRigid(const FMatrix3x4& M)
+	{
+		FVector3 T = M.GetTranslation();
+		FMatrix3x4 Out;
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			FVector3 Axis(M.Rows[0].Values[Row], M.Rows[1].Values[Row], M.Rows[2].Values[Row]);
+			Out.Rows[Row] = FVector4(Axis, -FVector3::Dot(Axis, T));
+		}
+		return Out;
+	}
+
+	// Batch versions; Out may alias the inputs
+	static void Multiply(const FMatrix3x4* A, const FMatrix3x4* B, FMatrix3x4* Out, uint32 Num)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = Multiply(A[Index], B[Index]);
+		}
+	}
+
+	// Same B for every element, e.g. moving instances into a parent's or the camera's space
+	static void Multiply(const FMatrix3x4* A, const FMatrix3x4& B, FMatrix3x4* Out, uint32 Num)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = Multiply(A[Index], B);
+		}
+	}
+
+	static void GetInverse(const FMatrix3x4* In, FMatrix3x4* Out, uint32 Num)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = GetInverse(In[Index]);
+		}
+	}
+
+	static void FromMatrix4x4(const FMatrix4x4* In, FMatrix3x4* Out, uint32 Num)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = FromMatrix4x4(In[Index]);
+		}
+	}
+
+	static void ToMatrix4x4(const FMatrix3x4* In, FMatrix4x4* Out, uint32 Num)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = In[Index].ToMatrix4x4();
+		}
+	}
+
+	// Columns are splatted once, so each point costs three multiply-adds of 4 wide vectors
+	void TransformPoints(const FVector3* In, FVector3* Out, uint32 Num) const
+	{
+		RCUTILS_PROFILE_FUNCTION();
+#if RCUTILS_FAST_MATH_SSE
+		__m128 R0 = _mm_loadu_ps(Values);
+		__m128 R1 = _mm_loadu_ps(Values + 4);
+		__m128 R2 = _mm_loadu_ps(Values + 8);
+		__m128 R3 = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(R0, R1, R2, R3);
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			__m128 Result = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(In[Index].x), R0), R3);
+			Result = _mm_add_ps(Result, _mm_mul_ps(_mm_set1_ps(In[Index].y), R1));
+			Result = _mm_add_ps(Result, _mm_mul_ps(_mm_set1_ps(In[Index].z), R2));
+			_mm_storel_pi((__m64*)&Out[Index].x, Result);
+			_mm_store_ss(&Out[Index].z, _mm_movehl_ps(Result, Result));
+		}
+#else
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = TransformPoint(In[Index]);
+		}
+#endif
+	}
+
+	void TransformDirections(const FVector3* In, FVector3* Out, uint32 Num) const
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		for (uint32 Index = 0; Index < Num; ++Index)
+		{
+			Out[Index] = TransformDirection(In[Index]);
+		}
+	}
+};
+
 inline FMatrix4x4 CalculateProjectionMatrixLH(float FOVRadians, float Aspect, float NearZ, float FarZ)
 {
 	const float HalfTanFOV = (float)tan(FOVRadians / 2.0);
@@ -754,3 +1249,628 @@ inline uint32 GetNumMips(uint32 Width, uint32 Height)
 	}
 	return NumMips;
 }
+
+// Inclusive on both ends so a point on a shared edge belongs to both boxes
+struct FAABB
+{
+	FVector3 Min;
+	FVector3 Max;
+
+	FAABB() = default;
+
+	FAABB(const FVector3& InMin, const FVector3& InMax)
+		: Min(InMin)
+		, Max(InMax)
+	{
+	}
+
+	// Min > Max, so adding the first point makes it valid
+	static FAABB GetEmpty()
+	{
+		return FAABB(FVector3(FLT_MAX, FLT_MAX, FLT_MAX), FVector3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+	}
+
+	void Add(const FVector3& Point)
+	{
+		Min = FVector3::Min(Min, Point);
+		Max = FVector3::Max(Max, Point);
+	}
+
+	void Add(const FAABB& Box)
+	{
+		Min = FVector3::Min(Min, Box.Min);
+		Max = FVector3::Max(Max, Box.Max);
+	}
+
+	bool IsValid() const
+	{
+		return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+	}
+
+	FVector3 GetCenter() const
+	{
+		return (Min + Max) * 0.5f;
+	}
+
+	FVector3 GetExtent() const
+	{
+		return Max - Min;
+	}
+
+	float GetSurfaceArea() const
+	{
+		FVector3 Extent = GetExtent();
+		return 2.0f * (Extent.x * Extent.y + Extent.y * Extent.z + Extent.z * Extent.x);
+	}
+
+	bool Overlaps(const FAABB& Box) const
+	{
+		return Min.x <= Box.Max.x && Max.x >= Box.Min.x
+			&& Min.y <= Box.Max.y && Max.y >= Box.Min.y
+			&& Min.z <= Box.Max.z && Max.z >= Box.Min.z;
+	}
+};
+
+// Cell coordinates must be in [0, 2^21)
+inline uint64 MortonEncode3(const FIntVector3& Cell)
+{
+	return MortonEncode3((uint32)Cell.x, (uint32)Cell.y, (uint32)Cell.z);
+}
+
+inline FIntVector3 MortonDecode3(uint64 Code)
+{
+	uint32 X, Y, Z;
+	MortonDecode3(Code, X, Y, Z);
+	return FIntVector3((int32)X, (int32)Y, (int32)Z);
+}
+
+// Quantizes P to 21 bits per axis inside Bounds; sorting by the result gives a Z-order (spatially
+// coherent) layout
+inline uint64 GetMortonCode(const FVector3& P, const FAABB& Bounds)
+{
+	const float Scale = (float)((1 << 21) - 1);
+	FVector3 Extent = Bounds.GetExtent();
+	uint32 Quantized[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		float Normalized = Extent.Values[Axis] > 0.0f ? (P.Values[Axis] - Bounds.Min.Values[Axis]) / Extent.Values[Axis] : 0.0f;
+		Quantized[Axis] = (uint32)Min(Max(Normalized * Scale, 0.0f), Scale);
+	}
+	return MortonEncode3(Quantized[0], Quantized[1], Quantized[2]);
+}
+
+// Zero direction components are nudged to a tiny value before inverting, so slab tests never see
+// inf * 0 = NaN when the origin lies exactly on a slab plane
+inline float GetSafeReciprocal(float Value)
+{
+	const float Tiny = 1.0e-20f;
+	return 1.0f / (Abs(Value) > Tiny ? Value : (Value < 0.0f ? -Tiny : Tiny));
+}
+
+struct FRay
+{
+	FVector3 Origin;
+	FVector3 Direction;
+	FVector3 InvDirection;
+	float TMin;
+	float TMax;
+
+	FRay() = default;
+
+	FRay(const FVector3& InOrigin, const FVector3& InDirection, float InTMin = 0.0f, float InTMax = FLT_MAX)
+		: Origin(InOrigin)
+		, Direction(InDirection)
+		, InvDirection(GetSafeReciprocal(InDirection.x), GetSafeReciprocal(InDirection.y), GetSafeReciprocal(InDirection.z))
+		, TMin(InTMin)
+		, TMax(InTMax)
+	{
+	}
+};
+
+// Scale applied to the far slab distance so rounding can't reject a ray that grazes a box
+// (1 + 2 * gamma(3), Ize 2013 "Robust BVH Ray Traversal")
+const float RobustSlabScale = 1.0000003576f;
+
+// Möller-Trumbore. Barycentric bounds are inclusive, so a ray through a shared edge reports both triangles;
+// use IntersectRayTriangleWatertight where a hit must never be lost between neighbours.
+inline bool IntersectRayTriangle(const FRay& Ray, const FVector3& V0, const FVector3& V1, const FVector3& V2, float& OutT, float& OutU, float& OutV)
+{
+	FVector3 Edge1 = V1 - V0;
+	FVector3 Edge2 = V2 - V0;
+	FVector3 P = FVector3::Cross(Ray.Direction, Edge2);
+	float Det = FVector3::Dot(Edge1, P);
+	if (Det == 0.0f)
+	{
+		return false;
+	}
+
+	float InvDet = 1.0f / Det;
+	FVector3 S = Ray.Origin - V0;
+	float U = FVector3::Dot(S, P) * InvDet;
+	FVector3 Q = FVector3::Cross(S, Edge1);
+	float V = FVector3::Dot(Ray.Direction, Q) * InvDet;
+	float T = FVector3::Dot(Edge2, Q) * InvDet;
+	if (U < 0.0f || V < 0.0f || U + V > 1.0f || T < Ray.TMin || T > Ray.TMax)
+	{
+		return false;
+	}
+
+	OutT = T;
+	OutU = U;
+	OutV = V;
+	return true;
+}
+
+// Woop, Benthin, Wald 2013 "Watertight Ray/Triangle Intersection": edge functions are evaluated in a ray
+// aligned space with a double precision fallback on zero, so rays hitting an edge or vertex shared by
+// several triangles always hit at least one of them.
+inline bool IntersectRayTriangleWatertight(const FRay& Ray, const FVector3& V0, const FVector3& V1, const FVector3& V2, float& OutT, float& OutU, float& OutV)
+{
+	// Permute so the dominant direction axis becomes z
+	FVector3 AbsDir = FVector3::Abs(Ray.Direction);
+	int32 Kz = AbsDir.x > AbsDir.y ? (AbsDir.x > AbsDir.z ? 0 : 2) : (AbsDir.y > AbsDir.z ? 1 : 2);
+	int32 Kx = (Kz + 1) % 3;
+	int32 Ky = (Kx + 1) % 3;
+	if (Ray.Direction.Values[Kz] < 0.0f)
+	{
+		int32 Swap = Kx;
+		Kx = Ky;
+		Ky = Swap;
+	}
+
+	float Sz = 1.0f / Ray.Direction.Values[Kz];
+	float Sx = Ray.Direction.Values[Kx] * Sz;
+	float Sy = Ray.Direction.Values[Ky] * Sz;
+
+	FVector3 A = V0 - Ray.Origin;
+	FVector3 B = V1 - Ray.Origin;
+	FVector3 C = V2 - Ray.Origin;
+	float Ax = A.Values[Kx] - Sx * A.Values[Kz];
+	float Ay = A.Values[Ky] - Sy * A.Values[Kz];
+	float Bx = B.Values[Kx] - Sx * B.Values[Kz];
+	float By = B.Values[Ky] - Sy * B.Values[Kz];
+	float Cx = C.Values[Kx] - Sx * C.Values[Kz];
+	float Cy = C.Values[Ky] - Sy * C.Values[Kz];
+
+	float U = Cx * By - Cy * Bx;
+	float V = Ax * Cy - Ay * Cx;
+	float W = Bx * Ay - By * Ax;
+	if (U == 0.0f || V == 0.0f || W == 0.0f)
+	{
+		U = (float)((double)Cx * By - (double)Cy * Bx);
+		V = (float)((double)Ax * Cy - (double)Ay * Cx);
+		W = (float)((double)Bx * Ay - (double)By * Ax);
+	}
+
+	if ((U < 0.0f || V < 0.0f || W < 0.0f) && (U > 0.0f || V > 0.0f || W > 0.0f))
+	{
+		return false;
+	}
+
+	float Det = U + V + W;
+	if (Det == 0.0f)
+	{
+		return false;
+	}
+
+	float Az = Sz * A.Values[Kz];
+	float Bz = Sz * B.Values[Kz];
+	float Cz = Sz * C.Values[Kz];
+	float InvDet = 1.0f / Det;
+	float T = (U * Az + V * Bz + W * Cz) * InvDet;
+	if (T < Ray.TMin || T > Ray.TMax)
+	{
+		return false;
+	}
+
+	OutT = T;
+	OutU = V * InvDet;
+	OutV = W * InvDet;
+	return true;
+}
+
+// Returns the entry/exit distances clipped to [TMin, TMax]. Near/far planes are picked from the direction
+// sign rather than sorted, so an inverted (empty) box is always missed.
+inline bool IntersectRayAABB(const FRay& Ray, const FAABB& Box, float& OutTNear, float& OutTFar)
+{
+	float TNear = Ray.TMin;
+	float TFar = Ray.TMax;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		bool bPositive = Ray.InvDirection.Values[Axis] >= 0.0f;
+		float NearPlane = bPositive ? Box.Min.Values[Axis] : Box.Max.Values[Axis];
+		float FarPlane = bPositive ? Box.Max.Values[Axis] : Box.Min.Values[Axis];
+		TNear = Max(TNear, (NearPlane - Ray.Origin.Values[Axis]) * Ray.InvDirection.Values[Axis]);
+		TFar = Min(TFar, (FarPlane - Ray.Origin.Values[Axis]) * Ray.InvDirection.Values[Axis] * RobustSlabScale);
+	}
+
+	OutTNear = TNear;
+	OutTFar = TFar;
+	return TNear <= TFar;
+}
+
+// N rays in structure of arrays form. The lane loops below use masks and selects instead of branches and
+// store results unconditionally from locals, so they compile to straight SIMD (4 wide SSE, 8 wide AVX, 16 wide
+// AVX-512 with the matching /arch or -m flags; GCC only vectorizes them at -O3).
+template <uint32 N>
+struct TRayPacket
+{
+	alignas(sizeof(float) * N) float OriginX[N];
+	alignas(sizeof(float) * N) float OriginY[N];
+	alignas(sizeof(float) * N) float OriginZ[N];
+	alignas(sizeof(float) * N) float DirX[N];
+	alignas(sizeof(float) * N) float DirY[N];
+	alignas(sizeof(float) * N) float DirZ[N];
+	alignas(sizeof(float) * N) float InvDirX[N];
+	alignas(sizeof(float) * N) float InvDirY[N];
+	alignas(sizeof(float) * N) float InvDirZ[N];
+	alignas(sizeof(float) * N) float TMin[N];
+	alignas(sizeof(float) * N) float TMax[N];
+
+	enum
+	{
+		NumLanes = N,
+	};
+
+	void SetRay(uint32 Lane, const FRay& Ray)
+	{
+		check(Lane < N);
+		OriginX[Lane] = Ray.Origin.x;
+		OriginY[Lane] = Ray.Origin.y;
+		OriginZ[Lane] = Ray.Origin.z;
+		DirX[Lane] = Ray.Direction.x;
+		DirY[Lane] = Ray.Direction.y;
+		DirZ[Lane] = Ray.Direction.z;
+		InvDirX[Lane] = Ray.InvDirection.x;
+		InvDirY[Lane] = Ray.InvDirection.y;
+		InvDirZ[Lane] = Ray.InvDirection.z;
+		TMin[Lane] = Ray.TMin;
+		TMax[Lane] = Ray.TMax;
+	}
+
+	FRay GetRay(uint32 Lane) const
+	{
+		check(Lane < N);
+		return FRay(FVector3(OriginX[Lane], OriginY[Lane], OriginZ[Lane]), FVector3(DirX[Lane], DirY[Lane], DirZ[Lane]), TMin[Lane], TMax[Lane]);
+	}
+
+	// Marks a lane as inactive; it will never report hits
+	void DisableLane(uint32 Lane)
+	{
+		TMin[Lane] = FLT_MAX;
+		TMax[Lane] = -FLT_MAX;
+	}
+};
+
+typedef TRayPacket<4> FRayPacket4;
+typedef TRayPacket<8> FRayPacket8;
+typedef TRayPacket<16> FRayPacket16;
+
+// Closest hit per lane; T mirrors the packet's TMax once a hit is found
+template <uint32 N>
+struct THitPacket
+{
+	alignas(sizeof(float) * N) float T[N];
+	alignas(sizeof(float) * N) float U[N];
+	alignas(sizeof(float) * N) float V[N];
+	alignas(sizeof(float) * N) uint32 PrimitiveId[N];
+
+	enum : uint32
+	{
+		InvalidId = 0xffffffff,
+	};
+
+	void Reset()
+	{
+		for (uint32 Lane = 0; Lane < N; ++Lane)
+		{
+			T[Lane] = FLT_MAX;
+			U[Lane] = 0.0f;
+			V[Lane] = 0.0f;
+			PrimitiveId[Lane] = InvalidId;
+		}
+	}
+};
+
+// N triangles stored as a vertex plus two edges (what Möller-Trumbore consumes)
+template <uint32 N>
+struct TTriangleSoA
+{
+	alignas(sizeof(float) * N) float V0X[N];
+	alignas(sizeof(float) * N) float V0Y[N];
+	alignas(sizeof(float) * N) float V0Z[N];
+	alignas(sizeof(float) * N) float Edge1X[N];
+	alignas(sizeof(float) * N) float Edge1Y[N];
+	alignas(sizeof(float) * N) float Edge1Z[N];
+	alignas(sizeof(float) * N) float Edge2X[N];
+	alignas(sizeof(float) * N) float Edge2Y[N];
+	alignas(sizeof(float) * N) float Edge2Z[N];
+	alignas(sizeof(float) * N) uint32 PrimitiveId[N];
+
+	void SetTriangle(uint32 Lane, const FVector3& V0, const FVector3& V1, const FVector3& V2, uint32 InPrimitiveId)
+	{
+		check(Lane < N);
+		FVector3 Edge1 = V1 - V0;
+		FVector3 Edge2 = V2 - V0;
+		V0X[Lane] = V0.x;
+		V0Y[Lane] = V0.y;
+		V0Z[Lane] = V0.z;
+		Edge1X[Lane] = Edge1.x;
+		Edge1Y[Lane] = Edge1.y;
+		Edge1Z[Lane] = Edge1.z;
+		Edge2X[Lane] = Edge2.x;
+		Edge2Y[Lane] = Edge2.y;
+		Edge2Z[Lane] = Edge2.z;
+		PrimitiveId[Lane] = InPrimitiveId;
+	}
+
+	// Degenerate triangles never report hits, so unused lanes can be padded with this
+	void SetEmpty(uint32 Lane)
+	{
+		SetTriangle(Lane, FVector3::GetZero(), FVector3::GetZero(), FVector3::GetZero(), THitPacket<N>::InvalidId);
+	}
+};
+
+template <uint32 N>
+struct TAABBSoA
+{
+	alignas(sizeof(float) * N) float MinX[N];
+	alignas(sizeof(float) * N) float MinY[N];
+	alignas(sizeof(float) * N) float MinZ[N];
+	alignas(sizeof(float) * N) float MaxX[N];
+	alignas(sizeof(float) * N) float MaxY[N];
+	alignas(sizeof(float) * N) float MaxZ[N];
+
+	void SetBox(uint32 Lane, const FAABB& Box)
+	{
+		check(Lane < N);
+		MinX[Lane] = Box.Min.x;
+		MinY[Lane] = Box.Min.y;
+		MinZ[Lane] = Box.Min.z;
+		MaxX[Lane] = Box.Max.x;
+		MaxY[Lane] = Box.Max.y;
+		MaxZ[Lane] = Box.Max.z;
+	}
+
+	// Inverted box that no ray can hit
+	void SetEmpty(uint32 Lane)
+	{
+		SetBox(Lane, FAABB::GetEmpty());
+	}
+
+	FAABB GetBox(uint32 Lane) const
+	{
+		return FAABB(FVector3(MinX[Lane], MinY[Lane], MinZ[Lane]), FVector3(MaxX[Lane], MaxY[Lane], MaxZ[Lane]));
+	}
+};
+
+namespace RayInternal
+{
+	// All ones for true. Lane loops combine these with & and pick results with LaneSelect: a && chain or a
+	// ternary around float math is a branch per lane to the compiler, which keeps the loop scalar.
+	inline uint32 LaneMask(bool bValue)
+	{
+		return 0u - (uint32)bValue;
+	}
+
+	inline float LaneSelect(uint32 Mask, float A, float B)
+	{
+		return FastMathInternal::BitsToFloat((FastMathInternal::FloatToBits(A) & Mask) | (FastMathInternal::FloatToBits(B) & ~Mask));
+	}
+
+	inline uint32 LaneSelect(uint32 Mask, uint32 A, uint32 B)
+	{
+		return (A & Mask) | (B & ~Mask);
+	}
+}
+
+template <uint32 N>
+inline uint32 GetLaneMask(const uint32 (&Hits)[N])
+{
+	uint32 Mask = 0;
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		Mask |= (Hits[Lane] & 1) << Lane;
+	}
+	return Mask;
+}
+
+// One triangle against N rays; updates TMax/hits of the lanes that found a closer hit and returns their mask.
+// The test runs on local copies and the results are stored unconditionally in a second pass: the packet and
+// hit arrays may alias as far as the compiler knows, which would keep a single fused loop scalar.
+template <uint32 N>
+inline uint32 IntersectRayPacketTriangle(TRayPacket<N>& Packet, THitPacket<N>& Hits, const FVector3& V0, const FVector3& V1, const FVector3& V2, uint32 PrimitiveId)
+{
+	using namespace RayInternal;
+	FVector3 Edge1 = V1 - V0;
+	FVector3 Edge2 = V2 - V0;
+	uint32 HitLanes[N];
+	float LaneT[N];
+	float LaneU[N];
+	float LaneV[N];
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		float Px = Packet.DirY[Lane] * Edge2.z - Packet.DirZ[Lane] * Edge2.y;
+		float Py = Packet.DirZ[Lane] * Edge2.x - Packet.DirX[Lane] * Edge2.z;
+		float Pz = Packet.DirX[Lane] * Edge2.y - Packet.DirY[Lane] * Edge2.x;
+		float Det = Edge1.x * Px + Edge1.y * Py + Edge1.z * Pz;
+		float InvDet = 1.0f / Det;
+		float Sx = Packet.OriginX[Lane] - V0.x;
+		float Sy = Packet.OriginY[Lane] - V0.y;
+		float Sz = Packet.OriginZ[Lane] - V0.z;
+		float U = (Sx * Px + Sy * Py + Sz * Pz) * InvDet;
+		float Qx = Sy * Edge1.z - Sz * Edge1.y;
+		float Qy = Sz * Edge1.x - Sx * Edge1.z;
+		float Qz = Sx * Edge1.y - Sy * Edge1.x;
+		float V = (Packet.DirX[Lane] * Qx + Packet.DirY[Lane] * Qy + Packet.DirZ[Lane] * Qz) * InvDet;
+		float T = (Edge2.x * Qx + Edge2.y * Qy + Edge2.z * Qz) * InvDet;
+
+		// NaN/inf from a zero determinant fail every comparison below
+		HitLanes[Lane] = LaneMask(Det != 0.0f) & LaneMask(U >= 0.0f) & LaneMask(V >= 0.0f) & LaneMask(U + V <= 1.0f)
+			& LaneMask(T >= Packet.TMin[Lane]) & LaneMask(T <= Packet.TMax[Lane]);
+		LaneT[Lane] = T;
+		LaneU[Lane] = U;
+		LaneV[Lane] = V;
+	}
+
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		Packet.TMax[Lane] = LaneSelect(HitLanes[Lane], LaneT[Lane], Packet.TMax[Lane]);
+	}
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		Hits.T[Lane] = LaneSelect(HitLanes[Lane], LaneT[Lane], Hits.T[Lane]);
+		Hits.U[Lane] = LaneSelect(HitLanes[Lane], LaneU[Lane], Hits.U[Lane]);
+		Hits.V[Lane] = LaneSelect(HitLanes[Lane], LaneV[Lane], Hits.V[Lane]);
+		Hits.PrimitiveId[Lane] = LaneSelect(HitLanes[Lane], PrimitiveId, Hits.PrimitiveId[Lane]);
+	}
+	return GetLaneMask(HitLanes);
+}
+
+// One ray against N triangles; returns the lane of the closest hit (and shortens Ray.TMax) or -1
+template <uint32 N>
+inline int32 IntersectRayTriangles(FRay& Ray, const TTriangleSoA<N>& Triangles, float& OutU, float& OutV)
+{
+	using namespace RayInternal;
+	float LaneT[N];
+	float LaneU[N];
+	float LaneV[N];
+	const FVector3 Origin = Ray.Origin;
+	const FVector3 Direction = Ray.Direction;
+	const float TMin = Ray.TMin;
+	const float TMax = Ray.TMax;
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		float Px = Direction.y * Triangles.Edge2Z[Lane] - Direction.z * Triangles.Edge2Y[Lane];
+		float Py = Direction.z * Triangles.Edge2X[Lane] - Direction.x * Triangles.Edge2Z[Lane];
+		float Pz = Direction.x * Triangles.Edge2Y[Lane] - Direction.y * Triangles.Edge2X[Lane];
+		float Det = Triangles.Edge1X[Lane] * Px + Triangles.Edge1Y[Lane] * Py + Triangles.Edge1Z[Lane] * Pz;
+		float InvDet = 1.0f / Det;
+		float Sx = Origin.x - Triangles.V0X[Lane];
+		float Sy = Origin.y - Triangles.V0Y[Lane];
+		float Sz = Origin.z - Triangles.V0Z[Lane];
+		float U = (Sx * Px + Sy * Py + Sz * Pz) * InvDet;
+		float Qx = Sy * Triangles.Edge1Z[Lane] - Sz * Triangles.Edge1Y[Lane];
+		float Qy = Sz * Triangles.Edge1X[Lane] - Sx * Triangles.Edge1Z[Lane];
+		float Qz = Sx * Triangles.Edge1Y[Lane] - Sy * Triangles.Edge1X[Lane];
+		float V = (Direction.x * Qx + Direction.y * Qy + Direction.z * Qz) * InvDet;
+		float T = (Triangles.Edge2X[Lane] * Qx + Triangles.Edge2Y[Lane] * Qy + Triangles.Edge2Z[Lane] * Qz) * InvDet;
+
+		uint32 bHit = LaneMask(Det != 0.0f) & LaneMask(U >= 0.0f) & LaneMask(V >= 0.0f) & LaneMask(U + V <= 1.0f)
+			& LaneMask(T >= TMin) & LaneMask(T <= TMax);
+		LaneT[Lane] = LaneSelect(bHit, T, FLT_MAX);
+		LaneU[Lane] = U;
+		LaneV[Lane] = V;
+	}
+
+	int32 Closest = -1;
+	float ClosestT = FLT_MAX;
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		if (LaneT[Lane] < ClosestT)
+		{
+			ClosestT = LaneT[Lane];
+			Closest = (int32)Lane;
+		}
+	}
+
+	if (Closest >= 0)
+	{
+		Ray.TMax = ClosestT;
+		OutU = LaneU[Closest];
+		OutV = LaneV[Closest];
+	}
+	return Closest;
+}
+
+// One ray against N boxes (eg the children of a wide BVH node); returns the hit mask and entry distances
+template <uint32 N>
+inline uint32 IntersectRayAABBs(const FRay& Ray, const TAABBSoA<N>& Boxes, float (&OutTNear)[N])
+{
+	using namespace RayInternal;
+
+	// The ray is shared by all lanes, so the near/far plane choice is made once
+	const float* NearX = Ray.InvDirection.x >= 0.0f ? Boxes.MinX : Boxes.MaxX;
+	const float* FarX = Ray.InvDirection.x >= 0.0f ? Boxes.MaxX : Boxes.MinX;
+	const float* NearY = Ray.InvDirection.y >= 0.0f ? Boxes.MinY : Boxes.MaxY;
+	const float* FarY = Ray.InvDirection.y >= 0.0f ? Boxes.MaxY : Boxes.MinY;
+	const float* NearZ = Ray.InvDirection.z >= 0.0f ? Boxes.MinZ : Boxes.MaxZ;
+	const float* FarZ = Ray.InvDirection.z >= 0.0f ? Boxes.MaxZ : Boxes.MinZ;
+	const FVector3 Origin = Ray.Origin;
+	const FVector3 InvDirection = Ray.InvDirection;
+	const float TMin = Ray.TMin;
+	const float TMax = Ray.TMax;
+
+	// Computed into locals and copied out, since OutTNear could alias the boxes as far as the compiler knows
+	uint32 HitLanes[N];
+	float LaneTNear[N];
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		float TNearX = (NearX[Lane] - Origin.x) * InvDirection.x;
+		float TNearY = (NearY[Lane] - Origin.y) * InvDirection.y;
+		float TNearZ = (NearZ[Lane] - Origin.z) * InvDirection.z;
+		float TFarX = (FarX[Lane] - Origin.x) * InvDirection.x;
+		float TFarY = (FarY[Lane] - Origin.y) * InvDirection.y;
+		float TFarZ = (FarZ[Lane] - Origin.z) * InvDirection.z;
+		float TNear = Max(Max(TNearX, TNearY), Max(TNearZ, TMin));
+		float TFar = Min(Min(TFarX, TFarY), TFarZ) * RobustSlabScale;
+		TFar = Min(TFar, TMax);
+		HitLanes[Lane] = LaneMask(TNear <= TFar);
+		LaneTNear[Lane] = TNear;
+	}
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		OutTNear[Lane] = LaneTNear[Lane];
+	}
+	return GetLaneMask(HitLanes);
+}
+
+// One box against N rays
+template <uint32 N>
+inline uint32 IntersectRayPacketAABB(const TRayPacket<N>& Packet, const FAABB& Box, float (&OutTNear)[N])
+{
+	using namespace RayInternal;
+	const FAABB LocalBox = Box;
+	uint32 HitLanes[N];
+	float LaneTNear[N];
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		uint32 bPositiveX = LaneMask(Packet.InvDirX[Lane] >= 0.0f);
+		uint32 bPositiveY = LaneMask(Packet.InvDirY[Lane] >= 0.0f);
+		uint32 bPositiveZ = LaneMask(Packet.InvDirZ[Lane] >= 0.0f);
+		float NearX = LaneSelect(bPositiveX, LocalBox.Min.x, LocalBox.Max.x);
+		float FarX = LaneSelect(bPositiveX, LocalBox.Max.x, LocalBox.Min.x);
+		float NearY = LaneSelect(bPositiveY, LocalBox.Min.y, LocalBox.Max.y);
+		float FarY = LaneSelect(bPositiveY, LocalBox.Max.y, LocalBox.Min.y);
+		float NearZ = LaneSelect(bPositiveZ, LocalBox.Min.z, LocalBox.Max.z);
+		float FarZ = LaneSelect(bPositiveZ, LocalBox.Max.z, LocalBox.Min.z);
+		float TNearX = (NearX - Packet.OriginX[Lane]) * Packet.InvDirX[Lane];
+		float TNearY = (NearY - Packet.OriginY[Lane]) * Packet.InvDirY[Lane];
+		float TNearZ = (NearZ - Packet.OriginZ[Lane]) * Packet.InvDirZ[Lane];
+		float TFarX = (FarX - Packet.OriginX[Lane]) * Packet.InvDirX[Lane];
+		float TFarY = (FarY - Packet.OriginY[Lane]) * Packet.InvDirY[Lane];
+		float TFarZ = (FarZ - Packet.OriginZ[Lane]) * Packet.InvDirZ[Lane];
+		float TNear = Max(Max(TNearX, TNearY), Max(TNearZ, Packet.TMin[Lane]));
+		float TFar = Min(Min(TFarX, TFarY), TFarZ) * RobustSlabScale;
+		TFar = Min(TFar, Packet.TMax[Lane]);
+		HitLanes[Lane] = LaneMask(TNear <= TFar);
+		LaneTNear[Lane] = TNear;
+	}
+	for (uint32 Lane = 0; Lane < N; ++Lane)
+	{
+		OutTNear[Lane] = LaneTNear[Lane];
+	}
+	return GetLaneMask(HitLanes);
+}
+
+// Brute force closest hit of a packet against an indexed triangle list
+template <uint32 N>
+inline void IntersectRayPacketTriangles(TRayPacket<N>& Packet, THitPacket<N>& Hits, const FVector3* Vertices, const uint32* Indices, uint32 NumTriangles)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	for (uint32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+	{
+		const uint32* Tri = Indices + Triangle * 3;
+		IntersectRayPacketTriangle(Packet, Hits, Vertices[Tri[0]], Vertices[Tri[1]], Vertices[Tri[2]], Triangle);
+	}
+}
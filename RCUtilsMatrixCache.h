@@ -0,0 +1,331 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsThread.h"
+#include <atomic>
+
+// Matrices that remember what has been derived from them. Every construction and Set() takes a new version
+// from one global counter; derived matrices (inverse, inverse transpose, products of two cached matrices)
+// store the input versions they were built from and are only recomputed when one of those changed, so per
+// frame queries on static transforms are a compare and a load. Since no two writes share a version, a version
+// names the contents: copies keep it along with their derived data, and assigning another matrix to an input
+// of a product is seen as a change like Set().
+//
+// Derived data is filled in lazily by const getters, so a cache must not be queried from several threads
+// at once while it is stale. Run UpdateDerivedMatrices/UpdateMatrixProducts first; after that the getters
+// only read the matrices. They still count hits, with relaxed atomic increments, so a matrix shared by
+// many threads bounces that counter between cores; Get() on the product or the matrix counts nothing.
+
+namespace MatrixCacheInternal
+{
+	// Starts at 1, so 0 can mean "never seen"; relaxed since only uniqueness matters
+	inline uint64 NextVersion()
+	{
+		static std::atomic<uint64> Counter{1};
+		return Counter.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Copies by value so cached matrices stay copyable
+	struct FCounter
+	{
+		FCounter() = default;
+
+		FCounter(const FCounter& Other)
+			: Value(Other.Load())
+		{
+		}
+
+		FCounter& operator=(const FCounter& Other)
+		{
+			Value.store(Other.Load(), std::memory_order_relaxed);
+			return *this;
+		}
+
+		void Add(uint64 Num)
+		{
+			Value.fetch_add(Num, std::memory_order_relaxed);
+		}
+
+		uint64 Load() const
+		{
+			return Value.load(std::memory_order_relaxed);
+		}
+
+		void Reset()
+		{
+			Value.store(0, std::memory_order_relaxed);
+		}
+
+		std::atomic<uint64> Value{0};
+	};
+}
+
+// Every derived query through a getter either hits or recomputes
+struct FMatrixCacheStats
+{
+	uint64 NumHits = 0;
+	uint64 NumRecomputes = 0;
+
+	FMatrixCacheStats& operator+=(const FMatrixCacheStats& Other)
+	{
+		NumHits += Other.NumHits;
+		NumRecomputes += Other.NumRecomputes;
+		return *this;
+	}
+
+	void Reset()
+	{
+		NumHits = 0;
+		NumRecomputes = 0;
+	}
+};
+
+class FCachedMatrix
+{
+public:
+	FCachedMatrix()
+		: Version(MatrixCacheInternal::NextVersion())
+		, Matrix(FMatrix4x4::GetIdentity())
+	{
+	}
+
+	explicit FCachedMatrix(const FMatrix4x4& InMatrix)
+		: Version(MatrixCacheInternal::NextVersion())
+		, Matrix(InMatrix)
+	{
+	}
+
+	// Always invalidates; callers that often write an unchanged matrix should compare first
+	void Set(const FMatrix4x4& InMatrix)
+	{
+		Matrix = InMatrix;
+		Version = MatrixCacheInternal::NextVersion();
+	}
+
+	const FMatrix4x4& Get() const
+	{
+		return Matrix;
+	}
+
+	// Never 0, so 0 can mean "never seen" for whoever tracks it. Equal versions mean equal contents.
+	uint64 GetVersion() const
+	{
+		return Version;
+	}
+
+	bool IsDerivedDirty() const
+	{
+		return DerivedVersion != Version;
+	}
+
+	const FMatrix4x4& GetInverse() const
+	{
+		UpdateDerived();
+		return Inverse;
+	}
+
+	// Transforms normals (as row vectors, like points) under non uniform scale; not normalized
+	const FMatrix4x4& GetInverseTranspose() const
+	{
+		UpdateDerived();
+		return InverseTranspose;
+	}
+
+	// Returns true if anything was recomputed. Bulk passes don't count hits, which keeps clean entries read only.
+	bool UpdateDerived(bool bCountHit = true) const
+	{
+		if (DerivedVersion == Version)
+		{
+			if (bCountHit)
+			{
+				NumHits.Add(1);
+			}
+			return false;
+		}
+
+		// Affine matrices (the usual model and view transforms) skip the 4x4 cofactors
+		if (Matrix.Values[3] == 0.0f && Matrix.Values[7] == 0.0f && Matrix.Values[11] == 0.0f && Matrix.Values[15] == 1.0f)
+		{
+			Inverse = FMatrix3x4::GetInverse(FMatrix3x4::FromMatrix4x4(Matrix)).ToMatrix4x4();
+		}
+		else
+		{
+			Inverse = FMatrix4x4::GetInverse(Matrix);
+		}
+		InverseTranspose = Inverse.GetTranspose();
+		DerivedVersion = Version;
+		NumRecomputes.Add(1);
+		return true;
+	}
+
+	FMatrixCacheStats GetStats() const
+	{
+		FMatrixCacheStats Stats;
+		Stats.NumHits = NumHits.Load();
+		Stats.NumRecomputes = NumRecomputes.Load();
+		return Stats;
+	}
+
+	void ResetStats()
+	{
+		NumHits.Reset();
+		NumRecomputes.Reset();
+	}
+
+protected:
+	// Versions and counters first, so checking a clean entry touches one cache line
+	uint64 Version;
+	mutable uint64 DerivedVersion = 0;
+	mutable MatrixCacheInternal::FCounter NumHits;
+	mutable MatrixCacheInternal::FCounter NumRecomputes;
+
+	FMatrix4x4 Matrix;
+	mutable FMatrix4x4 Inverse;
+	mutable FMatrix4x4 InverseTranspose;
+};
+
+// FMatrix4x4::Multiply(First, Second), i.e. First applied first (view * projection, model * view projection).
+// The result is itself a cached matrix whose version only moves when an input changed, so its inverse is
+// cached too and products can be chained: build a model-view-projection from a model matrix and
+// GetCached() of a view-projection product, updating the view-projection before the per object products.
+// Inputs are referenced, not copied, and must outlive the product.
+class FCachedMatrixProduct
+{
+public:
+	FCachedMatrixProduct(const FCachedMatrix& InFirst, const FCachedMatrix& InSecond)
+		: First(&InFirst)
+		, Second(&InSecond)
+	{
+	}
+
+	bool IsDirty() const
+	{
+		return FirstVersion != First->GetVersion() || SecondVersion != Second->GetVersion();
+	}
+
+	// Returns true if the product was recomputed; bWithDerived also brings its inverse up to date
+	bool Update(bool bWithDerived = false, bool bCountHit = true) const
+	{
+		uint64 NewFirstVersion = First->GetVersion();
+		uint64 NewSecondVersion = Second->GetVersion();
+		bool bRecomputed = FirstVersion != NewFirstVersion || SecondVersion != NewSecondVersion;
+		if (bRecomputed)
+		{
+			Result.Set(FMatrix4x4::Multiply(First->Get(), Second->Get()));
+			FirstVersion = NewFirstVersion;
+			SecondVersion = NewSecondVersion;
+			NumRecomputes.Add(1);
+		}
+		else if (bCountHit)
+		{
+			NumHits.Add(1);
+		}
+
+		if (bWithDerived)
+		{
+			Result.UpdateDerived(bCountHit);
+		}
+		return bRecomputed;
+	}
+
+	const FCachedMatrix& GetCached() const
+	{
+		Update();
+		return Result;
+	}
+
+	const FMatrix4x4& Get() const
+	{
+		return GetCached().Get();
+	}
+
+	const FMatrix4x4& GetInverse() const
+	{
+		return GetCached().GetInverse();
+	}
+
+	const FMatrix4x4& GetInverseTranspose() const
+	{
+		return GetCached().GetInverseTranspose();
+	}
+
+	// Product hits and recomputes; the inverse of the product is counted in GetCached().GetStats()
+	FMatrixCacheStats GetStats() const
+	{
+		FMatrixCacheStats Stats;
+		Stats.NumHits = NumHits.Load();
+		Stats.NumRecomputes = NumRecomputes.Load();
+		return Stats;
+	}
+
+	void ResetStats()
+	{
+		NumHits.Reset();
+		NumRecomputes.Reset();
+		Result.ResetStats();
+	}
+
+protected:
+	const FCachedMatrix* First;
+	const FCachedMatrix* Second;
+	mutable uint64 FirstVersion = 0;
+	mutable uint64 SecondVersion = 0;
+	mutable MatrixCacheInternal::FCounter NumHits;
+	mutable MatrixCacheInternal::FCounter NumRecomputes;
+	mutable FCachedMatrix Result;
+};
+
+namespace MatrixCacheInternal
+{
+	// Clean entries cost a version compare, so chunks are large enough to hide the task overhead when most are
+	template <typename TFunc>
+	inline uint32 ForEachChunk(uint32 Num, uint32 NumThreads, const TFunc& Func)
+	{
+		const uint32 ChunkSize = 1024;
+		std::atomic<uint32> NumRecomputed{0};
+		RCUtils::ParallelFor((Num + ChunkSize - 1) / ChunkSize, [&](uint32 Chunk)
+		{
+			uint32 End = Min(Num, (Chunk + 1) * ChunkSize);
+			uint32 ChunkRecomputed = 0;
+			for (uint32 Index = Chunk * ChunkSize; Index < End; ++Index)
+			{
+				ChunkRecomputed += Func(Index) ? 1 : 0;
+			}
+			NumRecomputed.fetch_add(ChunkRecomputed, std::memory_order_relaxed);
+		}, NumThreads);
+		return NumRecomputed.load();
+	}
+}
+
+// Recomputes the inverse and inverse transpose of the dirty entries only and returns how many there were. Bulk
+// passes count recomputes in the entries' stats but not hits (Num minus the result), so clean entries are
+// only read.
+inline uint32 UpdateDerivedMatrices(const FCachedMatrix* Matrices, uint32 Num, uint32 NumThreads = 0)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	return MatrixCacheInternal::ForEachChunk(Num, NumThreads, [&](uint32 Index)
+	{
+		return Matrices[Index].UpdateDerived(false);
+	});
+}
+
+// Recomputes the products whose inputs changed, plus their derived matrices if bWithDerived; returns how many
+// products were recomputed. Products that use other products' results as inputs need those updated first.
+inline uint32 UpdateMatrixProducts(const FCachedMatrixProduct* Products, uint32 Num, bool bWithDerived = false, uint32 NumThreads = 0)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	return MatrixCacheInternal::ForEachChunk(Num, NumThreads, [&](uint32 Index)
+	{
+		return Products[Index].Update(bWithDerived, false);
+	});
+}
+
+inline FMatrixCacheStats GetMatrixCacheStats(const FCachedMatrix* Matrices, uint32 Num)
+{
+	FMatrixCacheStats Total;
+	for (uint32 Index = 0; Index < Num; ++Index)
+	{
+		Total += Matrices[Index].GetStats();
+	}
+	return Total;
+}
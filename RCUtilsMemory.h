@@ -0,0 +1,408 @@
+#pragma once
+
+#include "RCUtilsBase.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+
+// Opt-in allocation tracking. When RCUTILS_ENABLE_MEMORY_TRACKING is 0 TTaggedAllocator is plain
+// std::allocator and TaggedAlloc/TaggedFree are operator new/delete, so nothing is recorded.
+//
+// Each thread bumps its own counters, including the peak of its own live bytes, and
+// FMemoryTracker::TakeSnapshot() merges them on demand, so the allocation path never writes shared memory.
+// The merged peak of an interval between snapshots is the sum of the threads' peaks: exact when at most one
+// thread's usage moved in that interval, an upper bound otherwise (the peaks may not have coincided), so it
+// is only as precise as the snapshot cadence. Call TakeSnapshot at a steady cadence (eg once per frame):
+//
+//	void EndFrame()
+//	{
+//		RCUtils::FMemoryStats Stats = RCUtils::FMemoryTracker::Get().TakeSnapshot();
+//		RCUtils::PrintMemoryReport(Stats);
+//	}
+#ifndef RCUTILS_ENABLE_MEMORY_TRACKING
+#define RCUTILS_ENABLE_MEMORY_TRACKING 0
+#endif
+
+namespace RCUtils
+{
+	enum class EMemoryTag : uint8
+	{
+		General,
+		File,
+		String,
+		Math,
+		Containers,
+
+		Count
+	};
+
+	inline const char* GetMemoryTagName(EMemoryTag Tag)
+	{
+		switch (Tag)
+		{
+		case EMemoryTag::General:		return "General";
+		case EMemoryTag::File:			return "File";
+		case EMemoryTag::String:		return "String";
+		case EMemoryTag::Math:			return "Math";
+		case EMemoryTag::Containers:	return "Containers";
+		default:						return "Unknown";
+		}
+	}
+
+	struct FMemoryTagStats
+	{
+		int64 LiveBytes = 0;
+		int64 PeakBytes = 0;
+		int64 LiveAllocs = 0;
+		uint64 NumAllocs = 0;
+		uint64 NumFrees = 0;
+		uint64 TotalAllocatedBytes = 0;
+	};
+
+	struct FMemoryStats
+	{
+		FMemoryTagStats Tags[(uint32)EMemoryTag::Count];
+
+		const FMemoryTagStats& operator[](EMemoryTag Tag) const
+		{
+			return Tags[(uint32)Tag];
+		}
+	};
+
+	// Only the owning thread writes; relaxed load + store keeps the hot path free of locked instructions
+	struct FThreadMemoryCounters
+	{
+		struct FCounters
+		{
+			std::atomic<uint64> AllocatedBytes{0};
+			std::atomic<uint64> FreedBytes{0};
+			std::atomic<uint64> NumAllocs{0};
+			std::atomic<uint64> NumFrees{0};
+
+			// Highest live bytes (allocated minus freed by this thread) since snapshot interval PeakEpoch began
+			std::atomic<int64> PeakLiveBytes{0};
+			std::atomic<uint64> PeakEpoch{0};
+
+			int64 GetLiveBytes() const
+			{
+				return (int64)(AllocatedBytes.load(std::memory_order_relaxed) - FreedBytes.load(std::memory_order_relaxed));
+			}
+		};
+
+		static void Bump(std::atomic<uint64>& Counter, uint64 Amount)
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+		}
+
+		// The first update in a new interval restarts the peak; the epoch is published after the peak so a
+		// snapshot that sees the new epoch also sees its peak
+		static void RaisePeak(FCounters& Counter, uint64 Epoch, int64 LiveBytes)
+		{
+			if (Counter.PeakEpoch.load(std::memory_order_relaxed) != Epoch)
+			{
+				Counter.PeakLiveBytes.store(LiveBytes, std::memory_order_relaxed);
+				Counter.PeakEpoch.store(Epoch, std::memory_order_release);
+			}
+			else if (LiveBytes > Counter.PeakLiveBytes.load(std::memory_order_relaxed))
+			{
+				Counter.PeakLiveBytes.store(LiveBytes, std::memory_order_relaxed);
+			}
+		}
+
+		void OnAlloc(EMemoryTag Tag, size_t Size, uint64 Epoch)
+		{
+			FCounters& Counter = Tags[(uint32)Tag];
+			Bump(Counter.AllocatedBytes, Size);
+			Bump(Counter.NumAllocs, 1);
+			RaisePeak(Counter, Epoch, Counter.GetLiveBytes());
+		}
+
+		// The live bytes before the free count towards the interval that it opens
+		void OnFree(EMemoryTag Tag, size_t Size, uint64 Epoch)
+		{
+			FCounters& Counter = Tags[(uint32)Tag];
+			RaisePeak(Counter, Epoch, Counter.GetLiveBytes());
+			Bump(Counter.FreedBytes, Size);
+			Bump(Counter.NumFrees, 1);
+		}
+
+		FCounters Tags[(uint32)EMemoryTag::Count];
+	};
+
+	class FMemoryTracker
+	{
+	public:
+		static inline FMemoryTracker& Get()
+		{
+			static FMemoryTracker Instance;
+			return Instance;
+		}
+
+		// Counters outlive their thread so frees on other threads still balance allocations made here
+		FThreadMemoryCounters& GetThreadCounters()
+		{
+			static thread_local FThreadMemoryCounters* Counters = nullptr;
+			if (!Counters)
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				ThreadCounters.emplace_back(new FThreadMemoryCounters);
+				Counters = ThreadCounters.back().get();
+			}
+			return *Counters;
+		}
+
+		// The epoch is shared but only written by snapshots, so reading it doesn't contend
+		void OnAlloc(EMemoryTag Tag, size_t Size)
+		{
+			GetThreadCounters().OnAlloc(Tag, Size, PeakEpoch.load(std::memory_order_relaxed));
+		}
+
+		void OnFree(EMemoryTag Tag, size_t Size)
+		{
+			GetThreadCounters().OnFree(Tag, Size, PeakEpoch.load(std::memory_order_relaxed));
+		}
+
+		// Merges every thread's counters and starts a new peak interval. The high watermark snapshot is only
+		// as fine grained as the snapshots.
+		FMemoryStats TakeSnapshot()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			uint64 Epoch = PeakEpoch.load(std::memory_order_relaxed);
+			FMemoryStats Stats;
+			for (uint32 TagIndex = 0; TagIndex < (uint32)EMemoryTag::Count; ++TagIndex)
+			{
+				uint64 Allocated = 0;
+				uint64 Freed = 0;
+				uint64 NumAllocs = 0;
+				uint64 NumFrees = 0;
+				int64 IntervalPeak = 0;
+				for (const auto& Counters : ThreadCounters)
+				{
+					const FThreadMemoryCounters::FCounters& Counter = Counters->Tags[TagIndex];
+					bool bUpdatedThisInterval = Counter.PeakEpoch.load(std::memory_order_acquire) == Epoch;
+					uint64 ThreadAllocated = Counter.AllocatedBytes.load(std::memory_order_relaxed);
+					uint64 ThreadFreed = Counter.FreedBytes.load(std::memory_order_relaxed);
+					int64 ThreadLive = (int64)(ThreadAllocated - ThreadFreed);
+					IntervalPeak += bUpdatedThisInterval ? Max(Counter.PeakLiveBytes.load(std::memory_order_relaxed), ThreadLive) : ThreadLive;
+					Allocated += ThreadAllocated;
+					Freed += ThreadFreed;
+					NumAllocs += Counter.NumAllocs.load(std::memory_order_relaxed);
+					NumFrees += Counter.NumFrees.load(std::memory_order_relaxed);
+				}
+
+				FMemoryTagStats& Tag = Stats.Tags[TagIndex];
+				Tag.LiveBytes = (int64)(Allocated - Freed);
+				Tag.LiveAllocs = (int64)(NumAllocs - NumFrees);
+				Tag.NumAllocs = NumAllocs;
+				Tag.NumFrees = NumFrees;
+				Tag.TotalAllocatedBytes = Allocated;
+				PeakBytes[TagIndex] = Max(PeakBytes[TagIndex], Max(IntervalPeak, Tag.LiveBytes));
+				Tag.PeakBytes = PeakBytes[TagIndex];
+			}
+			PeakEpoch.store(Epoch + 1, std::memory_order_relaxed);
+
+			if (GetTotalLiveBytes(Stats) >= GetTotalLiveBytes(HighWatermark))
+			{
+				HighWatermark = Stats;
+			}
+			return Stats;
+		}
+
+		// The snapshot with the largest total live bytes seen so far
+		FMemoryStats GetHighWatermark()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			return HighWatermark;
+		}
+
+		// Peaks restart from the current live bytes
+		void ResetPeaks()
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			for (uint32 TagIndex = 0; TagIndex < (uint32)EMemoryTag::Count; ++TagIndex)
+			{
+				int64 Live = 0;
+				for (const auto& Counters : ThreadCounters)
+				{
+					Live += Counters->Tags[TagIndex].GetLiveBytes();
+				}
+				PeakBytes[TagIndex] = Live;
+			}
+			PeakEpoch.store(PeakEpoch.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			HighWatermark = FMemoryStats();
+		}
+
+		static int64 GetTotalLiveBytes(const FMemoryStats& Stats)
+		{
+			int64 Total = 0;
+			for (const auto& Tag : Stats.Tags)
+			{
+				Total += Tag.LiveBytes;
+			}
+			return Total;
+		}
+
+	protected:
+		std::mutex Mutex;
+		std::vector<std::unique_ptr<FThreadMemoryCounters>> ThreadCounters;
+		// Interval 0 is never current, so every thread's first update starts its peak
+		std::atomic<uint64> PeakEpoch{1};
+		int64 PeakBytes[(uint32)EMemoryTag::Count] = {};
+		FMemoryStats HighWatermark;
+	};
+
+	inline void PrintMemoryReport(const FMemoryStats& Stats, FILE* Out = stdout)
+	{
+		fprintf(Out, "%-12s %14s %14s %10s %12s\n", "Tag", "Live KB", "Peak KB", "Live #", "Allocs");
+		for (uint32 TagIndex = 0; TagIndex < (uint32)EMemoryTag::Count; ++TagIndex)
+		{
+			const FMemoryTagStats& Tag = Stats.Tags[TagIndex];
+			fprintf(Out, "%-12s %14.1f %14.1f %10lld %12llu\n", GetMemoryTagName((EMemoryTag)TagIndex),
+				(double)Tag.LiveBytes / 1024.0, (double)Tag.PeakBytes / 1024.0, (long long)Tag.LiveAllocs, (unsigned long long)Tag.NumAllocs);
+		}
+	}
+
+	namespace Internal
+	{
+#if defined(__STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		const size_t DefaultNewAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+		const size_t DefaultNewAlignment = alignof(std::max_align_t);
+#endif
+
+		// Over-aligned blocks use the aligned operator new where the language has it (C++17); before that the
+		// block is padded and the original pointer is stashed right before the aligned address
+		inline void* AlignedNew(size_t Size, size_t Alignment)
+		{
+			if (Alignment <= DefaultNewAlignment)
+			{
+				return ::operator new(Size);
+			}
+#if defined(__cpp_aligned_new)
+			return ::operator new(Size, std::align_val_t(Alignment));
+#else
+			uint8* Allocation = (uint8*)::operator new(Size + Alignment + sizeof(void*));
+			uint8* Aligned = (uint8*)(((uintptr_t)Allocation + sizeof(void*) + Alignment - 1) & ~(uintptr_t)(Alignment - 1));
+			memcpy(Aligned - sizeof(void*), &Allocation, sizeof(void*));
+			return Aligned;
+#endif
+		}
+
+		inline void AlignedDelete(void* Ptr, size_t Alignment)
+		{
+			if (Alignment <= DefaultNewAlignment)
+			{
+				::operator delete(Ptr);
+				return;
+			}
+#if defined(__cpp_aligned_new)
+			::operator delete(Ptr, std::align_val_t(Alignment));
+#else
+			void* Allocation;
+			memcpy(&Allocation, (uint8*)Ptr - sizeof(void*), sizeof(void*));
+			::operator delete(Allocation);
+#endif
+		}
+	}
+
+	// Alignment must be a power of two
+	inline void* TaggedAlloc(EMemoryTag Tag, size_t Size, size_t Alignment = Internal::DefaultNewAlignment)
+	{
+#if RCUTILS_ENABLE_MEMORY_TRACKING
+		FMemoryTracker::Get().OnAlloc(Tag, Size);
+#else
+		(void)Tag;
+#endif
+		return Internal::AlignedNew(Size, Alignment);
+	}
+
+	// Size and Alignment must match the TaggedAlloc call
+	inline void TaggedFree(EMemoryTag Tag, void* Ptr, size_t Size, size_t Alignment = Internal::DefaultNewAlignment)
+	{
+		if (!Ptr)
+		{
+			return;
+		}
+#if RCUTILS_ENABLE_MEMORY_TRACKING
+		FMemoryTracker::Get().OnFree(Tag, Size);
+#else
+		(void)Tag;
+		(void)Size;
+#endif
+		Internal::AlignedDelete(Ptr, Alignment);
+	}
+
+	// Memory handed to the caller in a plain std container: counted in the tag's allocations and total bytes,
+	// then released from its live bytes at once since the tracker can't see when it is freed
+	inline void RecordHandOff(EMemoryTag Tag, size_t Size)
+	{
+#if RCUTILS_ENABLE_MEMORY_TRACKING
+		if (Size > 0)
+		{
+			FMemoryTracker::Get().OnAlloc(Tag, Size);
+			FMemoryTracker::Get().OnFree(Tag, Size);
+		}
+#else
+		(void)Tag;
+		(void)Size;
+#endif
+	}
+
+	template <typename T, EMemoryTag Tag>
+	struct TTrackedAllocator
+	{
+		typedef T value_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef TTrackedAllocator<U, Tag> other;
+		};
+
+		TTrackedAllocator() = default;
+
+		template <typename U>
+		TTrackedAllocator(const TTrackedAllocator<U, Tag>&)
+		{
+		}
+
+		T* allocate(size_t Num)
+		{
+			return (T*)TaggedAlloc(Tag, Num * sizeof(T), alignof(T));
+		}
+
+		void deallocate(T* Ptr, size_t Num)
+		{
+			TaggedFree(Tag, Ptr, Num * sizeof(T), alignof(T));
+		}
+
+		template <typename U>
+		bool operator == (const TTrackedAllocator<U, Tag>&) const
+		{
+			return true;
+		}
+
+		template <typename U>
+		bool operator != (const TTrackedAllocator<U, Tag>&) const
+		{
+			return false;
+		}
+	};
+
+#if RCUTILS_ENABLE_MEMORY_TRACKING
+	template <typename T, EMemoryTag Tag>
+	using TTaggedAllocator = TTrackedAllocator<T, Tag>;
+#else
+	template <typename T, EMemoryTag Tag>
+	using TTaggedAllocator = std::allocator<T>;
+#endif
+
+	// Same as std::vector/std::string when tracking is disabled
+	template <typename T, EMemoryTag Tag>
+	using TTaggedVector = std::vector<T, TTaggedAllocator<T, Tag>>;
+
+	template <EMemoryTag Tag>
+	using TTaggedString = std::basic_string<char, std::char_traits<char>, TTaggedAllocator<char, Tag>>;
+}
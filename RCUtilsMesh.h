@@ -0,0 +1,721 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsSort.h"
+#include "RCUtilsThread.h"
+#include <algorithm>
+
+// Index buffer preprocessing for triangle lists: post-transform vertex cache ordering (Tipsify), overdraw
+// aware cluster ordering, vertex fetch remapping and meshlet generation. Everything is linear in the number
+// of indices; the Submesh variants run one submesh per task.
+
+struct FSubmesh
+{
+	uint32 FirstIndex = 0;
+	uint32 NumIndices = 0;
+};
+
+struct FMeshOptimizeSettings
+{
+	uint32 CacheSize = 16;
+
+	// Clusters may be up to this much worse than the vertex cache order (ACMR ratio); 0 skips overdraw ordering
+	float OverdrawThreshold = 1.05f;
+
+	// 0 = one per hardware thread
+	uint32 NumThreads = 0;
+};
+
+struct FMeshlet
+{
+	// Into FMeshletData::Vertices
+	uint32 FirstVertex;
+
+	// Into FMeshletData::Triangles, in triangles (3 bytes each)
+	uint32 FirstTriangle;
+	uint32 NumVertices;
+	uint32 NumTriangles;
+};
+
+struct FMeshletBounds
+{
+	FVector3 Center;
+	float Radius;
+
+	// The meshlet is entirely backfacing when dot(normalize(ConeApex - CameraPosition), ConeAxis) >= ConeCutoff;
+	// meshlets without a usable cone have a cutoff of 1 and a zero axis
+	FVector3 ConeApex;
+	FVector3 ConeAxis;
+	float ConeCutoff;
+};
+
+struct FMeshletData
+{
+	std::vector<FMeshlet> Meshlets;
+	std::vector<FMeshletBounds> Bounds;
+
+	// Global vertex index per meshlet vertex
+	std::vector<uint32> Vertices;
+
+	// Three meshlet local vertex indices per triangle
+	std::vector<uint8> Triangles;
+};
+
+namespace MeshInternal
+{
+	const uint32 InvalidIndex = 0xffffffff;
+
+	// Renumbers the vertices referenced by Indices densely in first use order: OutLocal gets the local id of each
+	// index and OutGlobal the vertex of each local id. The lookup table only spans the referenced vertex range,
+	// and a range much wider than the index count is ranked by sorting instead, so the cost follows the indices
+	// rather than the vertex buffer they share with other submeshes.
+	inline void CompactVertices(const uint32* Indices, uint32 NumIndices, std::vector<uint32>& OutLocal, std::vector<uint32>& OutGlobal)
+	{
+		OutLocal.resize(NumIndices);
+		OutGlobal.clear();
+		if (NumIndices == 0)
+		{
+			return;
+		}
+
+		uint32 MinVertex = Indices[0];
+		uint32 MaxVertex = Indices[0];
+		for (uint32 Index = 1; Index < NumIndices; ++Index)
+		{
+			MinVertex = Min(MinVertex, Indices[Index]);
+			MaxVertex = Max(MaxVertex, Indices[Index]);
+		}
+
+		// Key of each index: its offset in the vertex range, or its rank among the distinct vertices
+		uint64 Range = (uint64)MaxVertex - MinVertex + 1;
+		std::vector<uint32> Sorted;
+		if (Range <= 2ull * NumIndices)
+		{
+			for (uint32 Index = 0; Index < NumIndices; ++Index)
+			{
+				OutLocal[Index] = Indices[Index] - MinVertex;
+			}
+		}
+		else
+		{
+			Sorted.assign(Indices, Indices + NumIndices);
+			std::sort(Sorted.begin(), Sorted.end());
+			Sorted.erase(std::unique(Sorted.begin(), Sorted.end()), Sorted.end());
+			Range = Sorted.size();
+			for (uint32 Index = 0; Index < NumIndices; ++Index)
+			{
+				OutLocal[Index] = (uint32)(std::lower_bound(Sorted.begin(), Sorted.end(), Indices[Index]) - Sorted.begin());
+			}
+		}
+
+		std::vector<uint32> KeyToLocal((size_t)Range, InvalidIndex);
+		for (uint32 Index = 0; Index < NumIndices; ++Index)
+		{
+			uint32& Local = KeyToLocal[OutLocal[Index]];
+			if (Local == InvalidIndex)
+			{
+				Local = (uint32)OutGlobal.size();
+				OutGlobal.push_back(Indices[Index]);
+			}
+			OutLocal[Index] = Local;
+		}
+	}
+
+	// FIFO post-transform cache; bumping Time by CacheSize flushes it
+	struct FVertexCacheSim
+	{
+		std::vector<uint32> Stamps;
+		uint32 Time;
+		uint32 CacheSize;
+
+		FVertexCacheSim(uint32 NumVertices, uint32 InCacheSize)
+			: Stamps(NumVertices, 0)
+			, Time(InCacheSize + 1)
+			, CacheSize(InCacheSize)
+		{
+		}
+
+		// Returns true on a miss
+		bool Access(uint32 Vertex)
+		{
+			if (Time - Stamps[Vertex] > CacheSize)
+			{
+				Stamps[Vertex] = Time++;
+				return true;
+			}
+			return false;
+		}
+
+		void Flush()
+		{
+			Time += CacheSize + 1;
+		}
+	};
+}
+
+// Average cache miss ratio: transformed vertices per triangle with a FIFO cache (0.5 is ideal for large grids, 3 the worst)
+inline float GetVertexCacheMissRatio(const uint32* Indices, uint32 NumIndices, uint32 NumVertices, uint32 CacheSize = 16)
+{
+	if (NumIndices == 0)
+	{
+		return 0.0f;
+	}
+
+	MeshInternal::FVertexCacheSim Cache(NumVertices, CacheSize);
+	uint32 Misses = 0;
+	for (uint32 Index = 0; Index < NumIndices; ++Index)
+	{
+		Misses += Cache.Access(Indices[Index]) ? 1 : 0;
+	}
+	return (float)Misses / (float)(NumIndices / 3);
+}
+
+// Tipsify (Sander et al. 2007): fans around the most recently cached vertex that is still live and jumps
+// through a dead-end stack when none is left. OutIndices may alias Indices.
+inline void OptimizeVertexCache(uint32* OutIndices, const uint32* Indices, uint32 NumIndices, uint32 NumVertices, uint32 CacheSize = 16)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	using namespace MeshInternal;
+	checkAlways(NumIndices % 3 == 0);
+	uint32 NumTriangles = NumIndices / 3;
+
+	std::vector<uint32> InputCopy;
+	if (OutIndices == Indices)
+	{
+		InputCopy.assign(Indices, Indices + NumIndices);
+		Indices = InputCopy.data();
+	}
+
+	// Vertex to triangle adjacency; Live counts the triangles of each vertex not emitted yet
+	std::vector<uint32> Live(NumVertices, 0);
+	for (uint32 Index = 0; Index < NumIndices; ++Index)
+	{
+		checkSlow(Indices[Index] < NumVertices);
+		++Live[Indices[Index]];
+	}
+
+	std::vector<uint32> Offsets(NumVertices + 1);
+	Offsets[0] = 0;
+	for (uint32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		Offsets[Vertex + 1] = Offsets[Vertex] + Live[Vertex];
+	}
+
+	std::vector<uint32> Adjacency(NumIndices);
+	{
+		std::vector<uint32> Cursor(Offsets.begin(), Offsets.end() - 1);
+		for (uint32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+		{
+			for (uint32 Corner = 0; Corner < 3; ++Corner)
+			{
+				Adjacency[Cursor[Indices[Triangle * 3 + Corner]]++] = Triangle;
+			}
+		}
+	}
+
+	std::vector<uint32> CacheTime(NumVertices, 0);
+	std::vector<uint8> Emitted(NumTriangles, 0);
+	std::vector<uint32> DeadEnd;
+	DeadEnd.reserve(NumIndices);
+	std::vector<uint32> Candidates;
+	uint32 Time = CacheSize + 1;
+	uint32 ScanCursor = 0;
+	uint32 NumOut = 0;
+
+	auto SkipDeadEnd = [&]() -> uint32
+	{
+		while (!DeadEnd.empty())
+		{
+			uint32 Vertex = DeadEnd.back();
+			DeadEnd.pop_back();
+			if (Live[Vertex] > 0)
+			{
+				return Vertex;
+			}
+		}
+
+		for (; ScanCursor < NumVertices; ++ScanCursor)
+		{
+			if (Live[ScanCursor] > 0)
+			{
+				return ScanCursor;
+			}
+		}
+		return InvalidIndex;
+	};
+
+	uint32 Fan = SkipDeadEnd();
+	while (Fan != InvalidIndex)
+	{
+		Candidates.clear();
+		for (uint32 Adjacent = Offsets[Fan]; Adjacent < Offsets[Fan + 1]; ++Adjacent)
+		{
+			uint32 Triangle = Adjacency[Adjacent];
+			if (Emitted[Triangle])
+			{
+				continue;
+			}
+
+			for (uint32 Corner = 0; Corner < 3; ++Corner)
+			{
+				uint32 Vertex = Indices[Triangle * 3 + Corner];
+				OutIndices[NumOut++] = Vertex;
+				DeadEnd.push_back(Vertex);
+				Candidates.push_back(Vertex);
+				--Live[Vertex];
+				if (Time - CacheTime[Vertex] > CacheSize)
+				{
+					CacheTime[Vertex] = Time++;
+				}
+			}
+			Emitted[Triangle] = 1;
+		}
+
+		// Prefer the oldest candidate that will still be in the cache after its remaining fan is emitted
+		uint32 Next = InvalidIndex;
+		int32 BestPriority = -1;
+		for (uint32 Vertex : Candidates)
+		{
+			if (Live[Vertex] == 0)
+			{
+				continue;
+			}
+
+			int32 Priority = 0;
+			if (Time - CacheTime[Vertex] + 2 * Live[Vertex] <= CacheSize)
+			{
+				Priority = (int32)(Time - CacheTime[Vertex]);
+			}
+			if (Priority > BestPriority)
+			{
+				BestPriority = Priority;
+				Next = Vertex;
+			}
+		}
+
+		Fan = Next != InvalidIndex ? Next : SkipDeadEnd();
+	}
+
+	check(NumOut == NumIndices);
+}
+
+// Reorders clusters of a cache optimized index buffer so outward facing clusters draw first, which cuts
+// overdraw from most viewpoints. Clusters start where the cache restarts (all three vertices miss) and are
+// split further while their miss ratio stays within Threshold of the original. OutIndices may alias Indices.
+inline void OptimizeOverdraw(uint32* OutIndices, const uint32* Indices, uint32 NumIndices, const FVector3* Positions, uint32 NumVertices, uint32 CacheSize = 16, float Threshold = 1.05f)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	using namespace MeshInternal;
+	checkAlways(NumIndices % 3 == 0);
+	uint32 NumTriangles = NumIndices / 3;
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	std::vector<uint32> InputCopy;
+	if (OutIndices == Indices)
+	{
+		InputCopy.assign(Indices, Indices + NumIndices);
+		Indices = InputCopy.data();
+	}
+
+	FVertexCacheSim Cache(NumVertices, CacheSize);
+	std::vector<uint32> HardClusters;
+	for (uint32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+	{
+		uint32 Misses = 0;
+		for (uint32 Corner = 0; Corner < 3; ++Corner)
+		{
+			Misses += Cache.Access(Indices[Triangle * 3 + Corner]) ? 1 : 0;
+		}
+		if (Misses == 3 || Triangle == 0)
+		{
+			HardClusters.push_back(Triangle);
+		}
+	}
+	HardClusters.push_back(NumTriangles);
+
+	std::vector<uint32> Clusters;
+	for (size_t Hard = 0; Hard + 1 < HardClusters.size(); ++Hard)
+	{
+		uint32 Begin = HardClusters[Hard];
+		uint32 End = HardClusters[Hard + 1];
+
+		Cache.Flush();
+		uint32 HardMisses = 0;
+		for (uint32 Index = Begin * 3; Index < End * 3; ++Index)
+		{
+			HardMisses += Cache.Access(Indices[Index]) ? 1 : 0;
+		}
+		float Limit = Threshold * (float)HardMisses / (float)(End - Begin);
+
+		Cache.Flush();
+		Clusters.push_back(Begin);
+		uint32 Misses = 0;
+		uint32 Count = 0;
+		for (uint32 Triangle = Begin; Triangle < End; ++Triangle)
+		{
+			for (uint32 Corner = 0; Corner < 3; ++Corner)
+			{
+				Misses += Cache.Access(Indices[Triangle * 3 + Corner]) ? 1 : 0;
+			}
+			++Count;
+
+			if (Triangle + 1 < End && (float)Misses <= Limit * (float)Count)
+			{
+				Clusters.push_back(Triangle + 1);
+				Cache.Flush();
+				Misses = 0;
+				Count = 0;
+			}
+		}
+	}
+	uint32 NumClusters = (uint32)Clusters.size();
+	Clusters.push_back(NumTriangles);
+
+	FVector3 MeshCenter = FVector3::GetZero();
+	for (uint32 Index = 0; Index < NumIndices; ++Index)
+	{
+		MeshCenter += Positions[Indices[Index]];
+	}
+	MeshCenter *= 1.0f / (float)NumIndices;
+
+	// Sort key: how far the cluster sits along its own average normal, outermost first
+	std::vector<float> Keys(NumClusters);
+	std::vector<uint32> Order(NumClusters);
+	for (uint32 Cluster = 0; Cluster < NumClusters; ++Cluster)
+	{
+		FVector3 Center = FVector3::GetZero();
+		FVector3 Normal = FVector3::GetZero();
+		float Area = 0.0f;
+		for (uint32 Triangle = Clusters[Cluster]; Triangle < Clusters[Cluster + 1]; ++Triangle)
+		{
+			const FVector3& A = Positions[Indices[Triangle * 3 + 0]];
+			const FVector3& B = Positions[Indices[Triangle * 3 + 1]];
+			const FVector3& C = Positions[Indices[Triangle * 3 + 2]];
+			FVector3 Cross = FVector3::Cross(B - A, C - A);
+			float TriangleArea = sqrtf(FVector3::Dot(Cross, Cross));
+			Center += (A + B + C) * (TriangleArea / 3.0f);
+			Normal += Cross;
+			Area += TriangleArea;
+		}
+
+		float NormalLength = sqrtf(FVector3::Dot(Normal, Normal));
+		Center = Area > 0.0f ? Center * (1.0f / Area) : MeshCenter;
+		Keys[Cluster] = NormalLength > 0.0f ? -FVector3::Dot(Center - MeshCenter, Normal) / NormalLength : 0.0f;
+		Order[Cluster] = Cluster;
+	}
+
+	// Already inside a per submesh task, so sort on this thread
+	RCUtils::RadixSort(Keys.data(), Order.data(), NumClusters, std::vector<float>(NumClusters).data(), std::vector<uint32>(NumClusters).data(), 1);
+
+	uint32 NumOut = 0;
+	for (uint32 Cluster : Order)
+	{
+		uint32 Begin = Clusters[Cluster] * 3;
+		uint32 End = Clusters[Cluster + 1] * 3;
+		for (uint32 Index = Begin; Index < End; ++Index)
+		{
+			OutIndices[NumOut++] = Indices[Index];
+		}
+	}
+}
+
+// Numbers vertices in order of first use so vertex fetch walks memory forward. Unused vertices map to
+// InvalidIndex (0xffffffff). Returns the number of used vertices.
+inline uint32 OptimizeVertexFetchRemap(uint32* OutRemap, const uint32* Indices, uint32 NumIndices, uint32 NumVertices)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	std::fill(OutRemap, OutRemap + NumVertices, MeshInternal::InvalidIndex);
+	uint32 NumUsed = 0;
+	for (uint32 Index = 0; Index < NumIndices; ++Index)
+	{
+		uint32& Remapped = OutRemap[Indices[Index]];
+		if (Remapped == MeshInternal::InvalidIndex)
+		{
+			Remapped = NumUsed++;
+		}
+	}
+	return NumUsed;
+}
+
+// OutIndices may alias Indices
+inline void RemapIndices(uint32* OutIndices, const uint32* Indices, uint32 NumIndices, const uint32* Remap)
+{
+	for (uint32 Index = 0; Index < NumIndices; ++Index)
+	{
+		OutIndices[Index] = Remap[Indices[Index]];
+	}
+}
+
+// OutVertices must not alias Vertices; unused vertices are dropped
+inline void RemapVertices(void* OutVertices, const void* Vertices, uint32 NumVertices, size_t VertexSize, const uint32* Remap)
+{
+	checkAlways(OutVertices != Vertices);
+	for (uint32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		if (Remap[Vertex] != MeshInternal::InvalidIndex)
+		{
+			memcpy((uint8*)OutVertices + Remap[Vertex] * VertexSize, (const uint8*)Vertices + Vertex * VertexSize, VertexSize);
+		}
+	}
+}
+
+// Ritter bounding sphere plus a backface culling cone over the meshlet's triangles
+inline FMeshletBounds ComputeMeshletBounds(const FMeshletData& Data, uint32 MeshletIndex, const FVector3* Positions)
+{
+	const FMeshlet& Meshlet = Data.Meshlets[MeshletIndex];
+	const uint32* Vertices = Data.Vertices.data() + Meshlet.FirstVertex;
+	const uint8* Triangles = Data.Triangles.data() + Meshlet.FirstTriangle * 3;
+	FMeshletBounds Bounds;
+
+	FVector3 First = Positions[Vertices[0]];
+	FVector3 Far0 = First;
+	FVector3 Far1 = First;
+	float MaxDistanceSq = -1.0f;
+	for (uint32 Index = 0; Index < Meshlet.NumVertices; ++Index)
+	{
+		FVector3 Delta = Positions[Vertices[Index]] - First;
+		float DistanceSq = FVector3::Dot(Delta, Delta);
+		if (DistanceSq > MaxDistanceSq)
+		{
+			MaxDistanceSq = DistanceSq;
+			Far0 = Positions[Vertices[Index]];
+		}
+	}
+	MaxDistanceSq = -1.0f;
+	for (uint32 Index = 0; Index < Meshlet.NumVertices; ++Index)
+	{
+		FVector3 Delta = Positions[Vertices[Index]] - Far0;
+		float DistanceSq = FVector3::Dot(Delta, Delta);
+		if (DistanceSq > MaxDistanceSq)
+		{
+			MaxDistanceSq = DistanceSq;
+			Far1 = Positions[Vertices[Index]];
+		}
+	}
+
+	FVector3 Center = (Far0 + Far1) * 0.5f;
+	float Radius = sqrtf(MaxDistanceSq) * 0.5f;
+	for (uint32 Index = 0; Index < Meshlet.NumVertices; ++Index)
+	{
+		FVector3 Delta = Positions[Vertices[Index]] - Center;
+		float Distance = sqrtf(FVector3::Dot(Delta, Delta));
+		if (Distance > Radius)
+		{
+			// Grow just enough to cover the outlier
+			float NewRadius = (Radius + Distance) * 0.5f;
+			Center += Delta * ((NewRadius - Radius) / Distance);
+			Radius = NewRadius;
+		}
+	}
+	Bounds.Center = Center;
+	Bounds.Radius = Radius;
+
+	// Cone around the average normal, widened to the normal furthest from it
+	FVector3 Normals[256 * 2];
+	checkAlways(Meshlet.NumTriangles <= 512);
+	uint32 NumNormals = 0;
+	FVector3 Axis = FVector3::GetZero();
+	for (uint32 Triangle = 0; Triangle < Meshlet.NumTriangles; ++Triangle)
+	{
+		const FVector3& A = Positions[Vertices[Triangles[Triangle * 3 + 0]]];
+		const FVector3& B = Positions[Vertices[Triangles[Triangle * 3 + 1]]];
+		const FVector3& C = Positions[Vertices[Triangles[Triangle * 3 + 2]]];
+		FVector3 Normal = FVector3::Cross(B - A, C - A);
+		float Length = sqrtf(FVector3::Dot(Normal, Normal));
+		if (Length > 0.0f)
+		{
+			Normal *= 1.0f / Length;
+			Normals[NumNormals++] = Normal;
+			Axis += Normal;
+		}
+	}
+
+	Bounds.ConeApex = Center;
+	Bounds.ConeAxis = FVector3::GetZero();
+	Bounds.ConeCutoff = 1.0f;
+	float AxisLength = sqrtf(FVector3::Dot(Axis, Axis));
+	if (NumNormals == 0 || AxisLength <= 0.0f)
+	{
+		return Bounds;
+	}
+
+	Axis *= 1.0f / AxisLength;
+	float MinDot = 1.0f;
+	for (uint32 Index = 0; Index < NumNormals; ++Index)
+	{
+		MinDot = Min(MinDot, FVector3::Dot(Normals[Index], Axis));
+	}
+
+	// Spread close to 90 degrees leaves nothing to cull and makes the apex run off to infinity
+	if (MinDot <= 0.1f)
+	{
+		return Bounds;
+	}
+
+	// Pull the apex back along the axis until it is behind every triangle plane
+	float MaxT = 0.0f;
+	uint32 NormalIndex = 0;
+	for (uint32 Triangle = 0; Triangle < Meshlet.NumTriangles; ++Triangle)
+	{
+		const FVector3& A = Positions[Vertices[Triangles[Triangle * 3 + 0]]];
+		const FVector3& B = Positions[Vertices[Triangles[Triangle * 3 + 1]]];
+		const FVector3& C = Positions[Vertices[Triangles[Triangle * 3 + 2]]];
+		FVector3 Cross = FVector3::Cross(B - A, C - A);
+		if (FVector3::Dot(Cross, Cross) <= 0.0f)
+		{
+			continue;
+		}
+
+		const FVector3& Normal = Normals[NormalIndex++];
+		float T = FVector3::Dot(Center - A, Normal) / FVector3::Dot(Axis, Normal);
+		MaxT = Max(MaxT, T);
+	}
+
+	Bounds.ConeApex = Center - Axis * MaxT;
+	Bounds.ConeAxis = Axis;
+	Bounds.ConeCutoff = sqrtf(1.0f - MinDot * MinDot);
+	return Bounds;
+}
+
+// Greedily packs triangles in index order into meshlets of at most MaxVertices / MaxTriangles, so run the
+// vertex cache optimizer first for tight meshlets. Appends to Out, including bounds.
+inline void BuildMeshlets(FMeshletData& Out, const uint32* Indices, uint32 NumIndices, const FVector3* Positions, uint32 NumVertices, uint32 MaxVertices = 64, uint32 MaxTriangles = 124)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	using namespace MeshInternal;
+	checkAlways(NumIndices % 3 == 0);
+	checkAlways(MaxVertices >= 3 && MaxVertices <= 256);
+	checkAlways(MaxTriangles >= 1 && MaxTriangles <= 512);
+
+	// Meshlet local index per compacted vertex, reset as each meshlet is flushed
+	std::vector<uint32> Local;
+	std::vector<uint32> Global;
+	CompactVertices(Indices, NumIndices, Local, Global);
+	std::vector<uint32> LocalIndex(Global.size(), InvalidIndex);
+	size_t FirstNewMeshlet = Out.Meshlets.size();
+	FMeshlet Current = { (uint32)Out.Vertices.size(), (uint32)(Out.Triangles.size() / 3), 0, 0 };
+	std::vector<uint32> CurrentVertices;
+
+	auto Flush = [&]()
+	{
+		for (uint32 Vertex : CurrentVertices)
+		{
+			LocalIndex[Vertex] = InvalidIndex;
+		}
+		CurrentVertices.clear();
+		Out.Meshlets.push_back(Current);
+		Current.FirstVertex += Current.NumVertices;
+		Current.FirstTriangle += Current.NumTriangles;
+		Current.NumVertices = 0;
+		Current.NumTriangles = 0;
+	};
+
+	for (uint32 Index = 0; Index < NumIndices; Index += 3)
+	{
+		uint32 NumNew = 0;
+		for (uint32 Corner = 0; Corner < 3; ++Corner)
+		{
+			checkSlow(Indices[Index + Corner] < NumVertices);
+			NumNew += LocalIndex[Local[Index + Corner]] == InvalidIndex ? 1 : 0;
+		}
+
+		// Repeated corners of a degenerate triangle are counted twice here, which only makes the check conservative
+		if (Current.NumVertices + NumNew > MaxVertices || Current.NumTriangles + 1 > MaxTriangles)
+		{
+			Flush();
+		}
+
+		for (uint32 Corner = 0; Corner < 3; ++Corner)
+		{
+			uint32 Vertex = Local[Index + Corner];
+			if (LocalIndex[Vertex] == InvalidIndex)
+			{
+				LocalIndex[Vertex] = Current.NumVertices++;
+				CurrentVertices.push_back(Vertex);
+				Out.Vertices.push_back(Global[Vertex]);
+			}
+			Out.Triangles.push_back((uint8)LocalIndex[Vertex]);
+		}
+		++Current.NumTriangles;
+	}
+
+	if (Current.NumTriangles > 0)
+	{
+		Flush();
+	}
+
+	Out.Bounds.resize(Out.Meshlets.size());
+	for (size_t Meshlet = FirstNewMeshlet; Meshlet < Out.Meshlets.size(); ++Meshlet)
+	{
+		Out.Bounds[Meshlet] = ComputeMeshletBounds(Out, (uint32)Meshlet, Positions);
+	}
+}
+
+// Vertex cache and then overdraw ordering for each submesh, in parallel and in place. Each task compacts its
+// submesh to local vertex ids first, so the work is proportional to the submesh, not the shared vertex buffer.
+inline void OptimizeSubmeshes(uint32* Indices, const FSubmesh* Submeshes, uint32 NumSubmeshes, const FVector3* Positions, uint32 NumVertices, const FMeshOptimizeSettings& Settings = FMeshOptimizeSettings())
+{
+	RCUTILS_PROFILE_FUNCTION();
+	RCUtils::ParallelFor(NumSubmeshes, [&](uint32 SubmeshIndex)
+	{
+		const FSubmesh& Submesh = Submeshes[SubmeshIndex];
+		uint32* SubmeshIndices = Indices + Submesh.FirstIndex;
+
+		std::vector<uint32> Local;
+		std::vector<uint32> GlobalIndex;
+		MeshInternal::CompactVertices(SubmeshIndices, Submesh.NumIndices, Local, GlobalIndex);
+		std::vector<FVector3> LocalPositions(GlobalIndex.size());
+		for (size_t Vertex = 0; Vertex < GlobalIndex.size(); ++Vertex)
+		{
+			checkSlow(GlobalIndex[Vertex] < NumVertices);
+			LocalPositions[Vertex] = Positions[GlobalIndex[Vertex]];
+		}
+
+		uint32 NumLocalVertices = (uint32)GlobalIndex.size();
+		OptimizeVertexCache(Local.data(), Local.data(), Submesh.NumIndices, NumLocalVertices, Settings.CacheSize);
+		if (Settings.OverdrawThreshold > 0.0f)
+		{
+			OptimizeOverdraw(Local.data(), Local.data(), Submesh.NumIndices, LocalPositions.data(), NumLocalVertices, Settings.CacheSize, Settings.OverdrawThreshold);
+		}
+
+		for (uint32 Index = 0; Index < Submesh.NumIndices; ++Index)
+		{
+			SubmeshIndices[Index] = GlobalIndex[Local[Index]];
+		}
+	}, Settings.NumThreads);
+}
+
+// Meshlets for each submesh built in parallel and concatenated in submesh order; the meshlets of submesh S are
+// [OutFirstMeshlet[S], OutFirstMeshlet[S + 1])
+inline void BuildSubmeshMeshlets(FMeshletData& Out, std::vector<uint32>& OutFirstMeshlet, const uint32* Indices, const FSubmesh* Submeshes, uint32 NumSubmeshes, const FVector3* Positions, uint32 NumVertices, uint32 MaxVertices = 64, uint32 MaxTriangles = 124, uint32 NumThreads = 0)
+{
+	RCUTILS_PROFILE_FUNCTION();
+	std::vector<FMeshletData> PerSubmesh(NumSubmeshes);
+	RCUtils::ParallelFor(NumSubmeshes, [&](uint32 SubmeshIndex)
+	{
+		const FSubmesh& Submesh = Submeshes[SubmeshIndex];
+		BuildMeshlets(PerSubmesh[SubmeshIndex], Indices + Submesh.FirstIndex, Submesh.NumIndices, Positions, NumVertices, MaxVertices, MaxTriangles);
+	}, NumThreads);
+
+	OutFirstMeshlet.resize(NumSubmeshes + 1);
+	for (uint32 SubmeshIndex = 0; SubmeshIndex < NumSubmeshes; ++SubmeshIndex)
+	{
+		const FMeshletData& Data = PerSubmesh[SubmeshIndex];
+		OutFirstMeshlet[SubmeshIndex] = (uint32)Out.Meshlets.size();
+		uint32 VertexOffset = (uint32)Out.Vertices.size();
+		uint32 TriangleOffset = (uint32)(Out.Triangles.size() / 3);
+		for (FMeshlet Meshlet : Data.Meshlets)
+		{
+			Meshlet.FirstVertex += VertexOffset;
+			Meshlet.FirstTriangle += TriangleOffset;
+			Out.Meshlets.push_back(Meshlet);
+		}
+		Out.Bounds.insert(Out.Bounds.end(), Data.Bounds.begin(), Data.Bounds.end());
+		Out.Vertices.insert(Out.Vertices.end(), Data.Vertices.begin(), Data.Vertices.end());
+		Out.Triangles.insert(Out.Triangles.end(), Data.Triangles.begin(), Data.Triangles.end());
+	}
+	OutFirstMeshlet[NumSubmeshes] = (uint32)Out.Meshlets.size();
+}
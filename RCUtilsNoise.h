@@ -0,0 +1,674 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsThread.h"
+
+// Value, Perlin and simplex gradient noise in 2D/3D/4D with fBm and ridged fractals. Lattice gradients come
+// from an integer hash of the cell and seed instead of a permutation table, so there is no table to gather
+// from and no period (coordinates must stay within int32 range). All noise functions return roughly [-1, 1].
+//
+// The batch functions evaluate NoiseLanes points at a time in lane loops that are written branch free, so
+// they compile to straight SIMD (4 wide SSE, 8 wide AVX2 with -mavx2 or /arch:AVX2; GCC only vectorizes them
+// at -O3). Every sample goes through the same full width loop, including the padded tail of a row, so results
+// are bit identical across runs and thread counts for a given build.
+namespace RCUtils
+{
+	enum class ENoiseType : uint8
+	{
+		Value,
+		Perlin,
+		Simplex,
+	};
+
+	enum class EFractalType : uint8
+	{
+		// Sum of octaves with falling amplitude, [-1, 1]
+		FBm,
+		// Sum of squared inverted absolute octaves, [0, 1]; sharp crests where the noise crosses zero
+		Ridged,
+	};
+
+	struct FNoiseSettings
+	{
+		ENoiseType Type = ENoiseType::Simplex;
+		EFractalType Fractal = EFractalType::FBm;
+		uint32 Seed = 0;
+		float Frequency = 1.0f;
+		// One octave is plain noise
+		uint32 NumOctaves = 1;
+		// Frequency multiplier per octave
+		float Lacunarity = 2.0f;
+		// Amplitude multiplier per octave
+		float Gain = 0.5f;
+		// 0 uses all hardware threads
+		uint32 NumThreads = 0;
+	};
+
+	namespace Internal
+	{
+		const uint32 NoiseLanes = 8;
+
+		inline int32 NoiseFloor(float Value)
+		{
+			int32 Truncated = (int32)Value;
+			return Truncated - (int32)(Value < (float)Truncated);
+		}
+
+		// Quintic fade, zero first and second derivatives at the lattice points
+		inline float NoiseFade(float T)
+		{
+			return T * T * T * (T * (T * 6.0f - 15.0f) + 10.0f);
+		}
+
+		inline float NoiseLerp(float A, float B, float T)
+		{
+			return A + (B - A) * T;
+		}
+
+		inline uint32 NoiseHash(uint32 Seed, int32 X, int32 Y)
+		{
+			uint32 Hash = Seed ^ ((uint32)X * 0x9E3779B1u) ^ ((uint32)Y * 0x85EBCA77u);
+			Hash ^= Hash >> 15;
+			Hash *= 0x2C1B3C6Du;
+			return Hash ^ (Hash >> 12);
+		}
+
+		// 3D and 4D lattices are stacks of 2D ones: the Z (and W) coordinate is folded into the seed
+		inline uint32 NoiseLayerSeed(uint32 Seed, int32 Z)
+		{
+			return Seed ^ ((uint32)Z * 0xC2B2AE3Du);
+		}
+
+		inline uint32 NoiseLayerSeed(uint32 Seed, int32 Z, int32 W)
+		{
+			return Seed ^ ((uint32)Z * 0xC2B2AE3Du) ^ ((uint32)W * 0x27D4EB2Fu);
+		}
+
+		inline uint32 NoiseHash(uint32 Seed, int32 X, int32 Y, int32 Z)
+		{
+			return NoiseHash(NoiseLayerSeed(Seed, Z), X, Y);
+		}
+
+		inline uint32 NoiseHash(uint32 Seed, int32 X, int32 Y, int32 Z, int32 W)
+		{
+			return NoiseHash(NoiseLayerSeed(Seed, Z, W), X, Y);
+		}
+
+		// Lattice values in [-1, 1)
+		inline float NoiseHashToFloat(uint32 Hash)
+		{
+			return (float)(int32)Hash * (1.0f / 2147483648.0f);
+		}
+
+		// Select and sign flip on the bit patterns: ternaries around float math are not if-converted by every
+		// compiler (a conditional multiply may trap), which would leave the lane loops scalar
+		inline float NoiseSelect(bool bFirst, float A, float B)
+		{
+			uint32 Mask = 0u - (uint32)bFirst;
+			return FastMathInternal::BitsToFloat((FastMathInternal::FloatToBits(A) & Mask) | (FastMathInternal::FloatToBits(B) & ~Mask));
+		}
+
+		inline float NoiseNegateIf(uint32 bNegate, float Value)
+		{
+			return FastMathInternal::BitsToFloat(FastMathInternal::FloatToBits(Value) ^ (bNegate << 31));
+		}
+
+		// Gradients pick from the top bits, which the final multiply mixes best.
+		// 2D: (+-1, +-2) and (+-2, +-1)
+		inline float NoiseGrad(uint32 Hash, float X, float Y)
+		{
+			uint32 H = Hash >> 29;
+			float U = NoiseSelect(H < 4, X, Y);
+			float V = NoiseSelect(H < 4, Y, X);
+			return NoiseNegateIf(H & 1, U) + NoiseNegateIf((H >> 1) & 1, 2.0f * V);
+		}
+
+		// 3D: the 12 cube edge directions, four of them twice (Perlin 2002)
+		inline float NoiseGrad(uint32 Hash, float X, float Y, float Z)
+		{
+			uint32 H = Hash >> 28;
+			float U = NoiseSelect(H < 8, X, Y);
+			float V = NoiseSelect(H < 4, Y, NoiseSelect((H | 2) == 14, X, Z));
+			return NoiseNegateIf(H & 1, U) + NoiseNegateIf((H >> 1) & 1, V);
+		}
+
+		// 4D: the 32 directions with one zero and three +-1 components
+		inline float NoiseGrad(uint32 Hash, float X, float Y, float Z, float W)
+		{
+			uint32 H = Hash >> 27;
+			float U = NoiseSelect(H < 24, X, Y);
+			float V = NoiseSelect(H < 16, Y, Z);
+			float T = NoiseSelect(H < 8, Z, W);
+			return NoiseNegateIf(H & 1, U) + NoiseNegateIf((H >> 1) & 1, V) + NoiseNegateIf((H >> 2) & 1, T);
+		}
+
+		// Simplex corner falloff (0.5 - r^2)^4, which reaches zero exactly at the neighbouring simplices
+		inline float SimplexFalloff(float DistanceSquared)
+		{
+			float T = NoiseSelect(DistanceSquared < 0.5f, 0.5f - DistanceSquared, 0.0f);
+			T *= T;
+			return T * T;
+		}
+
+		// One XY face of a lattice cell, blended along X and Y. Higher dimensions blend faces from separate
+		// calls rather than looping over a local array, which keeps the lane loops vectorizable.
+		RCUTILS_FORCEINLINE float ValueNoiseFace(uint32 LayerSeed, int32 X0, int32 Y0, float U, float V)
+		{
+			float N0 = NoiseLerp(NoiseHashToFloat(NoiseHash(LayerSeed, X0, Y0)), NoiseHashToFloat(NoiseHash(LayerSeed, X0 + 1, Y0)), U);
+			float N1 = NoiseLerp(NoiseHashToFloat(NoiseHash(LayerSeed, X0, Y0 + 1)), NoiseHashToFloat(NoiseHash(LayerSeed, X0 + 1, Y0 + 1)), U);
+			return NoiseLerp(N0, N1, V);
+		}
+
+		RCUTILS_FORCEINLINE float ValueNoise2(float X, float Y, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			return ValueNoiseFace(Seed, X0, Y0, NoiseFade(X - (float)X0), NoiseFade(Y - (float)Y0));
+		}
+
+		RCUTILS_FORCEINLINE float ValueNoise3(float X, float Y, float Z, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			int32 Z0 = NoiseFloor(Z);
+			float U = NoiseFade(X - (float)X0);
+			float V = NoiseFade(Y - (float)Y0);
+			float W = NoiseFade(Z - (float)Z0);
+			float N0 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0), X0, Y0, U, V);
+			float N1 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0 + 1), X0, Y0, U, V);
+			return NoiseLerp(N0, N1, W);
+		}
+
+		RCUTILS_FORCEINLINE float ValueNoise4(float X, float Y, float Z, float W, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			int32 Z0 = NoiseFloor(Z);
+			int32 W0 = NoiseFloor(W);
+			float FadeX = NoiseFade(X - (float)X0);
+			float FadeY = NoiseFade(Y - (float)Y0);
+			float FadeZ = NoiseFade(Z - (float)Z0);
+			float FadeW = NoiseFade(W - (float)W0);
+			float N00 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0, W0), X0, Y0, FadeX, FadeY);
+			float N10 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0 + 1, W0), X0, Y0, FadeX, FadeY);
+			float N01 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0, W0 + 1), X0, Y0, FadeX, FadeY);
+			float N11 = ValueNoiseFace(NoiseLayerSeed(Seed, Z0 + 1, W0 + 1), X0, Y0, FadeX, FadeY);
+			return NoiseLerp(NoiseLerp(N00, N10, FadeZ), NoiseLerp(N01, N11, FadeZ), FadeW);
+		}
+
+		// Improved Perlin noise (Perlin 2002) with hashed gradients
+		RCUTILS_FORCEINLINE float PerlinNoise2(float X, float Y, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			float FX = X - (float)X0;
+			float FY = Y - (float)Y0;
+			float U = NoiseFade(FX);
+			float V = NoiseFade(FY);
+			float N0 = NoiseLerp(NoiseGrad(NoiseHash(Seed, X0, Y0), FX, FY), NoiseGrad(NoiseHash(Seed, X0 + 1, Y0), FX - 1.0f, FY), U);
+			float N1 = NoiseLerp(NoiseGrad(NoiseHash(Seed, X0, Y0 + 1), FX, FY - 1.0f), NoiseGrad(NoiseHash(Seed, X0 + 1, Y0 + 1), FX - 1.0f, FY - 1.0f), U);
+			return 0.64f * NoiseLerp(N0, N1, V);
+		}
+
+		RCUTILS_FORCEINLINE float PerlinNoiseFace(uint32 LayerSeed, int32 X0, int32 Y0, float FX, float FY, float GZ, float U, float V)
+		{
+			float N0 = NoiseLerp(NoiseGrad(NoiseHash(LayerSeed, X0, Y0), FX, FY, GZ), NoiseGrad(NoiseHash(LayerSeed, X0 + 1, Y0), FX - 1.0f, FY, GZ), U);
+			float N1 = NoiseLerp(NoiseGrad(NoiseHash(LayerSeed, X0, Y0 + 1), FX, FY - 1.0f, GZ), NoiseGrad(NoiseHash(LayerSeed, X0 + 1, Y0 + 1), FX - 1.0f, FY - 1.0f, GZ), U);
+			return NoiseLerp(N0, N1, V);
+		}
+
+		RCUTILS_FORCEINLINE float PerlinNoiseFace(uint32 LayerSeed, int32 X0, int32 Y0, float FX, float FY, float GZ, float GW, float U, float V)
+		{
+			float N0 = NoiseLerp(NoiseGrad(NoiseHash(LayerSeed, X0, Y0), FX, FY, GZ, GW), NoiseGrad(NoiseHash(LayerSeed, X0 + 1, Y0), FX - 1.0f, FY, GZ, GW), U);
+			float N1 = NoiseLerp(NoiseGrad(NoiseHash(LayerSeed, X0, Y0 + 1), FX, FY - 1.0f, GZ, GW), NoiseGrad(NoiseHash(LayerSeed, X0 + 1, Y0 + 1), FX - 1.0f, FY - 1.0f, GZ, GW), U);
+			return NoiseLerp(N0, N1, V);
+		}
+
+		RCUTILS_FORCEINLINE float PerlinNoise3(float X, float Y, float Z, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			int32 Z0 = NoiseFloor(Z);
+			float FX = X - (float)X0;
+			float FY = Y - (float)Y0;
+			float FZ = Z - (float)Z0;
+			float U = NoiseFade(FX);
+			float V = NoiseFade(FY);
+			float N0 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0), X0, Y0, FX, FY, FZ, U, V);
+			float N1 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0 + 1), X0, Y0, FX, FY, FZ - 1.0f, U, V);
+			return NoiseLerp(N0, N1, NoiseFade(FZ));
+		}
+
+		RCUTILS_FORCEINLINE float PerlinNoise4(float X, float Y, float Z, float W, uint32 Seed)
+		{
+			int32 X0 = NoiseFloor(X);
+			int32 Y0 = NoiseFloor(Y);
+			int32 Z0 = NoiseFloor(Z);
+			int32 W0 = NoiseFloor(W);
+			float FX = X - (float)X0;
+			float FY = Y - (float)Y0;
+			float FZ = Z - (float)Z0;
+			float FW = W - (float)W0;
+			float U = NoiseFade(FX);
+			float V = NoiseFade(FY);
+			float FadeZ = NoiseFade(FZ);
+			float N00 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0, W0), X0, Y0, FX, FY, FZ, FW, U, V);
+			float N10 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0 + 1, W0), X0, Y0, FX, FY, FZ - 1.0f, FW, U, V);
+			float N01 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0, W0 + 1), X0, Y0, FX, FY, FZ, FW - 1.0f, U, V);
+			float N11 = PerlinNoiseFace(NoiseLayerSeed(Seed, Z0 + 1, W0 + 1), X0, Y0, FX, FY, FZ - 1.0f, FW - 1.0f, U, V);
+			return 0.85f * NoiseLerp(NoiseLerp(N00, N10, FadeZ), NoiseLerp(N01, N11, FadeZ), NoiseFade(FW));
+		}
+
+		// Simplex noise (Perlin 2001, following Gustavson's formulation). Corners are ordered by ranking the
+		// offsets instead of branching, so lane loops stay vectorizable.
+		RCUTILS_FORCEINLINE float SimplexNoise2(float X, float Y, uint32 Seed)
+		{
+			const float F2 = 0.366025403784438647f;
+			const float G2 = 0.211324865405187118f;
+			float Skew = (X + Y) * F2;
+			int32 I = NoiseFloor(X + Skew);
+			int32 J = NoiseFloor(Y + Skew);
+			float Unskew = (float)(I + J) * G2;
+			float X0 = X - ((float)I - Unskew);
+			float Y0 = Y - ((float)J - Unskew);
+
+			int32 I1 = (int32)(X0 > Y0);
+			int32 J1 = 1 - I1;
+			float X1 = X0 - (float)I1 + G2;
+			float Y1 = Y0 - (float)J1 + G2;
+			float X2 = X0 - 1.0f + 2.0f * G2;
+			float Y2 = Y0 - 1.0f + 2.0f * G2;
+
+			float N0 = SimplexFalloff(X0 * X0 + Y0 * Y0) * NoiseGrad(NoiseHash(Seed, I, J), X0, Y0);
+			float N1 = SimplexFalloff(X1 * X1 + Y1 * Y1) * NoiseGrad(NoiseHash(Seed, I + I1, J + J1), X1, Y1);
+			float N2 = SimplexFalloff(X2 * X2 + Y2 * Y2) * NoiseGrad(NoiseHash(Seed, I + 1, J + 1), X2, Y2);
+			return 45.0f * (N0 + N1 + N2);
+		}
+
+		RCUTILS_FORCEINLINE float SimplexNoise3(float X, float Y, float Z, uint32 Seed)
+		{
+			const float F3 = 1.0f / 3.0f;
+			const float G3 = 1.0f / 6.0f;
+			float Skew = (X + Y + Z) * F3;
+			int32 I = NoiseFloor(X + Skew);
+			int32 J = NoiseFloor(Y + Skew);
+			int32 K = NoiseFloor(Z + Skew);
+			float Unskew = (float)(I + J + K) * G3;
+			float X0 = X - ((float)I - Unskew);
+			float Y0 = Y - ((float)J - Unskew);
+			float Z0 = Z - ((float)K - Unskew);
+
+			// Ranks are a permutation of 0..2; ties go to the later axis
+			int32 RankX = (int32)(X0 > Y0) + (int32)(X0 > Z0);
+			int32 RankY = (int32)(Y0 >= X0) + (int32)(Y0 > Z0);
+			int32 RankZ = (int32)(Z0 >= X0) + (int32)(Z0 >= Y0);
+			int32 I1 = (int32)(RankX >= 2), J1 = (int32)(RankY >= 2), K1 = (int32)(RankZ >= 2);
+			int32 I2 = (int32)(RankX >= 1), J2 = (int32)(RankY >= 1), K2 = (int32)(RankZ >= 1);
+
+			float X1 = X0 - (float)I1 + G3, Y1 = Y0 - (float)J1 + G3, Z1 = Z0 - (float)K1 + G3;
+			float X2 = X0 - (float)I2 + 2.0f * G3, Y2 = Y0 - (float)J2 + 2.0f * G3, Z2 = Z0 - (float)K2 + 2.0f * G3;
+			float X3 = X0 - 1.0f + 3.0f * G3, Y3 = Y0 - 1.0f + 3.0f * G3, Z3 = Z0 - 1.0f + 3.0f * G3;
+
+			float N0 = SimplexFalloff(X0 * X0 + Y0 * Y0 + Z0 * Z0) * NoiseGrad(NoiseHash(Seed, I, J, K), X0, Y0, Z0);
+			float N1 = SimplexFalloff(X1 * X1 + Y1 * Y1 + Z1 * Z1) * NoiseGrad(NoiseHash(Seed, I + I1, J + J1, K + K1), X1, Y1, Z1);
+			float N2 = SimplexFalloff(X2 * X2 + Y2 * Y2 + Z2 * Z2) * NoiseGrad(NoiseHash(Seed, I + I2, J + J2, K + K2), X2, Y2, Z2);
+			float N3 = SimplexFalloff(X3 * X3 + Y3 * Y3 + Z3 * Z3) * NoiseGrad(NoiseHash(Seed, I + 1, J + 1, K + 1), X3, Y3, Z3);
+			return 76.0f * (N0 + N1 + N2 + N3);
+		}
+
+		RCUTILS_FORCEINLINE float SimplexNoise4(float X, float Y, float Z, float W, uint32 Seed)
+		{
+			const float F4 = 0.309016994374947424f;
+			const float G4 = 0.138196601125010515f;
+			float Skew = (X + Y + Z + W) * F4;
+			int32 I = NoiseFloor(X + Skew);
+			int32 J = NoiseFloor(Y + Skew);
+			int32 K = NoiseFloor(Z + Skew);
+			int32 L = NoiseFloor(W + Skew);
+			float Unskew = (float)(I + J + K + L) * G4;
+			float X0 = X - ((float)I - Unskew);
+			float Y0 = Y - ((float)J - Unskew);
+			float Z0 = Z - ((float)K - Unskew);
+			float W0 = W - ((float)L - Unskew);
+
+			int32 RankX = (int32)(X0 > Y0) + (int32)(X0 > Z0) + (int32)(X0 > W0);
+			int32 RankY = (int32)(Y0 >= X0) + (int32)(Y0 > Z0) + (int32)(Y0 > W0);
+			int32 RankZ = (int32)(Z0 >= X0) + (int32)(Z0 >= Y0) + (int32)(Z0 > W0);
+			int32 RankW = (int32)(W0 >= X0) + (int32)(W0 >= Y0) + (int32)(W0 >= Z0);
+
+			float Sum = SimplexFalloff(X0 * X0 + Y0 * Y0 + Z0 * Z0 + W0 * W0) * NoiseGrad(NoiseHash(Seed, I, J, K, L), X0, Y0, Z0, W0);
+			for (int32 Corner = 1; Corner < 4; ++Corner)
+			{
+				int32 CI = (int32)(RankX >= 4 - Corner), CJ = (int32)(RankY >= 4 - Corner), CK = (int32)(RankZ >= 4 - Corner), CL = (int32)(RankW >= 4 - Corner);
+				float Offset = (float)Corner * G4;
+				float CX = X0 - (float)CI + Offset, CY = Y0 - (float)CJ + Offset, CZ = Z0 - (float)CK + Offset, CW = W0 - (float)CL + Offset;
+				Sum += SimplexFalloff(CX * CX + CY * CY + CZ * CZ + CW * CW) * NoiseGrad(NoiseHash(Seed, I + CI, J + CJ, K + CK, L + CL), CX, CY, CZ, CW);
+			}
+			float X4 = X0 - 1.0f + 4.0f * G4, Y4 = Y0 - 1.0f + 4.0f * G4, Z4 = Z0 - 1.0f + 4.0f * G4, W4 = W0 - 1.0f + 4.0f * G4;
+			Sum += SimplexFalloff(X4 * X4 + Y4 * Y4 + Z4 * Z4 + W4 * W4) * NoiseGrad(NoiseHash(Seed, I + 1, J + 1, K + 1, L + 1), X4, Y4, Z4, W4);
+			return 62.0f * Sum;
+		}
+	}
+
+	// Single point evaluation, one octave at unit frequency
+	inline float ValueNoise(const FVector2& P, uint32 Seed = 0)
+	{
+		return Internal::ValueNoise2(P.x, P.y, Seed);
+	}
+
+	inline float ValueNoise(const FVector3& P, uint32 Seed = 0)
+	{
+		return Internal::ValueNoise3(P.x, P.y, P.z, Seed);
+	}
+
+	inline float ValueNoise(const FVector4& P, uint32 Seed = 0)
+	{
+		return Internal::ValueNoise4(P.x, P.y, P.z, P.w, Seed);
+	}
+
+	inline float PerlinNoise(const FVector2& P, uint32 Seed = 0)
+	{
+		return Internal::PerlinNoise2(P.x, P.y, Seed);
+	}
+
+	inline float PerlinNoise(const FVector3& P, uint32 Seed = 0)
+	{
+		return Internal::PerlinNoise3(P.x, P.y, P.z, Seed);
+	}
+
+	inline float PerlinNoise(const FVector4& P, uint32 Seed = 0)
+	{
+		return Internal::PerlinNoise4(P.x, P.y, P.z, P.w, Seed);
+	}
+
+	inline float SimplexNoise(const FVector2& P, uint32 Seed = 0)
+	{
+		return Internal::SimplexNoise2(P.x, P.y, Seed);
+	}
+
+	inline float SimplexNoise(const FVector3& P, uint32 Seed = 0)
+	{
+		return Internal::SimplexNoise3(P.x, P.y, P.z, Seed);
+	}
+
+	inline float SimplexNoise(const FVector4& P, uint32 Seed = 0)
+	{
+		return Internal::SimplexNoise4(P.x, P.y, P.z, P.w, Seed);
+	}
+
+	namespace Internal
+	{
+		// One batch of points in structure of arrays form; unused dimensions are ignored
+		struct FNoiseLanes
+		{
+			alignas(32) float X[NoiseLanes];
+			alignas(32) float Y[NoiseLanes];
+			alignas(32) float Z[NoiseLanes];
+			alignas(32) float W[NoiseLanes];
+		};
+
+		struct FValueNoiseFunc
+		{
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, uint32 Seed)
+			{
+				return ValueNoise2(X, Y, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, uint32 Seed)
+			{
+				return ValueNoise3(X, Y, Z, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, float W, uint32 Seed)
+			{
+				return ValueNoise4(X, Y, Z, W, Seed);
+			}
+		};
+
+		struct FPerlinNoiseFunc
+		{
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, uint32 Seed)
+			{
+				return PerlinNoise2(X, Y, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, uint32 Seed)
+			{
+				return PerlinNoise3(X, Y, Z, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, float W, uint32 Seed)
+			{
+				return PerlinNoise4(X, Y, Z, W, Seed);
+			}
+		};
+
+		struct FSimplexNoiseFunc
+		{
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, uint32 Seed)
+			{
+				return SimplexNoise2(X, Y, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, uint32 Seed)
+			{
+				return SimplexNoise3(X, Y, Z, Seed);
+			}
+
+			static RCUTILS_FORCEINLINE float Eval(float X, float Y, float Z, float W, uint32 Seed)
+			{
+				return SimplexNoise4(X, Y, Z, W, Seed);
+			}
+		};
+
+		// Noise function and dimension are template parameters so each octave is one branch free lane loop
+		template <typename TNoiseFunc, uint32 NumDims>
+		struct TNoiseSampler;
+
+		template <typename TNoiseFunc>
+		struct TNoiseSampler<TNoiseFunc, 2>
+		{
+			static void Sample(const FNoiseLanes& P, float Frequency, uint32 Seed, float* Out)
+			{
+				for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+				{
+					Out[Lane] = TNoiseFunc::Eval(P.X[Lane] * Frequency, P.Y[Lane] * Frequency, Seed);
+				}
+			}
+		};
+
+		template <typename TNoiseFunc>
+		struct TNoiseSampler<TNoiseFunc, 3>
+		{
+			static void Sample(const FNoiseLanes& P, float Frequency, uint32 Seed, float* Out)
+			{
+				for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+				{
+					Out[Lane] = TNoiseFunc::Eval(P.X[Lane] * Frequency, P.Y[Lane] * Frequency, P.Z[Lane] * Frequency, Seed);
+				}
+			}
+		};
+
+		template <typename TNoiseFunc>
+		struct TNoiseSampler<TNoiseFunc, 4>
+		{
+			static void Sample(const FNoiseLanes& P, float Frequency, uint32 Seed, float* Out)
+			{
+				for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+				{
+					Out[Lane] = TNoiseFunc::Eval(P.X[Lane] * Frequency, P.Y[Lane] * Frequency, P.Z[Lane] * Frequency, P.W[Lane] * Frequency, Seed);
+				}
+			}
+		};
+
+		template <typename TSampler>
+		inline void FractalNoiseLanes(const FNoiseSettings& Settings, const FNoiseLanes& P, float* Out)
+		{
+			alignas(32) float Octave[NoiseLanes];
+			alignas(32) float Sum[NoiseLanes] = {};
+			float Frequency = Settings.Frequency;
+			float Amplitude = 1.0f;
+			float AmplitudeSum = 0.0f;
+			uint32 NumOctaves = Max(Settings.NumOctaves, 1u);
+			for (uint32 Index = 0; Index < NumOctaves; ++Index)
+			{
+				// Each octave gets its own lattice so coincident lattice points don't line up
+				TSampler::Sample(P, Frequency, Settings.Seed + Index * 0x9E3779B9u, Octave);
+				if (Settings.Fractal == EFractalType::Ridged)
+				{
+					for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+					{
+						float Ridge = 1.0f - fabsf(Octave[Lane]);
+						Sum[Lane] += Amplitude * Ridge * Ridge;
+					}
+				}
+				else
+				{
+					for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+					{
+						Sum[Lane] += Amplitude * Octave[Lane];
+					}
+				}
+				AmplitudeSum += Amplitude;
+				Amplitude *= Settings.Gain;
+				Frequency *= Settings.Lacunarity;
+			}
+
+			float Scale = 1.0f / AmplitudeSum;
+			for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+			{
+				Out[Lane] = Sum[Lane] * Scale;
+			}
+		}
+
+		typedef void (*FFractalNoiseLanesFunc)(const FNoiseSettings&, const FNoiseLanes&, float*);
+
+		template <uint32 NumDims>
+		inline FFractalNoiseLanesFunc GetFractalNoiseLanesFunc(ENoiseType Type)
+		{
+			switch (Type)
+			{
+			case ENoiseType::Value:
+				return &FractalNoiseLanes<TNoiseSampler<FValueNoiseFunc, NumDims>>;
+			case ENoiseType::Perlin:
+				return &FractalNoiseLanes<TNoiseSampler<FPerlinNoiseFunc, NumDims>>;
+			default:
+				return &FractalNoiseLanes<TNoiseSampler<FSimplexNoiseFunc, NumDims>>;
+			}
+		}
+
+		// Points are padded with copies of the last one so the tail goes through the same full width loop
+		template <uint32 NumDims, typename TPoint>
+		inline void EvaluateNoisePoints(const FNoiseSettings& Settings, const TPoint* Points, float* Out, size_t Num)
+		{
+			RCUTILS_PROFILE_FUNCTION();
+			const size_t ChunkSize = 4096;
+			FFractalNoiseLanesFunc Func = GetFractalNoiseLanesFunc<NumDims>(Settings.Type);
+			ParallelFor((uint32)((Num + ChunkSize - 1) / ChunkSize), [&](uint32 Chunk)
+			{
+				size_t End = Min(Num, ((size_t)Chunk + 1) * ChunkSize);
+				for (size_t Begin = (size_t)Chunk * ChunkSize; Begin < End; Begin += NoiseLanes)
+				{
+					FNoiseLanes Lanes;
+					alignas(32) float Result[NoiseLanes];
+					for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+					{
+						const TPoint& Point = Points[Min(Begin + Lane, End - 1)];
+						Lanes.X[Lane] = Point.Values[0];
+						Lanes.Y[Lane] = Point.Values[1];
+						Lanes.Z[Lane] = NumDims > 2 ? Point.Values[NumDims > 2 ? 2 : 0] : 0.0f;
+						Lanes.W[Lane] = NumDims > 3 ? Point.Values[NumDims > 3 ? 3 : 0] : 0.0f;
+					}
+					Func(Settings, Lanes, Result);
+					memcpy(Out + Begin, Result, Min<size_t>(NoiseLanes, End - Begin) * sizeof(float));
+				}
+			}, Settings.NumThreads);
+		}
+
+		// One row of a grid along X; Y, Z and W are fixed for the row
+		inline void EvaluateNoiseRow(const FNoiseSettings& Settings, FFractalNoiseLanesFunc Func, float OriginX, float SpacingX, float Y, float Z, float W, uint32 Width, float* Out)
+		{
+			FNoiseLanes Lanes;
+			alignas(32) float Result[NoiseLanes];
+			for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+			{
+				Lanes.Y[Lane] = Y;
+				Lanes.Z[Lane] = Z;
+				Lanes.W[Lane] = W;
+			}
+			for (uint32 Begin = 0; Begin < Width; Begin += NoiseLanes)
+			{
+				for (uint32 Lane = 0; Lane < NoiseLanes; ++Lane)
+				{
+					Lanes.X[Lane] = OriginX + (float)Min(Begin + Lane, Width - 1) * SpacingX;
+				}
+				Func(Settings, Lanes, Result);
+				memcpy(Out + Begin, Result, Min(NoiseLanes, Width - Begin) * sizeof(float));
+			}
+		}
+	}
+
+	// Fractal noise of the settings' type at each point
+	inline void EvaluateNoise(const FNoiseSettings& Settings, const FVector2* Points, float* Out, size_t Num)
+	{
+		Internal::EvaluateNoisePoints<2>(Settings, Points, Out, Num);
+	}
+
+	inline void EvaluateNoise(const FNoiseSettings& Settings, const FVector3* Points, float* Out, size_t Num)
+	{
+		Internal::EvaluateNoisePoints<3>(Settings, Points, Out, Num);
+	}
+
+	inline void EvaluateNoise(const FNoiseSettings& Settings, const FVector4* Points, float* Out, size_t Num)
+	{
+		Internal::EvaluateNoisePoints<4>(Settings, Points, Out, Num);
+	}
+
+	// Width x Height samples at Origin + (X, Y) * Spacing, row major; rows are split across threads
+	inline void EvaluateNoiseGrid(const FNoiseSettings& Settings, const FVector2& Origin, const FVector2& Spacing, uint32 Width, uint32 Height, float* Out)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (Width == 0)
+		{
+			return;
+		}
+
+		Internal::FFractalNoiseLanesFunc Func = Internal::GetFractalNoiseLanesFunc<2>(Settings.Type);
+		ParallelFor(Height, [&](uint32 Row)
+		{
+			Internal::EvaluateNoiseRow(Settings, Func, Origin.x, Spacing.x, Origin.y + (float)Row * Spacing.y, 0.0f, 0.0f, Width, Out + (size_t)Row * Width);
+		}, Settings.NumThreads);
+	}
+
+	// Width x Height x Depth samples, X fastest
+	inline void EvaluateNoiseGrid(const FNoiseSettings& Settings, const FVector3& Origin, const FVector3& Spacing, uint32 Width, uint32 Height, uint32 Depth, float* Out)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (Width == 0)
+		{
+			return;
+		}
+
+		Internal::FFractalNoiseLanesFunc Func = Internal::GetFractalNoiseLanesFunc<3>(Settings.Type);
+		ParallelFor(Height * Depth, [&](uint32 Row)
+		{
+			Internal::EvaluateNoiseRow(Settings, Func, Origin.x, Spacing.x, Origin.y + (float)(Row % Height) * Spacing.y, Origin.z + (float)(Row / Height) * Spacing.z, 0.0f, Width, Out + (size_t)Row * Width);
+		}, Settings.NumThreads);
+	}
+
+	// 3D slice of 4D noise at Origin.w, e.g. a volume animated over time
+	inline void EvaluateNoiseGrid(const FNoiseSettings& Settings, const FVector4& Origin, const FVector3& Spacing, uint32 Width, uint32 Height, uint32 Depth, float* Out)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (Width == 0)
+		{
+			return;
+		}
+
+		Internal::FFractalNoiseLanesFunc Func = Internal::GetFractalNoiseLanesFunc<4>(Settings.Type);
+		ParallelFor(Height * Depth, [&](uint32 Row)
+		{
+			Internal::EvaluateNoiseRow(Settings, Func, Origin.x, Spacing.x, Origin.y + (float)(Row % Height) * Spacing.y, Origin.z + (float)(Row / Height) * Spacing.z, Origin.w, Width, Out + (size_t)Row * Width);
+		}, Settings.NumThreads);
+	}
+}
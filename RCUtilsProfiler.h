@@ -0,0 +1,313 @@
+#pragma once
+
+#include "RCUtilsBase.h"
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace RCUtils
+{
+	// Raw timestamp in profiler ticks: rdtsc where available, steady_clock nanoseconds otherwise
+	inline uint64 ReadProfilerTimestamp()
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return (uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	struct FProfileEvent
+	{
+		const char* Name;
+		uint64 Start;
+		uint64 End;
+	};
+
+	// Single writer ring of events owned by one thread; once full the oldest events are overwritten. Slots are
+	// atomics so an export can read them while the owner keeps recording (a seqlock with the write index as
+	// the sequence): the reader drops whatever the writer may have reached during the copy.
+	struct FProfileThreadBuffer
+	{
+		enum
+		{
+			Capacity = 1 << 16,
+		};
+
+		FProfileThreadBuffer(uint32 InThreadIndex)
+			: ThreadIndex(InThreadIndex)
+		{
+		}
+
+		void Record(const char* Name, uint64 Start, uint64 End)
+		{
+			// Release stores keep the previous index store ahead of them, so a reader that sees this event's data
+			// also sees the index that marks its slot as being overwritten (plain stores on x86)
+			uint64 Index = WriteIndex.load(std::memory_order_relaxed);
+			FSlot& Slot = Events[Index & (Capacity - 1)];
+			Slot.Name.store(Name, std::memory_order_release);
+			Slot.Start.store(Start, std::memory_order_release);
+			Slot.End.store(End, std::memory_order_release);
+			WriteIndex.store(Index + 1, std::memory_order_release);
+		}
+
+		// Copies out events that were not overwritten while copying
+		void CopyEvents(std::vector<FProfileEvent>& OutEvents) const
+		{
+			uint64 End = WriteIndex.load(std::memory_order_acquire);
+			uint64 Begin = End > Capacity ? End - Capacity : 0;
+			size_t First = OutEvents.size();
+			for (uint64 Index = Begin; Index < End; ++Index)
+			{
+				const FSlot& Slot = Events[Index & (Capacity - 1)];
+				FProfileEvent Event;
+				Event.Name = Slot.Name.load(std::memory_order_acquire);
+				Event.Start = Slot.Start.load(std::memory_order_acquire);
+				Event.End = Slot.End.load(std::memory_order_acquire);
+				OutEvents.push_back(Event);
+			}
+
+			// Anything the writer lapped during the copy may be torn; drop it. That includes the slot of event
+			// EndAfter, which the writer may be filling before it publishes the new index.
+			uint64 EndAfter = WriteIndex.load(std::memory_order_acquire);
+			uint64 FirstValid = EndAfter + 1 > Capacity ? EndAfter + 1 - Capacity : 0;
+			if (FirstValid > Begin)
+			{
+				size_t NumTorn = (size_t)Min<uint64>(FirstValid - Begin, End - Begin);
+				OutEvents.erase(OutEvents.begin() + First, OutEvents.begin() + First + NumTorn);
+			}
+		}
+
+		struct FSlot
+		{
+			std::atomic<const char*> Name;
+			std::atomic<uint64> Start;
+			std::atomic<uint64> End;
+		};
+
+		const uint32 ThreadIndex;
+		std::atomic<uint64> WriteIndex{0};
+		FSlot Events[Capacity];
+	};
+
+	class FProfiler
+	{
+	public:
+		static inline FProfiler& Get()
+		{
+			static FProfiler Instance;
+			return Instance;
+		}
+
+		FProfiler()
+		{
+			CalibrationTimestamp = ReadProfilerTimestamp();
+			CalibrationTime = std::chrono::steady_clock::now();
+		}
+
+		// Buffers are kept alive until process exit so events from finished threads can still be exported. A
+		// finished thread's buffer goes back to a free list and is reused by the next new thread (which then shares
+		// its thread index in the trace), so memory is bounded by the peak number of live profiled threads.
+		FProfileThreadBuffer& GetThreadBuffer()
+		{
+			static thread_local FThreadBufferLease Lease;
+			if (!Lease.Buffer)
+			{
+				std::lock_guard<std::mutex> Lock(BuffersMutex);
+				if (!FreeBuffers.empty())
+				{
+					Lease.Buffer = FreeBuffers.back();
+					FreeBuffers.pop_back();
+				}
+				else
+				{
+					Buffers.emplace_back(new FProfileThreadBuffer((uint32)Buffers.size()));
+					Lease.Buffer = Buffers.back().get();
+				}
+			}
+			return *Lease.Buffer;
+		}
+
+		double GetTicksPerSecond() const
+		{
+			auto Elapsed = std::chrono::steady_clock::now() - CalibrationTime;
+			uint64 ElapsedTicks = ReadProfilerTimestamp() - CalibrationTimestamp;
+			double ElapsedSeconds = std::chrono::duration<double>(Elapsed).count();
+			return ElapsedSeconds > 0.0 ? (double)ElapsedTicks / ElapsedSeconds : 1.0e9;
+		}
+
+		struct FThreadEvents
+		{
+			uint32 ThreadIndex;
+			std::vector<FProfileEvent> Events;
+		};
+
+		std::vector<FThreadEvents> CollectEvents()
+		{
+			std::vector<FThreadEvents> Out;
+			std::lock_guard<std::mutex> Lock(BuffersMutex);
+			for (const auto& Buffer : Buffers)
+			{
+				Out.emplace_back();
+				Out.back().ThreadIndex = Buffer->ThreadIndex;
+				Buffer->CopyEvents(Out.back().Events);
+			}
+			return Out;
+		}
+
+		// chrome://tracing / Perfetto JSON
+		bool WriteChromeTrace(const char* Filename)
+		{
+			std::vector<FThreadEvents> Threads = CollectEvents();
+			double MicrosecondsPerTick = 1.0e6 / GetTicksPerSecond();
+
+			FILE* File = OpenStdioFile(Filename, "wb");
+			if (!File)
+			{
+				return false;
+			}
+
+			fputs("{\"traceEvents\":[\n", File);
+			bool bFirst = true;
+			for (const auto& Thread : Threads)
+			{
+				for (const auto& Event : Thread.Events)
+				{
+					fprintf(File, "%s{\"name\":\"", bFirst ? "" : ",\n");
+					for (const char* Char = Event.Name; *Char; ++Char)
+					{
+						if (*Char == '"' || *Char == '\\')
+						{
+							fputc('\\', File);
+						}
+						fputc(*Char, File);
+					}
+					// Signed, so a timestamp from a core whose counter lags the calibrating one can't wrap
+					double Start = (double)(int64)(Event.Start - CalibrationTimestamp) * MicrosecondsPerTick;
+					double Duration = (double)(Event.End - Event.Start) * MicrosecondsPerTick;
+					fprintf(File, "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", Thread.ThreadIndex, Start, Duration);
+					bFirst = false;
+				}
+			}
+			fputs("\n]}\n", File);
+			fclose(File);
+			return true;
+		}
+
+		// Compact format:
+		//	uint32 Magic ('RCPF'), uint32 Version, double TicksPerSecond, uint64 BaseTimestamp
+		//	uint32 NumNames, then per name: uint16 Length + chars
+		//	uint32 NumEvents, then per event: uint32 NameIndex, uint32 ThreadIndex, uint64 Start, uint64 Duration
+		bool WriteBinaryTrace(const char* Filename)
+		{
+			std::vector<FThreadEvents> Threads = CollectEvents();
+
+			std::map<const char*, uint32> NameIndices;
+			std::vector<const char*> Names;
+			uint32 NumEvents = 0;
+			for (const auto& Thread : Threads)
+			{
+				for (const auto& Event : Thread.Events)
+				{
+					if (NameIndices.find(Event.Name) == NameIndices.end())
+					{
+						NameIndices[Event.Name] = (uint32)Names.size();
+						Names.push_back(Event.Name);
+					}
+					++NumEvents;
+				}
+			}
+
+			FILE* File = OpenStdioFile(Filename, "wb");
+			if (!File)
+			{
+				return false;
+			}
+
+			const uint32 Magic = 0x46504352;
+			const uint32 Version = 1;
+			double TicksPerSecond = GetTicksPerSecond();
+			fwrite(&Magic, sizeof(Magic), 1, File);
+			fwrite(&Version, sizeof(Version), 1, File);
+			fwrite(&TicksPerSecond, sizeof(TicksPerSecond), 1, File);
+			fwrite(&CalibrationTimestamp, sizeof(CalibrationTimestamp), 1, File);
+
+			uint32 NumNames = (uint32)Names.size();
+			fwrite(&NumNames, sizeof(NumNames), 1, File);
+			for (const char* Name : Names)
+			{
+				uint16 Length = (uint16)Min<size_t>(strlen(Name), 0xffff);
+				fwrite(&Length, sizeof(Length), 1, File);
+				fwrite(Name, 1, Length, File);
+			}
+
+			fwrite(&NumEvents, sizeof(NumEvents), 1, File);
+			for (const auto& Thread : Threads)
+			{
+				for (const auto& Event : Thread.Events)
+				{
+					uint32 Header[2] = { NameIndices[Event.Name], Thread.ThreadIndex };
+					uint64 Times[2] = { Event.Start, Event.End - Event.Start };
+					fwrite(Header, sizeof(Header), 1, File);
+					fwrite(Times, sizeof(Times), 1, File);
+				}
+			}
+
+			fclose(File);
+			return true;
+		}
+
+	protected:
+		// Hands the thread's buffer back when the thread exits
+		struct FThreadBufferLease
+		{
+			~FThreadBufferLease()
+			{
+				if (Buffer)
+				{
+					FProfiler& Profiler = FProfiler::Get();
+					std::lock_guard<std::mutex> Lock(Profiler.BuffersMutex);
+					Profiler.FreeBuffers.push_back(Buffer);
+				}
+			}
+
+			FProfileThreadBuffer* Buffer = nullptr;
+		};
+
+		uint64 CalibrationTimestamp;
+		std::chrono::steady_clock::time_point CalibrationTime;
+		std::mutex BuffersMutex;
+		std::vector<std::unique_ptr<FProfileThreadBuffer>> Buffers;
+		std::vector<FProfileThreadBuffer*> FreeBuffers;
+	};
+
+	struct FProfileScope
+	{
+		// The buffer is fetched before the start time is read, so the profiler (and its calibration) exists
+		// before the first timestamp is taken
+		FProfileScope(const char* InName)
+			: Buffer(FProfiler::Get().GetThreadBuffer())
+			, Name(InName)
+			, Start(ReadProfilerTimestamp())
+		{
+		}
+
+		~FProfileScope()
+		{
+			Buffer.Record(Name, Start, ReadProfilerTimestamp());
+		}
+
+		FProfileThreadBuffer& Buffer;
+		const char* Name;
+		uint64 Start;
+	};
+}
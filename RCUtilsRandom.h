@@ -0,0 +1,592 @@
+#pragma once
+
+#include "RCUtilsHash.h"
+#include "RCUtilsMath.h"
+#include "RCUtilsThread.h"
+#include <chrono>
+
+// Pseudo random numbers for sampling, jitter and Monte Carlo work. None of these are suitable for cryptography.
+//
+//	FRandom          xoshiro256**: scalar, 2^256 period, the general purpose choice
+//	FRandomX4        four xoshiro128++ generators in SSE2 lanes for filling arrays
+//	FCounterRandom   Philox4x32-10: value i is a pure function of (seed, stream, i), so any element can be
+//	                 computed on any thread in any order
+//
+// Every generator takes a seed and a stream id; different streams of one seed are independent, so give each
+// thread, task or object its own stream. For runs that reproduce regardless of the thread count, key the
+// randomness on the work item rather than the thread: use FCounterRandom, or the Parallel* functions below,
+// which are deterministic by construction.
+namespace RCUtils
+{
+	namespace Internal
+	{
+		inline uint64 SplitMix64(uint64& State)
+		{
+			State += 0x9E3779B97F4A7C15ull;
+			return HashMix64(State);
+		}
+
+		// Top 24 bits, so every value is exact and 1.0 can't be produced
+		inline float UInt32ToUnitFloat(uint32 Value)
+		{
+			return (float)(Value >> 8) * (1.0f / 16777216.0f);
+		}
+
+		// Distinct (seed, stream) pairs must not share a state, so the stream goes through the mixer too
+		inline uint64 GetStreamSeed(uint64 Seed, uint64 Stream)
+		{
+			return HashMix64(Seed ^ HashMix64(Stream + 0x632BE59BD9B4E019ull));
+		}
+	}
+
+	class FRandom
+	{
+	public:
+		explicit FRandom(uint64 Seed = 0, uint64 Stream = 0)
+		{
+			SetSeed(Seed, Stream);
+		}
+
+		void SetSeed(uint64 Seed, uint64 Stream = 0)
+		{
+			uint64 SplitMixState = Internal::GetStreamSeed(Seed, Stream);
+			for (uint32 Index = 0; Index < 4; ++Index)
+			{
+				State[Index] = Internal::SplitMix64(SplitMixState);
+			}
+		}
+
+		uint64 NextUInt64()
+		{
+			uint64 Result = Internal::RotateLeft64(State[1] * 5, 7) * 9;
+			uint64 Shifted = State[1] << 17;
+			State[2] ^= State[0];
+			State[3] ^= State[1];
+			State[1] ^= State[2];
+			State[0] ^= State[3];
+			State[2] ^= Shifted;
+			State[3] = Internal::RotateLeft64(State[3], 45);
+			return Result;
+		}
+
+		uint32 NextUInt32()
+		{
+			return (uint32)(NextUInt64() >> 32);
+		}
+
+		// [0, Bound) by multiply-shift; the bias is below Bound / 2^32
+		uint32 NextUInt32(uint32 Bound)
+		{
+			return (uint32)(((uint64)NextUInt32() * Bound) >> 32);
+		}
+
+		// [0, 1)
+		float NextFloat()
+		{
+			return Internal::UInt32ToUnitFloat(NextUInt32());
+		}
+
+		float NextFloat(float InMin, float InMax)
+		{
+			return InMin + (InMax - InMin) * NextFloat();
+		}
+
+		// [0, 1) with 53 bits
+		double NextDouble()
+		{
+			return (double)(NextUInt64() >> 11) * (1.0 / 9007199254740992.0);
+		}
+
+		// Advances by 2^128 steps: calling it N times on copies of one generator gives N non overlapping sequences
+		void Jump()
+		{
+			static const uint64 JumpPolynomial[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+			uint64 Jumped[4] = {};
+			for (uint32 Word = 0; Word < 4; ++Word)
+			{
+				for (uint32 Bit = 0; Bit < 64; ++Bit)
+				{
+					if (JumpPolynomial[Word] & (1ull << Bit))
+					{
+						for (uint32 Index = 0; Index < 4; ++Index)
+						{
+							Jumped[Index] ^= State[Index];
+						}
+					}
+					NextUInt64();
+				}
+			}
+			memcpy(State, Jumped, sizeof(State));
+		}
+
+		void Fill(uint32* Out, size_t Num)
+		{
+			for (size_t Index = 0; Index < Num; ++Index)
+			{
+				Out[Index] = NextUInt32();
+			}
+		}
+
+		void Fill(float* Out, size_t Num, float InMin = 0.0f, float InMax = 1.0f)
+		{
+			for (size_t Index = 0; Index < Num; ++Index)
+			{
+				Out[Index] = NextFloat(InMin, InMax);
+			}
+		}
+
+	protected:
+		uint64 State[4];
+	};
+
+	// Four independent xoshiro128++ generators, one per SSE2 lane; Fill writes the lanes interleaved. Scalar
+	// builds run the same lanes in a loop and produce identical output.
+	class FRandomX4
+	{
+	public:
+		explicit FRandomX4(uint64 Seed = 0, uint64 Stream = 0)
+		{
+			SetSeed(Seed, Stream);
+		}
+
+		void SetSeed(uint64 Seed, uint64 Stream = 0)
+		{
+			uint64 SplitMixState = Internal::GetStreamSeed(Seed, Stream);
+			for (uint32 Word = 0; Word < 4; ++Word)
+			{
+				for (uint32 Lane = 0; Lane < 4; Lane += 2)
+				{
+					uint64 Value = Internal::SplitMix64(SplitMixState);
+					State[Word][Lane] = (uint32)Value;
+					State[Word][Lane + 1] = (uint32)(Value >> 32);
+				}
+			}
+		}
+
+		// Four values, one per lane
+		void Next4(uint32 (&Out)[4])
+		{
+#if RCUTILS_FAST_MATH_SSE
+			__m128i S0, S1, S2, S3;
+			Load(S0, S1, S2, S3);
+			_mm_storeu_si128((__m128i*)Out, Step(S0, S1, S2, S3));
+			Store(S0, S1, S2, S3);
+#else
+			for (uint32 Lane = 0; Lane < 4; ++Lane)
+			{
+				uint32 Sum = State[0][Lane] + State[3][Lane];
+				Out[Lane] = ((Sum << 7) | (Sum >> 25)) + State[0][Lane];
+				uint32 Shifted = State[1][Lane] << 9;
+				State[2][Lane] ^= State[0][Lane];
+				State[3][Lane] ^= State[1][Lane];
+				State[1][Lane] ^= State[2][Lane];
+				State[0][Lane] ^= State[3][Lane];
+				State[2][Lane] ^= Shifted;
+				State[3][Lane] = (State[3][Lane] << 11) | (State[3][Lane] >> 21);
+			}
+#endif
+		}
+
+		void Fill(uint32* Out, size_t Num)
+		{
+			size_t Index = 0;
+#if RCUTILS_FAST_MATH_SSE
+			__m128i S0, S1, S2, S3;
+			Load(S0, S1, S2, S3);
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				_mm_storeu_si128((__m128i*)(Out + Index), Step(S0, S1, S2, S3));
+			}
+			Store(S0, S1, S2, S3);
+#endif
+			FillTail(Out, Index, Num);
+		}
+
+		// [InMin, InMax)
+		void Fill(float* Out, size_t Num, float InMin = 0.0f, float InMax = 1.0f)
+		{
+			size_t Index = 0;
+			float Scale = (InMax - InMin) * (1.0f / 16777216.0f);
+#if RCUTILS_FAST_MATH_SSE
+			__m128i S0, S1, S2, S3;
+			Load(S0, S1, S2, S3);
+			__m128 Scale4 = _mm_set1_ps(Scale);
+			__m128 Min4 = _mm_set1_ps(InMin);
+			for (; Index + 4 <= Num; Index += 4)
+			{
+				__m128 Value = _mm_cvtepi32_ps(_mm_srli_epi32(Step(S0, S1, S2, S3), 8));
+				_mm_storeu_ps(Out + Index, _mm_add_ps(_mm_mul_ps(Value, Scale4), Min4));
+			}
+			Store(S0, S1, S2, S3);
+#endif
+			// One step of four at a time; scalar builds take the whole range through here
+			while (Index < Num)
+			{
+				uint32 Values[4];
+				Next4(Values);
+				for (uint32 Lane = 0; Lane < 4 && Index < Num; ++Lane, ++Index)
+				{
+					Out[Index] = (float)(Values[Lane] >> 8) * Scale + InMin;
+				}
+			}
+		}
+
+	protected:
+		// Leftovers (and scalar builds) take whole steps so the sequence doesn't depend on how it was chunked
+		void FillTail(uint32* Out, size_t Index, size_t Num)
+		{
+			while (Index < Num)
+			{
+				uint32 Values[4];
+				Next4(Values);
+				for (uint32 Lane = 0; Lane < 4 && Index < Num; ++Lane, ++Index)
+				{
+					Out[Index] = Values[Lane];
+				}
+			}
+		}
+
+#if RCUTILS_FAST_MATH_SSE
+		void Load(__m128i& S0, __m128i& S1, __m128i& S2, __m128i& S3) const
+		{
+			S0 = _mm_loadu_si128((const __m128i*)State[0]);
+			S1 = _mm_loadu_si128((const __m128i*)State[1]);
+			S2 = _mm_loadu_si128((const __m128i*)State[2]);
+			S3 = _mm_loadu_si128((const __m128i*)State[3]);
+		}
+
+		void Store(__m128i S0, __m128i S1, __m128i S2, __m128i S3)
+		{
+			_mm_storeu_si128((__m128i*)State[0], S0);
+			_mm_storeu_si128((__m128i*)State[1], S1);
+			_mm_storeu_si128((__m128i*)State[2], S2);
+			_mm_storeu_si128((__m128i*)State[3], S3);
+		}
+
+		static __m128i RotateLeft(__m128i Value, int Shift)
+		{
+			return _mm_or_si128(_mm_slli_epi32(Value, Shift), _mm_srli_epi32(Value, 32 - Shift));
+		}
+
+		static __m128i Step(__m128i& S0, __m128i& S1, __m128i& S2, __m128i& S3)
+		{
+			__m128i Result = _mm_add_epi32(RotateLeft(_mm_add_epi32(S0, S3), 7), S0);
+			__m128i Shifted = _mm_slli_epi32(S1, 9);
+			S2 = _mm_xor_si128(S2, S0);
+			S3 = _mm_xor_si128(S3, S1);
+			S1 = _mm_xor_si128(S1, S2);
+			S0 = _mm_xor_si128(S0, S3);
+			S2 = _mm_xor_si128(S2, Shifted);
+			S3 = RotateLeft(S3, 11);
+			return Result;
+		}
+#endif
+
+		// [Word][Lane]
+		uint32 State[4][4];
+	};
+
+	// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"). Each 128 bit counter
+	// (element block, stream) encrypts to four values under the 64 bit seed.
+	class FCounterRandom
+	{
+	public:
+		explicit FCounterRandom(uint64 Seed = 0, uint64 Stream = 0)
+			: Key{ (uint32)Seed, (uint32)(Seed >> 32) }
+			, StreamLow((uint32)Stream)
+			, StreamHigh((uint32)(Stream >> 32))
+		{
+		}
+
+		static void Philox(const uint32 (&Counter)[4], const uint32 (&Key)[2], uint32 (&Out)[4])
+		{
+			uint32 C0 = Counter[0], C1 = Counter[1], C2 = Counter[2], C3 = Counter[3];
+			uint32 K0 = Key[0], K1 = Key[1];
+			for (uint32 Round = 0; Round < 10; ++Round)
+			{
+				uint64 Product0 = (uint64)0xD2511F53u * C0;
+				uint64 Product1 = (uint64)0xCD9E8D57u * C2;
+				uint32 Next0 = (uint32)(Product1 >> 32) ^ C1 ^ K0;
+				uint32 Next2 = (uint32)(Product0 >> 32) ^ C3 ^ K1;
+				C1 = (uint32)Product1;
+				C3 = (uint32)Product0;
+				C0 = Next0;
+				C2 = Next2;
+				K0 += 0x9E3779B9u;
+				K1 += 0xBB67AE85u;
+			}
+			Out[0] = C0;
+			Out[1] = C1;
+			Out[2] = C2;
+			Out[3] = C3;
+		}
+
+		uint32 GetUInt32(uint64 Index) const
+		{
+			uint32 Block[4];
+			GetBlock(Index >> 2, Block);
+			return Block[Index & 3];
+		}
+
+		float GetFloat(uint64 Index) const
+		{
+			return Internal::UInt32ToUnitFloat(GetUInt32(Index));
+		}
+
+		// Values FirstIndex .. FirstIndex + Num - 1
+		void Fill(uint32* Out, size_t Num, uint64 FirstIndex = 0) const
+		{
+			size_t Index = 0;
+			while (Index < Num && ((FirstIndex + Index) & 3) != 0)
+			{
+				Out[Index] = GetUInt32(FirstIndex + Index);
+				++Index;
+			}
+
+			uint64 BlockIndex = (FirstIndex + Index) >> 2;
+#if RCUTILS_FAST_MATH_SSE
+			for (; Index + 16 <= Num; Index += 16, BlockIndex += 4)
+			{
+				GetBlocks4(BlockIndex, Out + Index);
+			}
+#endif
+			for (; Index + 4 <= Num; Index += 4, ++BlockIndex)
+			{
+				uint32 Block[4];
+				GetBlock(BlockIndex, Block);
+				memcpy(Out + Index, Block, sizeof(Block));
+			}
+			for (; Index < Num; ++Index)
+			{
+				Out[Index] = GetUInt32(FirstIndex + Index);
+			}
+		}
+
+		void Fill(float* Out, size_t Num, float InMin = 0.0f, float InMax = 1.0f, uint64 FirstIndex = 0) const
+		{
+			const size_t ChunkSize = 256;
+			uint32 Bits[ChunkSize];
+			float Scale = (InMax - InMin) * (1.0f / 16777216.0f);
+			for (size_t Begin = 0; Begin < Num; Begin += ChunkSize)
+			{
+				size_t Count = Min(ChunkSize, Num - Begin);
+				Fill(Bits, Count, FirstIndex + Begin);
+				for (size_t Index = 0; Index < Count; ++Index)
+				{
+					Out[Begin + Index] = (float)(int32)(Bits[Index] >> 8) * Scale + InMin;
+				}
+			}
+		}
+
+	protected:
+		void GetBlock(uint64 BlockIndex, uint32 (&Out)[4]) const
+		{
+			uint32 Counter[4] = { (uint32)BlockIndex, (uint32)(BlockIndex >> 32), StreamLow, StreamHigh };
+			Philox(Counter, Key, Out);
+		}
+
+#if RCUTILS_FAST_MATH_SSE
+		// Four 32x32 -> 64 multiplies with one constant; _mm_mul_epu32 only covers the even lanes
+		static void MulHiLo(__m128i A, __m128i Multiplier, __m128i& OutHi, __m128i& OutLo)
+		{
+			__m128i Even = _mm_mul_epu32(A, Multiplier);
+			__m128i Odd = _mm_mul_epu32(_mm_srli_epi64(A, 32), Multiplier);
+			__m128i Low = _mm_unpacklo_epi32(Even, Odd);
+			__m128i High = _mm_unpackhi_epi32(Even, Odd);
+			OutLo = _mm_unpacklo_epi64(Low, High);
+			OutHi = _mm_unpackhi_epi64(Low, High);
+		}
+
+		// Blocks BlockIndex .. BlockIndex + 3 with one block per lane, transposed back to sequential order
+		void GetBlocks4(uint64 BlockIndex, uint32* Out) const
+		{
+			__m128i C0 = _mm_set_epi32((int)(uint32)(BlockIndex + 3), (int)(uint32)(BlockIndex + 2), (int)(uint32)(BlockIndex + 1), (int)(uint32)BlockIndex);
+			__m128i C1 = _mm_set_epi32((int)(uint32)((BlockIndex + 3) >> 32), (int)(uint32)((BlockIndex + 2) >> 32), (int)(uint32)((BlockIndex + 1) >> 32), (int)(uint32)(BlockIndex >> 32));
+			__m128i C2 = _mm_set1_epi32((int)StreamLow);
+			__m128i C3 = _mm_set1_epi32((int)StreamHigh);
+			const __m128i M0 = _mm_set1_epi32((int)0xD2511F53u);
+			const __m128i M1 = _mm_set1_epi32((int)0xCD9E8D57u);
+			uint32 K0 = Key[0];
+			uint32 K1 = Key[1];
+			for (uint32 Round = 0; Round < 10; ++Round)
+			{
+				__m128i Hi0, Lo0, Hi1, Lo1;
+				MulHiLo(C0, M0, Hi0, Lo0);
+				MulHiLo(C2, M1, Hi1, Lo1);
+				C0 = _mm_xor_si128(_mm_xor_si128(Hi1, C1), _mm_set1_epi32((int)K0));
+				C2 = _mm_xor_si128(_mm_xor_si128(Hi0, C3), _mm_set1_epi32((int)K1));
+				C1 = Lo1;
+				C3 = Lo0;
+				K0 += 0x9E3779B9u;
+				K1 += 0xBB67AE85u;
+			}
+
+			__m128i T0 = _mm_unpacklo_epi32(C0, C1);
+			__m128i T1 = _mm_unpacklo_epi32(C2, C3);
+			__m128i T2 = _mm_unpackhi_epi32(C0, C1);
+			__m128i T3 = _mm_unpackhi_epi32(C2, C3);
+			_mm_storeu_si128((__m128i*)Out, _mm_unpacklo_epi64(T0, T1));
+			_mm_storeu_si128((__m128i*)(Out + 4), _mm_unpackhi_epi64(T0, T1));
+			_mm_storeu_si128((__m128i*)(Out + 8), _mm_unpacklo_epi64(T2, T3));
+			_mm_storeu_si128((__m128i*)(Out + 12), _mm_unpackhi_epi64(T2, T3));
+		}
+#endif
+
+		uint32 Key[2];
+		uint32 StreamLow;
+		uint32 StreamHigh;
+	};
+
+	// Per thread generator for code that just wants fast random numbers. Seeded from the clock and the
+	// thread, so runs are not reproducible; see the top of the file for the deterministic alternatives.
+	inline FRandom& GetThreadRandom()
+	{
+		thread_local FRandom Random(
+			(uint64)std::chrono::high_resolution_clock::now().time_since_epoch().count(),
+			(uint64)std::hash<std::thread::id>()(std::this_thread::get_id()));
+		return Random;
+	}
+
+	// Same output as FCounterRandom(Seed, Stream).Fill for any thread count
+	inline void ParallelFillRandom(float* Out, size_t Num, uint64 Seed, uint64 Stream = 0, float InMin = 0.0f, float InMax = 1.0f, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		const size_t ChunkSize = 64 * 1024;
+		FCounterRandom Random(Seed, Stream);
+		ParallelFor((uint32)((Num + ChunkSize - 1) / ChunkSize), [&](uint32 Chunk)
+		{
+			size_t Begin = (size_t)Chunk * ChunkSize;
+			Random.Fill(Out + Begin, Min(ChunkSize, Num - Begin), InMin, InMax, Begin);
+		}, NumThreads);
+	}
+
+	inline void ParallelFillRandom(uint32* Out, size_t Num, uint64 Seed, uint64 Stream = 0, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		const size_t ChunkSize = 64 * 1024;
+		FCounterRandom Random(Seed, Stream);
+		ParallelFor((uint32)((Num + ChunkSize - 1) / ChunkSize), [&](uint32 Chunk)
+		{
+			size_t Begin = (size_t)Chunk * ChunkSize;
+			Random.Fill(Out + Begin, Min(ChunkSize, Num - Begin), Begin);
+		}, NumThreads);
+	}
+
+	// Maps uniform [0, 1)^2 samples to a domain; hemispheres are around +Z and disks lie in the XY plane (z = 0).
+	// Unit sphere, hemisphere and disk are uniform in area; cosine weighted has pdf cos(theta) / pi.
+	enum class ESampleWarp : uint8
+	{
+		UnitDisk,
+		UnitSphere,
+		Hemisphere,
+		CosineHemisphere,
+	};
+
+	inline FVector3 WarpSample(ESampleWarp Warp, float U1, float U2)
+	{
+		float Sin, Cos;
+		FastSinCos(U2 * (2.0f * (float)M_PI), Sin, Cos);
+		float Z = 0.0f;
+		float Radius = 0.0f;
+		switch (Warp)
+		{
+		case ESampleWarp::UnitDisk:
+			Radius = sqrtf(U1);
+			break;
+		case ESampleWarp::UnitSphere:
+			Z = 1.0f - 2.0f * U1;
+			Radius = sqrtf(Max(0.0f, 1.0f - Z * Z));
+			break;
+		case ESampleWarp::Hemisphere:
+			Z = U1;
+			Radius = sqrtf(Max(0.0f, 1.0f - Z * Z));
+			break;
+		case ESampleWarp::CosineHemisphere:
+			Radius = sqrtf(U1);
+			Z = sqrtf(Max(0.0f, 1.0f - U1));
+			break;
+		}
+		return FVector3(Radius * Cos, Radius * Sin, Z);
+	}
+
+	namespace Internal
+	{
+		// Uniforms, angles and sin/cos go through stack arrays in chunks so each stage runs as a SIMD batch
+		template <typename TRandom>
+		inline void GenerateSamplesImpl(ESampleWarp Warp, TRandom& Random, FVector3* Out, size_t Num, uint64 FirstIndex)
+		{
+			const size_t ChunkSize = 256;
+			float U1[ChunkSize];
+			float U2[ChunkSize];
+			float Sin[ChunkSize];
+			float Cos[ChunkSize];
+			for (size_t Begin = 0; Begin < Num; Begin += ChunkSize)
+			{
+				size_t Count = Min(ChunkSize, Num - Begin);
+				Random.Fill(U1, Count, 0.0f, 1.0f, FirstIndex + Begin * 2);
+				Random.Fill(U2, Count, 0.0f, 2.0f * (float)M_PI, FirstIndex + Begin * 2 + Count);
+				FastSinCos(U2, Sin, Cos, Count);
+				for (size_t Index = 0; Index < Count; ++Index)
+				{
+					float U = U1[Index];
+					float Z = 0.0f;
+					float RadiusSq = U;
+					if (Warp == ESampleWarp::UnitSphere)
+					{
+						Z = 1.0f - 2.0f * U;
+						RadiusSq = 1.0f - Z * Z;
+					}
+					else if (Warp == ESampleWarp::Hemisphere)
+					{
+						Z = U;
+						RadiusSq = 1.0f - Z * Z;
+					}
+					else if (Warp == ESampleWarp::CosineHemisphere)
+					{
+						Z = sqrtf(Max(0.0f, 1.0f - U));
+					}
+					float Radius = sqrtf(Max(0.0f, RadiusSq));
+					Out[Begin + Index] = FVector3(Radius * Cos[Index], Radius * Sin[Index], Z);
+				}
+			}
+		}
+
+		// Lets the sequential generators share the counter based signature
+		template <typename TRandom>
+		struct TSequentialFill
+		{
+			TRandom& Random;
+
+			void Fill(float* Out, size_t Num, float InMin, float InMax, uint64)
+			{
+				Random.Fill(Out, Num, InMin, InMax);
+			}
+		};
+	}
+
+	inline void GenerateSamples(ESampleWarp Warp, FRandomX4& Random, FVector3* Out, size_t Num)
+	{
+		Internal::TSequentialFill<FRandomX4> Fill{ Random };
+		Internal::GenerateSamplesImpl(Warp, Fill, Out, Num, 0);
+	}
+
+	inline void GenerateSamples(ESampleWarp Warp, FRandom& Random, FVector3* Out, size_t Num)
+	{
+		Internal::TSequentialFill<FRandom> Fill{ Random };
+		Internal::GenerateSamplesImpl(Warp, Fill, Out, Num, 0);
+	}
+
+	// Deterministic: sample i only depends on (Seed, Stream, i), whatever the thread count
+	inline void ParallelGenerateSamples(ESampleWarp Warp, FVector3* Out, size_t Num, uint64 Seed, uint64 Stream = 0, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		const size_t ChunkSize = 16 * 1024;
+		FCounterRandom Random(Seed, Stream);
+		ParallelFor((uint32)((Num + ChunkSize - 1) / ChunkSize), [&](uint32 Chunk)
+		{
+			size_t Begin = (size_t)Chunk * ChunkSize;
+			FCounterRandom ChunkRandom = Random;
+			Internal::GenerateSamplesImpl(Warp, ChunkRandom, Out + Begin, Min(ChunkSize, Num - Begin), (uint64)Begin * 2);
+		}, NumThreads);
+	}
+}
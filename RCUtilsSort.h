@@ -0,0 +1,228 @@
+#pragma once
+
+#include "RCUtilsMemory.h"
+#include "RCUtilsThread.h"
+#include <algorithm>
+#include <string.h>
+#include <type_traits>
+
+namespace RCUtils
+{
+	// Maps keys to unsigned integers with the same ordering
+	template <typename TKey>
+	struct TRadixKeyTraits
+	{
+		static_assert(std::is_unsigned<TKey>::value, "Radix sort keys must be unsigned integers, float or double");
+		typedef TKey TBits;
+
+		static TBits ToBits(TKey Key)
+		{
+			return Key;
+		}
+	};
+
+	template <>
+	struct TRadixKeyTraits<float>
+	{
+		typedef uint32 TBits;
+
+		// Flip all bits of negatives and only the sign bit of positives; -0 sorts before +0 and NaNs go to the ends
+		static TBits ToBits(float Key)
+		{
+			uint32 Bits;
+			memcpy(&Bits, &Key, sizeof(Bits));
+			return Bits ^ ((uint32)((int32)Bits >> 31) | 0x80000000u);
+		}
+	};
+
+	template <>
+	struct TRadixKeyTraits<double>
+	{
+		typedef uint64 TBits;
+
+		static TBits ToBits(double Key)
+		{
+			uint64 Bits;
+			memcpy(&Bits, &Key, sizeof(Bits));
+			return Bits ^ ((uint64)((int64)Bits >> 63) | 0x8000000000000000ull);
+		}
+	};
+
+	namespace Internal
+	{
+		const uint32 RadixBits = 8;
+		const uint32 RadixSize = 1 << RadixBits;
+
+		// Dummy payload so key only sorts share the code path; the stores compile out
+		struct FRadixNoValue
+		{
+		};
+
+		template <typename TKey, typename TValue, bool bHasValues>
+		void RadixSortImpl(TKey* Keys, TValue* Values, size_t Num, TKey* TempKeys, TValue* TempValues, uint32 NumThreads)
+		{
+			typedef TRadixKeyTraits<TKey> FTraits;
+			const uint32 NumPasses = sizeof(typename FTraits::TBits);
+
+			// Every chunk needs enough keys to amortize its 256 entry histogram
+			NumThreads = NumThreads ? NumThreads : GetNumHardwareThreads();
+			size_t NumChunks = Max<size_t>(1, Min<size_t>(NumThreads, Num / 65536));
+			size_t ChunkSize = (Num + NumChunks - 1) / NumChunks;
+
+			// One read of the input gives the digit counts of every pass, used to skip passes where all keys share a digit
+			TTaggedVector<size_t, EMemoryTag::Math> ChunkCounts(NumChunks * NumPasses * RadixSize, 0);
+			ParallelFor((uint32)NumChunks, [&](uint32 Chunk)
+			{
+				size_t* Counts = &ChunkCounts[Chunk * NumPasses * RadixSize];
+				size_t End = Min(Num, (Chunk + 1) * ChunkSize);
+				for (size_t Index = Chunk * ChunkSize; Index < End; ++Index)
+				{
+					typename FTraits::TBits Bits = FTraits::ToBits(Keys[Index]);
+					for (uint32 Pass = 0; Pass < NumPasses; ++Pass)
+					{
+						++Counts[Pass * RadixSize + ((Bits >> (Pass * RadixBits)) & (RadixSize - 1))];
+					}
+				}
+			}, NumThreads);
+
+			TTaggedVector<size_t, EMemoryTag::Math> Offsets(NumChunks * RadixSize);
+			TKey* SrcKeys = Keys;
+			TKey* DstKeys = TempKeys;
+			TValue* SrcValues = Values;
+			TValue* DstValues = TempValues;
+			bool bScattered = false;
+			for (uint32 Pass = 0; Pass < NumPasses; ++Pass)
+			{
+				size_t Totals[RadixSize] = {};
+				for (size_t Chunk = 0; Chunk < NumChunks; ++Chunk)
+				{
+					for (uint32 Digit = 0; Digit < RadixSize; ++Digit)
+					{
+						Totals[Digit] += ChunkCounts[(Chunk * NumPasses + Pass) * RadixSize + Digit];
+					}
+				}
+
+				bool bSkip = false;
+				for (uint32 Digit = 0; Digit < RadixSize; ++Digit)
+				{
+					bSkip |= Totals[Digit] == Num;
+				}
+				if (bSkip)
+				{
+					continue;
+				}
+
+				// Per chunk counts are only valid for the original order, so after the first scatter recount this pass
+				uint32 Shift = Pass * RadixBits;
+				if (bScattered)
+				{
+					ParallelFor((uint32)NumChunks, [&](uint32 Chunk)
+					{
+						size_t* Counts = &Offsets[Chunk * RadixSize];
+						memset(Counts, 0, RadixSize * sizeof(size_t));
+						size_t End = Min(Num, (Chunk + 1) * ChunkSize);
+						for (size_t Index = Chunk * ChunkSize; Index < End; ++Index)
+						{
+							++Counts[(FTraits::ToBits(SrcKeys[Index]) >> Shift) & (RadixSize - 1)];
+						}
+					}, NumThreads);
+				}
+				else
+				{
+					for (size_t Chunk = 0; Chunk < NumChunks; ++Chunk)
+					{
+						memcpy(&Offsets[Chunk * RadixSize], &ChunkCounts[(Chunk * NumPasses + Pass) * RadixSize], RadixSize * sizeof(size_t));
+					}
+				}
+
+				// Digit major, chunk minor prefix sum keeps the sort stable
+				size_t Sum = 0;
+				for (uint32 Digit = 0; Digit < RadixSize; ++Digit)
+				{
+					for (size_t Chunk = 0; Chunk < NumChunks; ++Chunk)
+					{
+						size_t Count = Offsets[Chunk * RadixSize + Digit];
+						Offsets[Chunk * RadixSize + Digit] = Sum;
+						Sum += Count;
+					}
+				}
+
+				ParallelFor((uint32)NumChunks, [&](uint32 Chunk)
+				{
+					size_t* Cursor = &Offsets[Chunk * RadixSize];
+					size_t End = Min(Num, (Chunk + 1) * ChunkSize);
+					for (size_t Index = Chunk * ChunkSize; Index < End; ++Index)
+					{
+						size_t Dest = Cursor[(FTraits::ToBits(SrcKeys[Index]) >> Shift) & (RadixSize - 1)]++;
+						DstKeys[Dest] = SrcKeys[Index];
+						if (bHasValues)
+						{
+							DstValues[Dest] = SrcValues[Index];
+						}
+					}
+				}, NumThreads);
+
+				std::swap(SrcKeys, DstKeys);
+				std::swap(SrcValues, DstValues);
+				bScattered = true;
+			}
+
+			if (SrcKeys != Keys)
+			{
+				ParallelFor((uint32)NumChunks, [&](uint32 Chunk)
+				{
+					size_t Begin = Chunk * ChunkSize;
+					size_t End = Min(Num, Begin + ChunkSize);
+					if (Begin < End)
+					{
+						memcpy(Keys + Begin, SrcKeys + Begin, (End - Begin) * sizeof(TKey));
+						if (bHasValues)
+						{
+							memcpy((void*)(Values + Begin), SrcValues + Begin, (End - Begin) * sizeof(TValue));
+						}
+					}
+				}, NumThreads);
+			}
+		}
+	}
+
+	// Stable LSD radix sort (8 bit digits) of unsigned integer, float or double keys with a trivially copyable
+	// payload. Temp buffers must hold Num elements each. Passes where every key has the same digit are
+	// skipped, so e.g. small integer keys only pay for their significant bytes.
+	template <typename TKey, typename TValue>
+	inline void RadixSort(TKey* Keys, TValue* Values, size_t Num, TKey* TempKeys, TValue* TempValues, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (Num > 1)
+		{
+			Internal::RadixSortImpl<TKey, TValue, true>(Keys, Values, Num, TempKeys, TempValues, NumThreads);
+		}
+	}
+
+	template <typename TKey>
+	inline void RadixSort(TKey* Keys, size_t Num, TKey* TempKeys, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		if (Num > 1)
+		{
+			Internal::RadixSortImpl<TKey, Internal::FRadixNoValue, false>(Keys, nullptr, Num, TempKeys, nullptr, NumThreads);
+		}
+	}
+
+	// Allocating convenience versions
+	template <typename TKey, typename TValue>
+	inline void RadixSort(std::vector<TKey>& Keys, std::vector<TValue>& Values, uint32 NumThreads = 0)
+	{
+		checkAlways(Keys.size() == Values.size());
+		TTaggedVector<TKey, EMemoryTag::Math> TempKeys(Keys.size());
+		TTaggedVector<TValue, EMemoryTag::Math> TempValues(Values.size());
+		RadixSort(Keys.data(), Values.data(), Keys.size(), TempKeys.data(), TempValues.data(), NumThreads);
+	}
+
+	template <typename TKey>
+	inline void RadixSort(std::vector<TKey>& Keys, uint32 NumThreads = 0)
+	{
+		TTaggedVector<TKey, EMemoryTag::Math> TempKeys(Keys.size());
+		RadixSort(Keys.data(), Keys.size(), TempKeys.data(), NumThreads);
+	}
+}
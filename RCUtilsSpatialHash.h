@@ -0,0 +1,352 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsThread.h"
+#include <algorithm>
+#include <memory>
+
+// Sparse grid over points: cells are hashed into a power of two table and the points of each slot are
+// stored contiguously (counting sort), so a cell lookup is one hash plus a linear scan. Distinct cells
+// can share a slot; every point keeps its cell so queries skip those cheaply.
+class FSpatialHashGrid
+{
+public:
+	// Rebuilds from scratch; Positions are copied in bucket order so queries touch contiguous memory.
+	// With more than one thread the order of points inside a bucket is not deterministic.
+	void Build(const FVector3* Positions, uint32 NumPoints, float InCellSize, uint32 NumThreads = 0)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		checkAlways(InCellSize > 0.0f);
+		CellSize = InCellSize;
+		InvCellSize = 1.0f / InCellSize;
+		NumThreads = NumThreads ? NumThreads : RCUtils::GetNumHardwareThreads();
+
+		// ~2 slots per point keeps collisions rare without blowing up the table
+		uint32 TableSize = (uint32)RoundUpToPowerOfTwo(Max<uint64>(NumPoints * 2ull, 64));
+		TableMask = TableSize - 1;
+
+		// Table and slot scratch are kept between builds and only grow
+		if (Scratch.CountsCapacity < TableSize + 1)
+		{
+			Scratch.Counts.reset(new std::atomic<uint32>[TableSize + 1]);
+			Scratch.CountsCapacity = TableSize + 1;
+		}
+		std::atomic<uint32>* Counts = Scratch.Counts.get();
+		std::vector<uint32>& Slots = Scratch.Slots;
+		Slots.resize(NumPoints);
+		SortedCells.resize(NumPoints);
+		SortedPositions.resize(NumPoints);
+		SortedIndices.resize(NumPoints);
+		const uint32 ChunkSize = 16384;
+		uint32 NumChunks = (NumPoints + ChunkSize - 1) / ChunkSize;
+		uint32 NumTableChunks = (TableSize + ChunkSize) / ChunkSize;
+		RCUtils::ParallelFor(NumTableChunks, [&](uint32 Chunk)
+		{
+			uint32 End = Min(TableSize + 1, (Chunk + 1) * ChunkSize);
+			for (uint32 Index = Chunk * ChunkSize; Index < End; ++Index)
+			{
+				Counts[Index].store(0, std::memory_order_relaxed);
+			}
+		}, NumThreads);
+
+		// Histogram, plus the bounds of the occupied cells per chunk
+		std::vector<FIntVector3> ChunkMinCells(NumChunks);
+		std::vector<FIntVector3> ChunkMaxCells(NumChunks);
+		RCUtils::ParallelFor(NumChunks, [&](uint32 Chunk)
+		{
+			uint32 End = Min(NumPoints, (Chunk + 1) * ChunkSize);
+			FIntVector3 ChunkMin = GetCell(Positions[Chunk * ChunkSize]);
+			FIntVector3 ChunkMax = ChunkMin;
+			for (uint32 Index = Chunk * ChunkSize; Index < End; ++Index)
+			{
+				FIntVector3 Cell = GetCell(Positions[Index]);
+				ChunkMin = FIntVector3::Min(ChunkMin, Cell);
+				ChunkMax = FIntVector3::Max(ChunkMax, Cell);
+				uint32 Slot = GetSlot(Cell);
+				Slots[Index] = Slot;
+				Counts[Slot].fetch_add(1, std::memory_order_relaxed);
+			}
+			ChunkMinCells[Chunk] = ChunkMin;
+			ChunkMaxCells[Chunk] = ChunkMax;
+		}, NumThreads);
+
+		MinCell = FIntVector3::GetZero();
+		MaxCell = FIntVector3::GetZero();
+		for (uint32 Chunk = 0; Chunk < NumChunks; ++Chunk)
+		{
+			MinCell = Chunk ? FIntVector3::Min(MinCell, ChunkMinCells[Chunk]) : ChunkMinCells[Chunk];
+			MaxCell = Chunk ? FIntVector3::Max(MaxCell, ChunkMaxCells[Chunk]) : ChunkMaxCells[Chunk];
+		}
+
+		// Exclusive prefix sum; CellStart[Slot + 1] - CellStart[Slot] is the bucket size
+		CellStart.resize(TableSize + 1);
+		uint32 Sum = 0;
+		for (uint32 Slot = 0; Slot <= TableSize; ++Slot)
+		{
+			uint32 Count = Counts[Slot].load(std::memory_order_relaxed);
+			CellStart[Slot] = Sum;
+			Counts[Slot].store(Sum, std::memory_order_relaxed);
+			Sum += Count;
+		}
+
+		// Scatter
+		RCUtils::ParallelFor(NumChunks, [&](uint32 Chunk)
+		{
+			uint32 End = Min(NumPoints, (Chunk + 1) * ChunkSize);
+			for (uint32 Index = Chunk * ChunkSize; Index < End; ++Index)
+			{
+				uint32 Dest = Counts[Slots[Index]].fetch_add(1, std::memory_order_relaxed);
+				SortedIndices[Dest] = Index;
+				SortedPositions[Dest] = Positions[Index];
+				SortedCells[Dest] = GetCell(Positions[Index]);
+			}
+		}, NumThreads);
+	}
+
+	void Clear()
+	{
+		Scratch = FBuildScratch();
+		CellStart.clear();
+		SortedCells.clear();
+		SortedPositions.clear();
+		SortedIndices.clear();
+	}
+
+	// Calls Func(PointIndex, DistanceSquared) for every point within Radius of Center
+	template <typename TFunc>
+	void ForEachInRadius(const FVector3& Center, float Radius, TFunc&& Func) const
+	{
+		if (CellStart.empty())
+		{
+			return;
+		}
+
+		float RadiusSq = Radius * Radius;
+		FIntVector3 MinCell = GetCell(Center - FVector3(Radius, Radius, Radius));
+		FIntVector3 MaxCell = GetCell(Center + FVector3(Radius, Radius, Radius));
+		FIntVector3 Cell;
+		for (Cell.z = MinCell.z; Cell.z <= MaxCell.z; ++Cell.z)
+		{
+			for (Cell.y = MinCell.y; Cell.y <= MaxCell.y; ++Cell.y)
+			{
+				for (Cell.x = MinCell.x; Cell.x <= MaxCell.x; ++Cell.x)
+				{
+					uint32 Slot = GetSlot(Cell);
+					for (uint32 Index = CellStart[Slot]; Index < CellStart[Slot + 1]; ++Index)
+					{
+						FVector3 Delta = SortedPositions[Index] - Center;
+						float DistanceSq = FVector3::Dot(Delta, Delta);
+						if (DistanceSq <= RadiusSq && SortedCells[Index] == Cell)
+						{
+							Func(SortedIndices[Index], DistanceSq);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Appends the indices of the points within Radius of Center (unordered)
+	void QueryRadius(const FVector3& Center, float Radius, std::vector<uint32>& OutIndices) const
+	{
+		ForEachInRadius(Center, Radius, [&](uint32 Index, float)
+		{
+			OutIndices.push_back(Index);
+		});
+	}
+
+	// Up to K nearest points within MaxRadius, sorted by distance. Searches shells of cells outwards and
+	// stops once no unvisited cell can be closer than the current K-th neighbour. Shells are clipped to the
+	// occupied cells and stop at MaxRadius; if they would visit more cells than there are points, the
+	// remaining search is a linear scan instead.
+	void QueryKNearest(const FVector3& Center, uint32 K, float MaxRadius, std::vector<uint32>& OutIndices, std::vector<float>* OutDistancesSq = nullptr) const
+	{
+		OutIndices.clear();
+		if (OutDistancesSq)
+		{
+			OutDistancesSq->clear();
+		}
+		if (CellStart.empty() || K == 0)
+		{
+			return;
+		}
+
+		// Max heap on distance holding the best K so far
+		std::vector<std::pair<float, uint32>> Heap;
+		Heap.reserve(K + 1);
+		float MaxRadiusSq = MaxRadius * MaxRadius;
+		auto Consider = [&](uint32 Index, float DistanceSq)
+		{
+			if (Heap.size() < K)
+			{
+				Heap.push_back(std::make_pair(DistanceSq, SortedIndices[Index]));
+				std::push_heap(Heap.begin(), Heap.end());
+			}
+			else if (DistanceSq < Heap.front().first)
+			{
+				std::pop_heap(Heap.begin(), Heap.end());
+				Heap.back() = std::make_pair(DistanceSq, SortedIndices[Index]);
+				std::push_heap(Heap.begin(), Heap.end());
+			}
+		};
+
+		// Occupied cells relative to the center cell, in 64 bits so far away queries can't overflow
+		FIntVector3 CenterCell = GetCell(Center);
+		int64 Lo[3];
+		int64 Hi[3];
+		int64 ExtentRing = 0;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Lo[Axis] = (int64)MinCell.Values[Axis] - CenterCell.Values[Axis];
+			Hi[Axis] = (int64)MaxCell.Values[Axis] - CenterCell.Values[Axis];
+			ExtentRing = Max(ExtentRing, Max(-Lo[Axis], Hi[Axis]));
+		}
+
+		// Points within MaxRadius are at most ceil(MaxRadius / CellSize) cells away; one more covers rounding
+		float RadiusRings = ceilf(MaxRadius * InvCellSize) + 1.0f;
+		ExtentRing = Min<int64>(ExtentRing, 0x7ffffffe);
+		int32 MaxRing = (int32)(RadiusRings < (float)ExtentRing ? (int64)RadiusRings : ExtentRing);
+		uint64 NumVisitedCells = 0;
+		for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+		{
+			int32 MinZ = (int32)Max<int64>(-Ring, Lo[2]);
+			int32 MaxZ = (int32)Min<int64>(Ring, Hi[2]);
+			int32 MinY = (int32)Max<int64>(-Ring, Lo[1]);
+			int32 MaxY = (int32)Min<int64>(Ring, Hi[1]);
+			int32 MinX = (int32)Max<int64>(-Ring, Lo[0]);
+			int32 MaxX = (int32)Min<int64>(Ring, Hi[0]);
+
+			// Sparse grids: past this many cells, checking every point is cheaper
+			uint64 Side = 2ull * Ring + 1;
+			NumVisitedCells += Ring ? Side * Side * Side - (Side - 2) * (Side - 2) * (Side - 2) : 1;
+			if (NumVisitedCells > SortedIndices.size())
+			{
+				Heap.clear();
+				for (uint32 Index = 0; Index < (uint32)SortedIndices.size(); ++Index)
+				{
+					FVector3 Delta = SortedPositions[Index] - Center;
+					float DistanceSq = FVector3::Dot(Delta, Delta);
+					if (DistanceSq <= MaxRadiusSq)
+					{
+						Consider(Index, DistanceSq);
+					}
+				}
+				break;
+			}
+
+			for (int32 Z = MinZ; Z <= MaxZ; ++Z)
+			{
+				for (int32 Y = MinY; Y <= MaxY; ++Y)
+				{
+					// Only the surface of the cube of cells is new on this ring
+					bool bInterior = Abs(Z) != Ring && Abs(Y) != Ring;
+					for (int32 X = bInterior ? -Ring : MinX; X <= MaxX; X += bInterior ? 2 * Ring : 1)
+					{
+						if (X < MinX)
+						{
+							continue;
+						}
+
+						FIntVector3 Cell = CenterCell + FIntVector3(X, Y, Z);
+						uint32 Slot = GetSlot(Cell);
+						for (uint32 Index = CellStart[Slot]; Index < CellStart[Slot + 1]; ++Index)
+						{
+							FVector3 Delta = SortedPositions[Index] - Center;
+							float DistanceSq = FVector3::Dot(Delta, Delta);
+							if (DistanceSq <= MaxRadiusSq && SortedCells[Index] == Cell)
+							{
+								Consider(Index, DistanceSq);
+							}
+						}
+					}
+				}
+			}
+
+			// Cells beyond this ring are at least Ring cell widths away from Center
+			float Reach = Ring * CellSize;
+			if (Heap.size() == K && Heap.front().first <= Reach * Reach)
+			{
+				break;
+			}
+		}
+
+		std::sort_heap(Heap.begin(), Heap.end());
+		for (const std::pair<float, uint32>& Entry : Heap)
+		{
+			OutIndices.push_back(Entry.second);
+			if (OutDistancesSq)
+			{
+				OutDistancesSq->push_back(Entry.first);
+			}
+		}
+	}
+
+	FIntVector3 GetCell(const FVector3& P) const
+	{
+		return FIntVector3::FloorToCell(P, InvCellSize);
+	}
+
+	uint32 GetSlot(const FIntVector3& Cell) const
+	{
+		return Cell.GetHash() & TableMask;
+	}
+
+	// Points in Cell's slot; may include points of other cells that collide, check GetSortedCells()
+	void GetBucket(const FIntVector3& Cell, uint32& OutBegin, uint32& OutEnd) const
+	{
+		uint32 Slot = GetSlot(Cell);
+		OutBegin = CellStart.empty() ? 0 : CellStart[Slot];
+		OutEnd = CellStart.empty() ? 0 : CellStart[Slot + 1];
+	}
+
+	uint32 GetNumPoints() const
+	{
+		return (uint32)SortedIndices.size();
+	}
+
+	float GetCellSize() const
+	{
+		return CellSize;
+	}
+
+	const std::vector<uint32>& GetSortedIndices() const
+	{
+		return SortedIndices;
+	}
+
+	const std::vector<FVector3>& GetSortedPositions() const
+	{
+		return SortedPositions;
+	}
+
+	const std::vector<FIntVector3>& GetSortedCells() const
+	{
+		return SortedCells;
+	}
+
+protected:
+	// Build scratch; copies of a grid start without it
+	struct FBuildScratch
+	{
+		FBuildScratch() = default;
+		FBuildScratch(const FBuildScratch&) {}
+		FBuildScratch(FBuildScratch&&) = default;
+		FBuildScratch& operator=(const FBuildScratch&) { return *this; }
+		FBuildScratch& operator=(FBuildScratch&&) = default;
+
+		std::unique_ptr<std::atomic<uint32>[]> Counts;
+		uint32 CountsCapacity = 0;
+		std::vector<uint32> Slots;
+	};
+
+	float CellSize = 1.0f;
+	float InvCellSize = 1.0f;
+	uint32 TableMask = 0;
+	FIntVector3 MinCell = FIntVector3::GetZero();
+	FIntVector3 MaxCell = FIntVector3::GetZero();
+	std::vector<uint32> CellStart;
+	std::vector<FIntVector3> SortedCells;
+	std::vector<FVector3> SortedPositions;
+	std::vector<uint32> SortedIndices;
+	FBuildScratch Scratch;
+};
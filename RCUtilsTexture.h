@@ -0,0 +1,913 @@
+#pragma once
+
+#include "RCUtilsMath.h"
+#include "RCUtilsThread.h"
+#include <string.h>
+
+namespace RCUtils
+{
+	enum class ETextureFormat : uint8
+	{
+		BC1,	// RGB, 4 bpp
+		BC3,	// RGBA, 8 bpp (BC1 color + BC4 alpha)
+		BC4,	// R, 4 bpp
+		BC5,	// RG, 8 bpp
+		BC7,	// RGBA, 8 bpp
+	};
+
+	// Fast: mode 6 with endpoints on the principal axis. Normal: adds a least squares refinement pass and
+	// tries mode 5 on blocks with varying alpha. High: exhaustive index search, two refinement passes and
+	// mode 5 with all channel rotations.
+	enum class EBC7Quality : uint8
+	{
+		Fast,
+		Normal,
+		High,
+	};
+
+	// Tightly or loosely packed RGBA8 pixels
+	struct FImageView
+	{
+		const uint8* Pixels = nullptr;
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 RowPitch = 0;
+	};
+
+	struct FTextureCompressSettings
+	{
+		EBC7Quality BC7Quality = EBC7Quality::Normal;
+
+		// 0 = one per hardware thread
+		uint32 NumThreads = 0;
+	};
+
+	inline uint32 GetBlockBytes(ETextureFormat Format)
+	{
+		return (Format == ETextureFormat::BC1 || Format == ETextureFormat::BC4) ? 8 : 16;
+	}
+
+	inline size_t GetCompressedMipSize(ETextureFormat Format, uint32 Width, uint32 Height)
+	{
+		return (size_t)((Width + 3) / 4) * ((Height + 3) / 4) * GetBlockBytes(Format);
+	}
+
+	// Mips are stored back to back, largest first; OutMipOffsets (NumMips entries) is optional
+	inline size_t GetCompressedMipChainSize(ETextureFormat Format, uint32 Width, uint32 Height, uint32 NumMips, size_t* OutMipOffsets = nullptr)
+	{
+		size_t Size = 0;
+		for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+		{
+			if (OutMipOffsets)
+			{
+				OutMipOffsets[Mip] = Size;
+			}
+			Size += GetCompressedMipSize(Format, Max(Width >> Mip, 1u), Max(Height >> Mip, 1u));
+		}
+		return Size;
+	}
+
+	namespace Internal
+	{
+		// 128 bit little endian bit stream as used by BC7
+		struct FBlockBitWriter
+		{
+			uint8 Bytes[16] = {};
+			uint32 Position = 0;
+
+			void Write(uint32 Value, uint32 NumBits)
+			{
+				for (uint32 Bit = 0; Bit < NumBits; ++Bit, ++Position)
+				{
+					Bytes[Position >> 3] |= (uint8)(((Value >> Bit) & 1) << (Position & 7));
+				}
+			}
+		};
+
+		// Mean and principal axis (power iteration on the covariance) of 16 points with up to 4 channels
+		inline void ComputePrincipalAxis(const float (&Points)[16][4], uint32 NumChannels, float (&OutMean)[4], float (&OutAxis)[4])
+		{
+			for (uint32 Channel = 0; Channel < 4; ++Channel)
+			{
+				float Sum = 0.0f;
+				for (uint32 Index = 0; Index < 16; ++Index)
+				{
+					Sum += Points[Index][Channel];
+				}
+				OutMean[Channel] = Sum / 16.0f;
+			}
+
+			float Covariance[4][4] = {};
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				for (uint32 Row = 0; Row < NumChannels; ++Row)
+				{
+					for (uint32 Col = Row; Col < NumChannels; ++Col)
+					{
+						Covariance[Row][Col] += (Points[Index][Row] - OutMean[Row]) * (Points[Index][Col] - OutMean[Col]);
+					}
+				}
+			}
+			for (uint32 Row = 0; Row < NumChannels; ++Row)
+			{
+				for (uint32 Col = 0; Col < Row; ++Col)
+				{
+					Covariance[Row][Col] = Covariance[Col][Row];
+				}
+			}
+
+			// Start from the widest channel so the iteration never begins orthogonal to the answer
+			float Axis[4] = {};
+			uint32 Widest = 0;
+			for (uint32 Channel = 1; Channel < NumChannels; ++Channel)
+			{
+				Widest = Covariance[Channel][Channel] > Covariance[Widest][Widest] ? Channel : Widest;
+			}
+			Axis[Widest] = 1.0f;
+			for (uint32 Iteration = 0; Iteration < 6; ++Iteration)
+			{
+				float Next[4] = {};
+				float LengthSq = 0.0f;
+				for (uint32 Row = 0; Row < NumChannels; ++Row)
+				{
+					for (uint32 Col = 0; Col < NumChannels; ++Col)
+					{
+						Next[Row] += Covariance[Row][Col] * Axis[Col];
+					}
+					LengthSq += Next[Row] * Next[Row];
+				}
+				if (LengthSq < 1e-12f)
+				{
+					break;
+				}
+
+				float InvLength = 1.0f / sqrtf(LengthSq);
+				for (uint32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					Axis[Channel] = Next[Channel] * InvLength;
+				}
+			}
+			memcpy(OutAxis, Axis, sizeof(Axis));
+		}
+
+		// Endpoints at the extreme projections onto the principal axis
+		inline void FitEndpoints(const float (&Points)[16][4], uint32 NumChannels, float (&OutE0)[4], float (&OutE1)[4])
+		{
+			float Mean[4];
+			float Axis[4];
+			ComputePrincipalAxis(Points, NumChannels, Mean, Axis);
+			float MinT = FLT_MAX;
+			float MaxT = -FLT_MAX;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				float T = 0.0f;
+				for (uint32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					T += (Points[Index][Channel] - Mean[Channel]) * Axis[Channel];
+				}
+				MinT = Min(MinT, T);
+				MaxT = Max(MaxT, T);
+			}
+
+			for (uint32 Channel = 0; Channel < 4; ++Channel)
+			{
+				OutE0[Channel] = Min(Max(Mean[Channel] + Axis[Channel] * MinT, 0.0f), 255.0f);
+				OutE1[Channel] = Min(Max(Mean[Channel] + Axis[Channel] * MaxT, 0.0f), 255.0f);
+			}
+		}
+
+		// Least squares endpoints for fixed indices; Weights[Index] is the blend toward E1 in [0, 1]
+		inline bool RefineEndpoints(const float (&Points)[16][4], uint32 NumChannels, const uint8 (&Indices)[16], const float* Weights, float (&OutE0)[4], float (&OutE1)[4])
+		{
+			float AA = 0.0f;
+			float AB = 0.0f;
+			float BB = 0.0f;
+			float AX[4] = {};
+			float BX[4] = {};
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				float B = Weights[Indices[Index]];
+				float A = 1.0f - B;
+				AA += A * A;
+				AB += A * B;
+				BB += B * B;
+				for (uint32 Channel = 0; Channel < NumChannels; ++Channel)
+				{
+					AX[Channel] += A * Points[Index][Channel];
+					BX[Channel] += B * Points[Index][Channel];
+				}
+			}
+
+			float Determinant = AA * BB - AB * AB;
+			if (fabsf(Determinant) < 1e-6f)
+			{
+				return false;
+			}
+
+			float InvDeterminant = 1.0f / Determinant;
+			for (uint32 Channel = 0; Channel < NumChannels; ++Channel)
+			{
+				OutE0[Channel] = Min(Max((AX[Channel] * BB - BX[Channel] * AB) * InvDeterminant, 0.0f), 255.0f);
+				OutE1[Channel] = Min(Max((BX[Channel] * AA - AX[Channel] * AB) * InvDeterminant, 0.0f), 255.0f);
+			}
+			return true;
+		}
+
+		inline void LoadBlock(const FImageView& Image, uint32 BlockX, uint32 BlockY, uint8 (&OutBlock)[16][4])
+		{
+			// Partial edge blocks repeat the last row / column
+			for (uint32 Y = 0; Y < 4; ++Y)
+			{
+				uint32 SrcY = Min(BlockY * 4 + Y, Image.Height - 1);
+				const uint8* Row = Image.Pixels + (size_t)SrcY * Image.RowPitch;
+				for (uint32 X = 0; X < 4; ++X)
+				{
+					uint32 SrcX = Min(BlockX * 4 + X, Image.Width - 1);
+					memcpy(OutBlock[Y * 4 + X], Row + SrcX * 4, 4);
+				}
+			}
+		}
+
+		inline uint16 PackRGB565(const float (&Color)[4])
+		{
+			uint32 R = (uint32)(Color[0] * (31.0f / 255.0f) + 0.5f);
+			uint32 G = (uint32)(Color[1] * (63.0f / 255.0f) + 0.5f);
+			uint32 B = (uint32)(Color[2] * (31.0f / 255.0f) + 0.5f);
+			return (uint16)((R << 11) | (G << 5) | B);
+		}
+
+		inline void UnpackRGB565(uint16 Packed, int32 (&OutColor)[3])
+		{
+			uint32 R = (Packed >> 11) & 31;
+			uint32 G = (Packed >> 5) & 63;
+			uint32 B = Packed & 31;
+			OutColor[0] = (int32)((R << 3) | (R >> 2));
+			OutColor[1] = (int32)((G << 2) | (G >> 4));
+			OutColor[2] = (int32)((B << 3) | (B >> 2));
+		}
+
+		// Four color mode indices and squared error for a pair of 565 endpoints
+		inline uint32 EvaluateBC1(const uint8 (&Block)[16][4], uint16& InOutColor0, uint16& InOutColor1, uint8 (&OutIndices)[16])
+		{
+			if (InOutColor0 < InOutColor1)
+			{
+				std::swap(InOutColor0, InOutColor1);
+			}
+
+			int32 Palette[4][3];
+			UnpackRGB565(InOutColor0, Palette[0]);
+			UnpackRGB565(InOutColor1, Palette[1]);
+			for (uint32 Channel = 0; Channel < 3; ++Channel)
+			{
+				Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+				Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+			}
+
+			// Equal endpoints select three color mode, where only index 0 is safe to use
+			uint32 NumEntries = InOutColor0 == InOutColor1 ? 1 : 4;
+			uint32 TotalError = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				uint32 BestError = 0xffffffff;
+				for (uint32 Entry = 0; Entry < NumEntries; ++Entry)
+				{
+					int32 DR = (int32)Block[Index][0] - Palette[Entry][0];
+					int32 DG = (int32)Block[Index][1] - Palette[Entry][1];
+					int32 DB = (int32)Block[Index][2] - Palette[Entry][2];
+					uint32 Error = (uint32)(DR * DR + DG * DG + DB * DB);
+					if (Error < BestError)
+					{
+						BestError = Error;
+						OutIndices[Index] = (uint8)Entry;
+					}
+				}
+				TotalError += BestError;
+			}
+			return TotalError;
+		}
+
+		inline void EncodeBC1(const uint8 (&Block)[16][4], uint8* Out, uint32 NumRefinements = 2)
+		{
+			float Points[16][4];
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				for (uint32 Channel = 0; Channel < 4; ++Channel)
+				{
+					Points[Index][Channel] = Channel < 3 ? (float)Block[Index][Channel] : 0.0f;
+				}
+			}
+
+			// Inset by 1/16 of the range: the extremes are rarely worth an endpoint of their own
+			float E0[4], E1[4];
+			FitEndpoints(Points, 3, E0, E1);
+			for (uint32 Channel = 0; Channel < 3; ++Channel)
+			{
+				float Inset = (E1[Channel] - E0[Channel]) / 16.0f;
+				E0[Channel] += Inset;
+				E1[Channel] -= Inset;
+			}
+
+			uint16 Color0 = PackRGB565(E1);
+			uint16 Color1 = PackRGB565(E0);
+			uint8 Indices[16];
+			uint32 Error = EvaluateBC1(Block, Color0, Color1, Indices);
+
+			static const float Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+			for (uint32 Refinement = 0; Refinement < NumRefinements && Error > 0; ++Refinement)
+			{
+				if (!RefineEndpoints(Points, 3, Indices, Weights, E0, E1))
+				{
+					break;
+				}
+
+				uint16 NewColor0 = PackRGB565(E0);
+				uint16 NewColor1 = PackRGB565(E1);
+				uint8 NewIndices[16];
+				uint32 NewError = EvaluateBC1(Block, NewColor0, NewColor1, NewIndices);
+				if (NewError >= Error)
+				{
+					break;
+				}
+				Color0 = NewColor0;
+				Color1 = NewColor1;
+				Error = NewError;
+				memcpy(Indices, NewIndices, sizeof(Indices));
+			}
+
+			uint32 Bits = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				Bits |= (uint32)Indices[Index] << (Index * 2);
+			}
+			memcpy(Out, &Color0, 2);
+			memcpy(Out + 2, &Color1, 2);
+			memcpy(Out + 4, &Bits, 4);
+		}
+
+		inline void GetBC4Palette(uint8 A0, uint8 A1, int32 (&OutPalette)[8])
+		{
+			OutPalette[0] = A0;
+			OutPalette[1] = A1;
+			if (A0 > A1)
+			{
+				for (int32 Index = 2; Index < 8; ++Index)
+				{
+					OutPalette[Index] = ((8 - Index) * A0 + (Index - 1) * A1) / 7;
+				}
+			}
+			else
+			{
+				for (int32 Index = 2; Index < 6; ++Index)
+				{
+					OutPalette[Index] = ((6 - Index) * A0 + (Index - 1) * A1) / 5;
+				}
+				OutPalette[6] = 0;
+				OutPalette[7] = 255;
+			}
+		}
+
+		inline uint32 EvaluateBC4(const uint8 (&Values)[16], uint8 A0, uint8 A1, uint64& OutBits)
+		{
+			int32 Palette[8];
+			GetBC4Palette(A0, A1, Palette);
+			uint32 TotalError = 0;
+			OutBits = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				uint32 BestError = 0xffffffff;
+				uint32 BestEntry = 0;
+				for (uint32 Entry = 0; Entry < 8; ++Entry)
+				{
+					int32 Delta = (int32)Values[Index] - Palette[Entry];
+					uint32 Error = (uint32)(Delta * Delta);
+					if (Error < BestError)
+					{
+						BestError = Error;
+						BestEntry = Entry;
+					}
+				}
+				TotalError += BestError;
+				OutBits |= (uint64)BestEntry << (Index * 3);
+			}
+			return TotalError;
+		}
+
+		// Tries the eight value mode over the full range and the six value mode (explicit 0 and 255) over the
+		// values in between, keeping the better one
+		inline void EncodeBC4(const uint8 (&Values)[16], uint8* Out)
+		{
+			uint8 MinValue = 255;
+			uint8 MaxValue = 0;
+			uint8 MinInner = 255;
+			uint8 MaxInner = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				MinValue = Min(MinValue, Values[Index]);
+				MaxValue = Max(MaxValue, Values[Index]);
+				if (Values[Index] != 0 && Values[Index] != 255)
+				{
+					MinInner = Min(MinInner, Values[Index]);
+					MaxInner = Max(MaxInner, Values[Index]);
+				}
+			}
+
+			uint8 A0 = MaxValue;
+			uint8 A1 = MinValue;
+			uint64 Bits;
+			uint32 Error = EvaluateBC4(Values, A0, A1, Bits);
+			if (Error > 0 && MinInner <= MaxInner && (MinValue == 0 || MaxValue == 255))
+			{
+				uint64 SixBits;
+				uint32 SixError = EvaluateBC4(Values, MinInner, MaxInner, SixBits);
+				if (SixError < Error)
+				{
+					A0 = MinInner;
+					A1 = MaxInner;
+					Bits = SixBits;
+				}
+			}
+
+			Out[0] = A0;
+			Out[1] = A1;
+			for (uint32 Byte = 0; Byte < 6; ++Byte)
+			{
+				Out[2 + Byte] = (uint8)(Bits >> (Byte * 8));
+			}
+		}
+
+		inline void ExtractChannel(const uint8 (&Block)[16][4], uint32 Channel, uint8 (&OutValues)[16])
+		{
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				OutValues[Index] = Block[Index][Channel];
+			}
+		}
+
+		const int32 BC7Weights2[4] = { 0, 21, 43, 64 };
+		const int32 BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+		inline int32 BC7Interpolate(int32 E0, int32 E1, int32 Weight)
+		{
+			return ((64 - Weight) * E0 + Weight * E1 + 32) >> 6;
+		}
+
+		// Nearest palette entry per pixel over the channel range [FirstChannel, FirstChannel + NumChannels)
+		inline uint32 SelectBC7Indices(const uint8 (&Block)[16][4], uint32 FirstChannel, uint32 NumChannels, const int32 (&E0)[4], const int32 (&E1)[4], const int32* Weights, uint32 NumWeights, bool bExhaustive, uint8 (&OutIndices)[16])
+		{
+			int32 Palette[16][4];
+			for (uint32 Entry = 0; Entry < NumWeights; ++Entry)
+			{
+				for (uint32 Channel = FirstChannel; Channel < FirstChannel + NumChannels; ++Channel)
+				{
+					Palette[Entry][Channel] = BC7Interpolate(E0[Channel], E1[Channel], Weights[Entry]);
+				}
+			}
+
+			// Projection onto the endpoint segment gives the right index or a neighbour of it
+			float Direction[4] = {};
+			float LengthSq = 0.0f;
+			for (uint32 Channel = FirstChannel; Channel < FirstChannel + NumChannels; ++Channel)
+			{
+				Direction[Channel] = (float)(E1[Channel] - E0[Channel]);
+				LengthSq += Direction[Channel] * Direction[Channel];
+			}
+			float Scale = LengthSq > 0.0f ? (float)(NumWeights - 1) / LengthSq : 0.0f;
+
+			uint32 TotalError = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				uint32 First = 0;
+				uint32 Last = NumWeights - 1;
+				if (!bExhaustive)
+				{
+					float T = 0.0f;
+					for (uint32 Channel = FirstChannel; Channel < FirstChannel + NumChannels; ++Channel)
+					{
+						T += ((float)Block[Index][Channel] - (float)E0[Channel]) * Direction[Channel];
+					}
+					int32 Guess = Min(Max((int32)(T * Scale + 0.5f), 0), (int32)NumWeights - 1);
+					First = (uint32)Max(Guess - 1, 0);
+					Last = (uint32)Min(Guess + 1, (int32)NumWeights - 1);
+				}
+
+				uint32 BestError = 0xffffffff;
+				for (uint32 Entry = First; Entry <= Last; ++Entry)
+				{
+					uint32 Error = 0;
+					for (uint32 Channel = FirstChannel; Channel < FirstChannel + NumChannels; ++Channel)
+					{
+						int32 Delta = (int32)Block[Index][Channel] - Palette[Entry][Channel];
+						Error += (uint32)(Delta * Delta);
+					}
+					if (Error < BestError)
+					{
+						BestError = Error;
+						OutIndices[Index] = (uint8)Entry;
+					}
+				}
+				TotalError += BestError;
+			}
+			return TotalError;
+		}
+
+		struct FBC7Mode6
+		{
+			int32 Endpoints[2][4];
+			uint32 PBits[2];
+			uint8 Indices[16];
+			uint32 Error;
+		};
+
+		// 7 bit endpoint plus a shared p-bit, picking the p-bit that lands closest over all four channels
+		inline void QuantizeMode6Endpoint(const float (&Endpoint)[4], int32 (&OutEndpoint)[4], uint32& OutPBit)
+		{
+			float BestError = FLT_MAX;
+			for (uint32 PBit = 0; PBit < 2; ++PBit)
+			{
+				int32 Quantized[4];
+				float Error = 0.0f;
+				for (uint32 Channel = 0; Channel < 4; ++Channel)
+				{
+					int32 Value = Min(Max((int32)((Endpoint[Channel] - (float)PBit) * 0.5f + 0.5f), 0), 127);
+					Quantized[Channel] = (Value << 1) | (int32)PBit;
+					float Delta = (float)Quantized[Channel] - Endpoint[Channel];
+					Error += Delta * Delta;
+				}
+				if (Error < BestError)
+				{
+					BestError = Error;
+					OutPBit = PBit;
+					memcpy(OutEndpoint, Quantized, sizeof(Quantized));
+				}
+			}
+		}
+
+		inline void EncodeBC7Mode6(const uint8 (&Block)[16][4], const float (&Points)[16][4], EBC7Quality Quality, FBC7Mode6& Out)
+		{
+			float E0[4], E1[4];
+			FitEndpoints(Points, 4, E0, E1);
+			QuantizeMode6Endpoint(E0, Out.Endpoints[0], Out.PBits[0]);
+			QuantizeMode6Endpoint(E1, Out.Endpoints[1], Out.PBits[1]);
+			bool bExhaustive = Quality == EBC7Quality::High;
+			Out.Error = SelectBC7Indices(Block, 0, 4, Out.Endpoints[0], Out.Endpoints[1], BC7Weights4, 16, bExhaustive, Out.Indices);
+
+			float Weights[16];
+			for (uint32 Entry = 0; Entry < 16; ++Entry)
+			{
+				Weights[Entry] = (float)BC7Weights4[Entry] / 64.0f;
+			}
+
+			uint32 NumRefinements = Quality == EBC7Quality::Fast ? 0 : (Quality == EBC7Quality::Normal ? 1 : 2);
+			for (uint32 Refinement = 0; Refinement < NumRefinements && Out.Error > 0; ++Refinement)
+			{
+				if (!RefineEndpoints(Points, 4, Out.Indices, Weights, E0, E1))
+				{
+					break;
+				}
+
+				FBC7Mode6 Candidate;
+				QuantizeMode6Endpoint(E0, Candidate.Endpoints[0], Candidate.PBits[0]);
+				QuantizeMode6Endpoint(E1, Candidate.Endpoints[1], Candidate.PBits[1]);
+				Candidate.Error = SelectBC7Indices(Block, 0, 4, Candidate.Endpoints[0], Candidate.Endpoints[1], BC7Weights4, 16, bExhaustive, Candidate.Indices);
+				if (Candidate.Error >= Out.Error)
+				{
+					break;
+				}
+				Out = Candidate;
+			}
+		}
+
+		inline void WriteBC7Mode6(FBC7Mode6 Mode, uint8* Out)
+		{
+			// The first index is stored without its top bit, so it must be below 8
+			if (Mode.Indices[0] >= 8)
+			{
+				std::swap(Mode.Endpoints[0], Mode.Endpoints[1]);
+				std::swap(Mode.PBits[0], Mode.PBits[1]);
+				for (uint32 Index = 0; Index < 16; ++Index)
+				{
+					Mode.Indices[Index] = (uint8)(15 - Mode.Indices[Index]);
+				}
+			}
+
+			FBlockBitWriter Writer;
+			Writer.Write(1 << 6, 7);
+			for (uint32 Channel = 0; Channel < 4; ++Channel)
+			{
+				Writer.Write((uint32)Mode.Endpoints[0][Channel] >> 1, 7);
+				Writer.Write((uint32)Mode.Endpoints[1][Channel] >> 1, 7);
+			}
+			Writer.Write(Mode.PBits[0], 1);
+			Writer.Write(Mode.PBits[1], 1);
+			Writer.Write(Mode.Indices[0], 3);
+			for (uint32 Index = 1; Index < 16; ++Index)
+			{
+				Writer.Write(Mode.Indices[Index], 4);
+			}
+			memcpy(Out, Writer.Bytes, 16);
+		}
+
+		struct FBC7Mode5
+		{
+			uint32 Rotation;
+			int32 Endpoints[2][4];
+			uint8 ColorIndices[16];
+			uint8 AlphaIndices[16];
+			uint32 Error;
+		};
+
+		inline int32 QuantizeMode5Color(float Value)
+		{
+			int32 Quantized = Min(Max((int32)(Value * (127.0f / 255.0f) + 0.5f), 0), 127);
+			return (Quantized << 1) | (Quantized >> 6);
+		}
+
+		// Mode 5 codes RGB and A with separate index sets; Rotation swaps A with R, G or B first, so the
+		// channel that varies independently gets its own indices
+		inline void EncodeBC7Mode5(const uint8 (&SourceBlock)[16][4], uint32 Rotation, EBC7Quality Quality, FBC7Mode5& Out)
+		{
+			uint8 Block[16][4];
+			memcpy(Block, SourceBlock, sizeof(Block));
+			if (Rotation > 0)
+			{
+				for (uint32 Index = 0; Index < 16; ++Index)
+				{
+					std::swap(Block[Index][3], Block[Index][Rotation - 1]);
+				}
+			}
+
+			float Points[16][4];
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				for (uint32 Channel = 0; Channel < 4; ++Channel)
+				{
+					Points[Index][Channel] = Channel < 3 ? (float)Block[Index][Channel] : 0.0f;
+				}
+			}
+
+			float E0[4], E1[4];
+			FitEndpoints(Points, 3, E0, E1);
+			Out.Rotation = Rotation;
+			for (uint32 Channel = 0; Channel < 3; ++Channel)
+			{
+				Out.Endpoints[0][Channel] = QuantizeMode5Color(E0[Channel]);
+				Out.Endpoints[1][Channel] = QuantizeMode5Color(E1[Channel]);
+			}
+
+			bool bExhaustive = Quality == EBC7Quality::High;
+			uint32 ColorError = SelectBC7Indices(Block, 0, 3, Out.Endpoints[0], Out.Endpoints[1], BC7Weights2, 4, bExhaustive, Out.ColorIndices);
+			float Weights[4];
+			for (uint32 Entry = 0; Entry < 4; ++Entry)
+			{
+				Weights[Entry] = (float)BC7Weights2[Entry] / 64.0f;
+			}
+			if (ColorError > 0 && RefineEndpoints(Points, 3, Out.ColorIndices, Weights, E0, E1))
+			{
+				int32 Refined[2][4] = {};
+				for (uint32 Channel = 0; Channel < 3; ++Channel)
+				{
+					Refined[0][Channel] = QuantizeMode5Color(E0[Channel]);
+					Refined[1][Channel] = QuantizeMode5Color(E1[Channel]);
+				}
+
+				uint8 Indices[16];
+				uint32 Error = SelectBC7Indices(Block, 0, 3, Refined[0], Refined[1], BC7Weights2, 4, bExhaustive, Indices);
+				if (Error < ColorError)
+				{
+					ColorError = Error;
+					memcpy(Out.Endpoints, Refined, sizeof(Refined));
+					memcpy(Out.ColorIndices, Indices, sizeof(Indices));
+				}
+			}
+
+			uint8 MinAlpha = 255;
+			uint8 MaxAlpha = 0;
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				MinAlpha = Min(MinAlpha, Block[Index][3]);
+				MaxAlpha = Max(MaxAlpha, Block[Index][3]);
+			}
+			Out.Endpoints[0][3] = MinAlpha;
+			Out.Endpoints[1][3] = MaxAlpha;
+			uint32 AlphaError = SelectBC7Indices(Block, 3, 1, Out.Endpoints[0], Out.Endpoints[1], BC7Weights2, 4, true, Out.AlphaIndices);
+			Out.Error = ColorError + AlphaError;
+		}
+
+		inline void WriteBC7Mode5(FBC7Mode5 Mode, uint8* Out)
+		{
+			if (Mode.ColorIndices[0] >= 2)
+			{
+				for (uint32 Channel = 0; Channel < 3; ++Channel)
+				{
+					std::swap(Mode.Endpoints[0][Channel], Mode.Endpoints[1][Channel]);
+				}
+				for (uint32 Index = 0; Index < 16; ++Index)
+				{
+					Mode.ColorIndices[Index] = (uint8)(3 - Mode.ColorIndices[Index]);
+				}
+			}
+			if (Mode.AlphaIndices[0] >= 2)
+			{
+				std::swap(Mode.Endpoints[0][3], Mode.Endpoints[1][3]);
+				for (uint32 Index = 0; Index < 16; ++Index)
+				{
+					Mode.AlphaIndices[Index] = (uint8)(3 - Mode.AlphaIndices[Index]);
+				}
+			}
+
+			FBlockBitWriter Writer;
+			Writer.Write(1 << 5, 6);
+			Writer.Write(Mode.Rotation, 2);
+			for (uint32 Channel = 0; Channel < 3; ++Channel)
+			{
+				Writer.Write((uint32)Mode.Endpoints[0][Channel] >> 1, 7);
+				Writer.Write((uint32)Mode.Endpoints[1][Channel] >> 1, 7);
+			}
+			Writer.Write((uint32)Mode.Endpoints[0][3], 8);
+			Writer.Write((uint32)Mode.Endpoints[1][3], 8);
+			Writer.Write(Mode.ColorIndices[0], 1);
+			for (uint32 Index = 1; Index < 16; ++Index)
+			{
+				Writer.Write(Mode.ColorIndices[Index], 2);
+			}
+			Writer.Write(Mode.AlphaIndices[0], 1);
+			for (uint32 Index = 1; Index < 16; ++Index)
+			{
+				Writer.Write(Mode.AlphaIndices[Index], 2);
+			}
+			memcpy(Out, Writer.Bytes, 16);
+		}
+
+		inline void EncodeBC7(const uint8 (&Block)[16][4], uint8* Out, EBC7Quality Quality)
+		{
+			float Points[16][4];
+			for (uint32 Index = 0; Index < 16; ++Index)
+			{
+				for (uint32 Channel = 0; Channel < 4; ++Channel)
+				{
+					Points[Index][Channel] = (float)Block[Index][Channel];
+				}
+			}
+
+			FBC7Mode6 Mode6;
+			EncodeBC7Mode6(Block, Points, Quality, Mode6);
+			bool bVaryingAlpha = false;
+			for (uint32 Index = 1; Index < 16; ++Index)
+			{
+				bVaryingAlpha |= Block[Index][3] != Block[0][3];
+			}
+
+			// Mode 5 without rotation covers alpha that does not follow the color; High also tries giving R, G or B
+			// the separate indices
+			uint32 NumRotations = Quality == EBC7Quality::High ? 4 : (Quality == EBC7Quality::Normal && bVaryingAlpha ? 1 : 0);
+			if (NumRotations > 0 && Mode6.Error > 0)
+			{
+				FBC7Mode5 BestMode5;
+				BestMode5.Error = 0xffffffff;
+				for (uint32 Rotation = 0; Rotation < NumRotations; ++Rotation)
+				{
+					FBC7Mode5 Mode5;
+					EncodeBC7Mode5(Block, Rotation, Quality, Mode5);
+					if (Mode5.Error < BestMode5.Error)
+					{
+						BestMode5 = Mode5;
+					}
+				}
+
+				if (BestMode5.Error < Mode6.Error)
+				{
+					WriteBC7Mode5(BestMode5, Out);
+					return;
+				}
+			}
+			WriteBC7Mode6(Mode6, Out);
+		}
+	}
+
+	// Compresses one 4x4 RGBA8 block (row major) into GetBlockBytes(Format) bytes
+	inline void CompressBlock(ETextureFormat Format, const uint8 (&Block)[16][4], uint8* Out, EBC7Quality BC7Quality = EBC7Quality::Normal)
+	{
+		using namespace Internal;
+		uint8 Values[16];
+		switch (Format)
+		{
+		case ETextureFormat::BC1:
+			EncodeBC1(Block, Out);
+			break;
+		case ETextureFormat::BC3:
+			ExtractChannel(Block, 3, Values);
+			EncodeBC4(Values, Out);
+			EncodeBC1(Block, Out + 8);
+			break;
+		case ETextureFormat::BC4:
+			ExtractChannel(Block, 0, Values);
+			EncodeBC4(Values, Out);
+			break;
+		case ETextureFormat::BC5:
+			ExtractChannel(Block, 0, Values);
+			EncodeBC4(Values, Out);
+			ExtractChannel(Block, 1, Values);
+			EncodeBC4(Values, Out + 8);
+			break;
+		case ETextureFormat::BC7:
+			EncodeBC7(Block, Out, BC7Quality);
+			break;
+		}
+	}
+
+	// Compresses every mip into Out (GetCompressedMipChainSize bytes, mips back to back). Work is split into
+	// block rows across all mips so the small tail mips do not serialize at the end.
+	inline void CompressMipChain(ETextureFormat Format, const FImageView* Mips, uint32 NumMips, uint8* Out, const FTextureCompressSettings& Settings = FTextureCompressSettings())
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		struct FRowTask
+		{
+			uint32 Mip;
+			uint32 BlockY;
+			size_t Offset;
+		};
+
+		uint32 BlockBytes = GetBlockBytes(Format);
+		std::vector<FRowTask> Tasks;
+		size_t Offset = 0;
+		for (uint32 Mip = 0; Mip < NumMips; ++Mip)
+		{
+			checkAlways(Mips[Mip].Width > 0 && Mips[Mip].Height > 0 && Mips[Mip].RowPitch >= Mips[Mip].Width * 4);
+			uint32 BlocksX = (Mips[Mip].Width + 3) / 4;
+			uint32 BlocksY = (Mips[Mip].Height + 3) / 4;
+			for (uint32 BlockY = 0; BlockY < BlocksY; ++BlockY)
+			{
+				Tasks.push_back({ Mip, BlockY, Offset });
+				Offset += (size_t)BlocksX * BlockBytes;
+			}
+		}
+
+		ParallelFor((uint32)Tasks.size(), [&](uint32 TaskIndex)
+		{
+			const FRowTask& Task = Tasks[TaskIndex];
+			const FImageView& Image = Mips[Task.Mip];
+			uint32 BlocksX = (Image.Width + 3) / 4;
+			uint8* RowOut = Out + Task.Offset;
+			for (uint32 BlockX = 0; BlockX < BlocksX; ++BlockX)
+			{
+				uint8 Block[16][4];
+				Internal::LoadBlock(Image, BlockX, Task.BlockY, Block);
+				CompressBlock(Format, Block, RowOut + BlockX * BlockBytes, Settings.BC7Quality);
+			}
+		}, Settings.NumThreads);
+	}
+
+	inline void CompressImage(ETextureFormat Format, const FImageView& Image, uint8* Out, const FTextureCompressSettings& Settings = FTextureCompressSettings())
+	{
+		CompressMipChain(Format, &Image, 1, Out, Settings);
+	}
+
+	// 2x2 box filter into a tightly packed (Width / 2) x (Height / 2) RGBA8 image; odd edges reuse the last texel
+	inline void GenerateMip(const FImageView& Source, uint8* OutPixels)
+	{
+		uint32 Width = Max(Source.Width >> 1, 1u);
+		uint32 Height = Max(Source.Height >> 1, 1u);
+		for (uint32 Y = 0; Y < Height; ++Y)
+		{
+			const uint8* Row0 = Source.Pixels + (size_t)Min(Y * 2, Source.Height - 1) * Source.RowPitch;
+			const uint8* Row1 = Source.Pixels + (size_t)Min(Y * 2 + 1, Source.Height - 1) * Source.RowPitch;
+			for (uint32 X = 0; X < Width; ++X)
+			{
+				uint32 X0 = Min(X * 2, Source.Width - 1) * 4;
+				uint32 X1 = Min(X * 2 + 1, Source.Width - 1) * 4;
+				for (uint32 Channel = 0; Channel < 4; ++Channel)
+				{
+					uint32 Sum = Row0[X0 + Channel] + Row0[X1 + Channel] + Row1[X0 + Channel] + Row1[X1 + Channel];
+					OutPixels[((size_t)Y * Width + X) * 4 + Channel] = (uint8)((Sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	// Fills OutPixels with mips 1..NumMips-1 of Base (tightly packed, back to back) and OutMips with views of all
+	// NumMips levels, Base included
+	inline void GenerateMipChain(const FImageView& Base, uint32 NumMips, std::vector<uint8>& OutPixels, std::vector<FImageView>& OutMips)
+	{
+		RCUTILS_PROFILE_FUNCTION();
+		std::vector<size_t> Offsets(NumMips, 0);
+		size_t Size = 0;
+		for (uint32 Mip = 1; Mip < NumMips; ++Mip)
+		{
+			Offsets[Mip] = Size;
+			Size += (size_t)Max(Base.Width >> Mip, 1u) * Max(Base.Height >> Mip, 1u) * 4;
+		}
+		OutPixels.resize(Size);
+
+		OutMips.resize(NumMips);
+		OutMips[0] = Base;
+		for (uint32 Mip = 1; Mip < NumMips; ++Mip)
+		{
+			FImageView& View = OutMips[Mip];
+			View.Pixels = OutPixels.data() + Offsets[Mip];
+			View.Width = Max(Base.Width >> Mip, 1u);
+			View.Height = Max(Base.Height >> Mip, 1u);
+			View.RowPitch = View.Width * 4;
+			GenerateMip(OutMips[Mip - 1], (uint8*)View.Pixels);
+		}
+	}
+}
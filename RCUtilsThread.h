@@ -0,0 +1,670 @@
+#pragma once
+
+#include "RCUtilsBit.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32) && defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+// WaitOnAddress/WakeByAddress* live in Synchronization.lib
+#pragma comment(lib, "Synchronization.lib")
+#endif
+
+namespace RCUtils
+{
+	enum
+	{
+		CacheLineSize = 64,
+	};
+
+	// Sleeps while *Address == Expected; may return spuriously so callers must re-check their condition
+	inline void FutexWait(std::atomic<uint32>* Address, uint32 Expected)
+	{
+#if defined(_WIN32)
+		::WaitOnAddress((volatile VOID*)Address, &Expected, sizeof(Expected), INFINITE);
+#elif defined(__linux__)
+		syscall(SYS_futex, (uint32*)Address, FUTEX_WAIT_PRIVATE, Expected, nullptr, nullptr, 0);
+#else
+		if (Address->load(std::memory_order_acquire) == Expected)
+		{
+			std::this_thread::yield();
+		}
+#endif
+	}
+
+	inline void FutexWakeOne(std::atomic<uint32>* Address)
+	{
+#if defined(_WIN32)
+		::WakeByAddressSingle((PVOID)Address);
+#elif defined(__linux__)
+		syscall(SYS_futex, (uint32*)Address, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+		(void)Address;
+#endif
+	}
+
+	inline void FutexWakeAll(std::atomic<uint32>* Address)
+	{
+#if defined(_WIN32)
+		::WakeByAddressAll((PVOID)Address);
+#elif defined(__linux__)
+		syscall(SYS_futex, (uint32*)Address, FUTEX_WAKE_PRIVATE, 0x7fffffff, nullptr, nullptr, 0);
+#else
+		(void)Address;
+#endif
+	}
+
+	inline uint32 GetNumHardwareThreads()
+	{
+		return Max<uint32>(std::thread::hardware_concurrency(), 1);
+	}
+
+	namespace Internal
+	{
+		// One ParallelFor call. Lives on the caller's stack, which only returns once every helper that joined
+		// has left.
+		struct FParallelForJob
+		{
+			void (*Run)(const void* Func, uint32 Index);
+			const void* Func;
+			uint32 Num;
+			uint32 MaxHelpers;
+
+			// Guarded by the pool mutex
+			uint32 NumJoined = 0;
+
+			std::atomic<uint32> NextIndex{0};
+			std::atomic<uint32> NumActiveHelpers{0};
+
+			void Execute()
+			{
+				for (uint32 Index = NextIndex.fetch_add(1, std::memory_order_relaxed); Index < Num; Index = NextIndex.fetch_add(1, std::memory_order_relaxed))
+				{
+					Run(Func, Index);
+				}
+			}
+		};
+	}
+
+	// Persistent workers behind ParallelFor. Workers are started on demand, up to the most helpers any call
+	// asked for (one per hardware thread besides the caller by default), and then kept. Reusing them keeps small
+	// parallel loops from paying for thread creation and keeps thread_local state (profiler buffers, scratch
+	// memory) from being rebuilt on every call.
+	class FThreadPool
+	{
+	public:
+		static FThreadPool& Get()
+		{
+			static FThreadPool Instance;
+			return Instance;
+		}
+
+		FThreadPool() = default;
+		FThreadPool(const FThreadPool&) = delete;
+		FThreadPool& operator = (const FThreadPool&) = delete;
+
+		~FThreadPool()
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				bStop = true;
+			}
+			WakeCondition.notify_all();
+			for (auto& Worker : Workers)
+			{
+				Worker.join();
+			}
+		}
+
+		// Runs the job on the calling thread, helped by up to Job.MaxHelpers idle workers. A caller that is itself
+		// a worker (nested ParallelFor) can always finish its job alone, so nesting never deadlocks.
+		void Run(Internal::FParallelForJob& Job)
+		{
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				while (Workers.size() < Job.MaxHelpers)
+				{
+					Workers.emplace_back([this]() { WorkerLoop(); });
+				}
+				Jobs.push_back(&Job);
+			}
+			for (uint32 Index = 0; Index < Job.MaxHelpers; ++Index)
+			{
+				WakeCondition.notify_one();
+			}
+
+			Job.Execute();
+
+			// Once the job is off the list no new helper can join; the ones that did may still be on their last index
+			{
+				std::lock_guard<std::mutex> Lock(Mutex);
+				Jobs.erase(std::find(Jobs.begin(), Jobs.end(), &Job));
+			}
+			for (uint32 Active = Job.NumActiveHelpers.load(std::memory_order_acquire); Active != 0; Active = Job.NumActiveHelpers.load(std::memory_order_acquire))
+			{
+				FutexWait(&Job.NumActiveHelpers, Active);
+			}
+		}
+
+	protected:
+		// Newest first, so a nested loop gets help before the outer one hands out more work
+		Internal::FParallelForJob* FindJob() const
+		{
+			for (auto It = Jobs.rbegin(); It != Jobs.rend(); ++It)
+			{
+				Internal::FParallelForJob* Job = *It;
+				if (Job->NumJoined < Job->MaxHelpers && Job->NextIndex.load(std::memory_order_relaxed) < Job->Num)
+				{
+					return Job;
+				}
+			}
+			return nullptr;
+		}
+
+		void WorkerLoop()
+		{
+			std::unique_lock<std::mutex> Lock(Mutex);
+			while (true)
+			{
+				Internal::FParallelForJob* Job = nullptr;
+				WakeCondition.wait(Lock, [&]() { return bStop || (Job = FindJob()) != nullptr; });
+				if (bStop)
+				{
+					return;
+				}
+
+				++Job->NumJoined;
+				Job->NumActiveHelpers.fetch_add(1, std::memory_order_relaxed);
+				Lock.unlock();
+				Job->Execute();
+
+				// The job may be gone as soon as the count drops; waking a stale address is harmless since futex
+				// waiters always re-check their condition
+				std::atomic<uint32>* NumActiveHelpers = &Job->NumActiveHelpers;
+				if (NumActiveHelpers->fetch_sub(1, std::memory_order_release) == 1)
+				{
+					FutexWakeAll(NumActiveHelpers);
+				}
+				Lock.lock();
+			}
+		}
+
+		std::mutex Mutex;
+		std::condition_variable WakeCondition;
+		std::vector<Internal::FParallelForJob*> Jobs;
+		std::vector<std::thread> Workers;
+		bool bStop = false;
+	};
+
+	// Calls Func(Index) for every Index in [0, Num) from up to NumThreads threads (0 = one per hardware
+	// thread) of the shared FThreadPool. The calling thread takes part and indices are handed out dynamically,
+	// so uneven work balances.
+	template <typename TFunc>
+	inline void ParallelFor(uint32 Num, const TFunc& Func, uint32 NumThreads = 0)
+	{
+		NumThreads = NumThreads ? NumThreads : GetNumHardwareThreads();
+		NumThreads = Min(NumThreads, Num);
+		if (NumThreads <= 1)
+		{
+			for (uint32 Index = 0; Index < Num; ++Index)
+			{
+				Func(Index);
+			}
+			return;
+		}
+
+		Internal::FParallelForJob Job;
+		Job.Run = [](const void* InFunc, uint32 Index) { (*(const TFunc*)InFunc)(Index); };
+		Job.Func = &Func;
+		Job.Num = Num;
+		Job.MaxHelpers = NumThreads - 1;
+		FThreadPool::Get().Run(Job);
+	}
+
+	// Bounded single producer/single consumer ring; TryPush/TryPop are wait-free.
+	// Each side keeps a cached copy of the other side's index so the shared cache line is only
+	// touched when the queue looks full (producer) or empty (consumer).
+	template <typename T>
+	class TSPSCQueue
+	{
+	public:
+		// Capacity is rounded up to the next power of two
+		explicit TSPSCQueue(uint32 InCapacity)
+		{
+			Capacity = (uint32)RoundUpToPowerOfTwo(Max<uint32>(InCapacity, 2));
+			Mask = Capacity - 1;
+			Data = (T*)::operator new(sizeof(T) * Capacity);
+		}
+
+		TSPSCQueue(const TSPSCQueue&) = delete;
+		TSPSCQueue& operator = (const TSPSCQueue&) = delete;
+
+		~TSPSCQueue()
+		{
+			uint32 Head = ConsumerHead.load(std::memory_order_relaxed);
+			uint32 Tail = ProducerTail.load(std::memory_order_relaxed);
+			for (; Head != Tail; ++Head)
+			{
+				Data[Head & Mask].~T();
+			}
+			::operator delete(Data);
+		}
+
+		bool TryPush(const T& Value)
+		{
+			T Copy(Value);
+			return TryPush(std::move(Copy));
+		}
+
+		// Value is only moved from on success
+		bool TryPush(T&& Value)
+		{
+			uint32 Tail = ProducerTail.load(std::memory_order_relaxed);
+			if (Tail - CachedHead == Capacity)
+			{
+				CachedHead = ConsumerHead.load(std::memory_order_acquire);
+				if (Tail - CachedHead == Capacity)
+				{
+					return false;
+				}
+			}
+
+			new (Data + (Tail & Mask)) T(std::move(Value));
+			ProducerTail.store(Tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Moves as many of Values as fit and publishes them with a single store; returns how many were pushed
+		uint32 TryPushBatch(T* Values, uint32 Num)
+		{
+			uint32 Tail = ProducerTail.load(std::memory_order_relaxed);
+			uint32 Free = Capacity - (Tail - CachedHead);
+			if (Free < Num)
+			{
+				CachedHead = ConsumerHead.load(std::memory_order_acquire);
+				Free = Capacity - (Tail - CachedHead);
+			}
+
+			uint32 NumToPush = Min(Free, Num);
+			for (uint32 Index = 0; Index < NumToPush; ++Index)
+			{
+				new (Data + ((Tail + Index) & Mask)) T(std::move(Values[Index]));
+			}
+			ProducerTail.store(Tail + NumToPush, std::memory_order_release);
+			return NumToPush;
+		}
+
+		bool TryPop(T& OutValue)
+		{
+			uint32 Head = ConsumerHead.load(std::memory_order_relaxed);
+			if (Head == CachedTail)
+			{
+				CachedTail = ProducerTail.load(std::memory_order_acquire);
+				if (Head == CachedTail)
+				{
+					return false;
+				}
+			}
+
+			T& Element = Data[Head & Mask];
+			OutValue = std::move(Element);
+			Element.~T();
+			ConsumerHead.store(Head + 1, std::memory_order_release);
+			return true;
+		}
+
+		uint32 TryPopBatch(T* OutValues, uint32 MaxNum)
+		{
+			uint32 Head = ConsumerHead.load(std::memory_order_relaxed);
+			uint32 Available = CachedTail - Head;
+			if (Available < MaxNum)
+			{
+				CachedTail = ProducerTail.load(std::memory_order_acquire);
+				Available = CachedTail - Head;
+			}
+
+			uint32 NumToPop = Min(Available, MaxNum);
+			for (uint32 Index = 0; Index < NumToPop; ++Index)
+			{
+				T& Element = Data[(Head + Index) & Mask];
+				OutValues[Index] = std::move(Element);
+				Element.~T();
+			}
+			ConsumerHead.store(Head + NumToPop, std::memory_order_release);
+			return NumToPop;
+		}
+
+		// Only exact when called from the producer or consumer thread with the other side idle
+		uint32 SizeApprox() const
+		{
+			return ProducerTail.load(std::memory_order_acquire) - ConsumerHead.load(std::memory_order_acquire);
+		}
+
+		uint32 GetCapacity() const
+		{
+			return Capacity;
+		}
+
+	protected:
+		// Producer owned
+		std::atomic<uint32> ProducerTail{0};
+		uint32 CachedHead = 0;
+		uint8 Pad0[CacheLineSize - sizeof(std::atomic<uint32>) - sizeof(uint32)];
+
+		// Consumer owned
+		std::atomic<uint32> ConsumerHead{0};
+		uint32 CachedTail = 0;
+		uint8 Pad1[CacheLineSize - sizeof(std::atomic<uint32>) - sizeof(uint32)];
+
+		// Read only after construction
+		T* Data = nullptr;
+		uint32 Capacity = 0;
+		uint32 Mask = 0;
+	};
+
+	// Bounded multi producer/multi consumer array queue (Dmitry Vyukov's design): every cell carries a
+	// sequence number that tells producers and consumers whether it is free for the current lap.
+	template <typename T>
+	class TMPMCQueue
+	{
+	public:
+		// Capacity is rounded up to the next power of two
+		explicit TMPMCQueue(uint32 InCapacity)
+		{
+			Capacity = (uint32)RoundUpToPowerOfTwo(Max<uint32>(InCapacity, 2));
+			Mask = Capacity - 1;
+			Cells = (FCell*)::operator new(sizeof(FCell) * Capacity);
+			for (uint32 Index = 0; Index < Capacity; ++Index)
+			{
+				new (&Cells[Index].Sequence) std::atomic<uint32>(Index);
+			}
+		}
+
+		TMPMCQueue(const TMPMCQueue&) = delete;
+		TMPMCQueue& operator = (const TMPMCQueue&) = delete;
+
+		~TMPMCQueue()
+		{
+			uint32 Pos = DequeuePos.load(std::memory_order_relaxed);
+			uint32 End = EnqueuePos.load(std::memory_order_relaxed);
+			for (; Pos != End; ++Pos)
+			{
+				((T*)Cells[Pos & Mask].Storage)->~T();
+			}
+			::operator delete(Cells);
+		}
+
+		bool TryPush(const T& Value)
+		{
+			T Copy(Value);
+			return TryPush(std::move(Copy));
+		}
+
+		// Value is only moved from on success
+		bool TryPush(T&& Value)
+		{
+			FCell* Cell = nullptr;
+			uint32 Pos = EnqueuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell = &Cells[Pos & Mask];
+				uint32 Sequence = Cell->Sequence.load(std::memory_order_acquire);
+				int32 Diff = (int32)(Sequence - Pos);
+				if (Diff == 0)
+				{
+					if (EnqueuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (Diff < 0)
+				{
+					// Full
+					return false;
+				}
+				else
+				{
+					Pos = EnqueuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			new (Cell->Storage) T(std::move(Value));
+			Cell->Sequence.store(Pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool TryPop(T& OutValue)
+		{
+			FCell* Cell = nullptr;
+			uint32 Pos = DequeuePos.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell = &Cells[Pos & Mask];
+				uint32 Sequence = Cell->Sequence.load(std::memory_order_acquire);
+				int32 Diff = (int32)(Sequence - (Pos + 1));
+				if (Diff == 0)
+				{
+					if (DequeuePos.compare_exchange_weak(Pos, Pos + 1, std::memory_order_relaxed))
+					{
+						break;
+					}
+				}
+				else if (Diff < 0)
+				{
+					// Empty
+					return false;
+				}
+				else
+				{
+					Pos = DequeuePos.load(std::memory_order_relaxed);
+				}
+			}
+
+			T* Element = (T*)Cell->Storage;
+			OutValue = std::move(*Element);
+			Element->~T();
+			Cell->Sequence.store(Pos + Mask + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Cells are claimed one at a time (consumers may free them out of order), so a batch is not atomic
+		uint32 TryPushBatch(T* Values, uint32 Num)
+		{
+			uint32 NumPushed = 0;
+			while (NumPushed < Num && TryPush(std::move(Values[NumPushed])))
+			{
+				++NumPushed;
+			}
+			return NumPushed;
+		}
+
+		uint32 TryPopBatch(T* OutValues, uint32 MaxNum)
+		{
+			uint32 NumPopped = 0;
+			while (NumPopped < MaxNum && TryPop(OutValues[NumPopped]))
+			{
+				++NumPopped;
+			}
+			return NumPopped;
+		}
+
+		uint32 SizeApprox() const
+		{
+			int32 Size = (int32)(EnqueuePos.load(std::memory_order_relaxed) - DequeuePos.load(std::memory_order_relaxed));
+			return (uint32)Max(Size, 0);
+		}
+
+		uint32 GetCapacity() const
+		{
+			return Capacity;
+		}
+
+	protected:
+		struct FCell
+		{
+			std::atomic<uint32> Sequence;
+			alignas(T) uint8 Storage[sizeof(T)];
+		};
+
+		FCell* Cells = nullptr;
+		uint32 Capacity = 0;
+		uint32 Mask = 0;
+		uint8 Pad0[CacheLineSize];
+
+		std::atomic<uint32> EnqueuePos{0};
+		uint8 Pad1[CacheLineSize - sizeof(std::atomic<uint32>)];
+
+		std::atomic<uint32> DequeuePos{0};
+		uint8 Pad2[CacheLineSize - sizeof(std::atomic<uint32>)];
+	};
+
+	// Adds blocking Push/Pop on top of TSPSCQueue or TMPMCQueue. Threads spin briefly and then sleep on a
+	// futex (WaitOnAddress on Windows); the wake syscall is skipped when nobody is sleeping.
+	template <typename TQueue, typename T>
+	class TBlockingQueue
+	{
+	public:
+		explicit TBlockingQueue(uint32 InCapacity, uint32 InSpinCount = 256)
+			: Queue(InCapacity)
+			, SpinCount(InSpinCount)
+		{
+		}
+
+		void Push(T&& Value)
+		{
+			uint32 Spins = 0;
+			for (;;)
+			{
+				uint32 Epoch = PopEpoch.load(std::memory_order_seq_cst);
+				if (Queue.TryPush(std::move(Value)))
+				{
+					break;
+				}
+
+				if (Spins++ < SpinCount)
+				{
+					continue;
+				}
+
+				NumWaitingProducers.fetch_add(1, std::memory_order_seq_cst);
+				FutexWait(&PopEpoch, Epoch);
+				NumWaitingProducers.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			PushEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (NumWaitingConsumers.load(std::memory_order_seq_cst) > 0)
+			{
+				FutexWakeOne(&PushEpoch);
+			}
+		}
+
+		void Push(const T& Value)
+		{
+			T Copy(Value);
+			Push(std::move(Copy));
+		}
+
+		bool TryPush(T&& Value)
+		{
+			if (!Queue.TryPush(std::move(Value)))
+			{
+				return false;
+			}
+
+			PushEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (NumWaitingConsumers.load(std::memory_order_seq_cst) > 0)
+			{
+				FutexWakeOne(&PushEpoch);
+			}
+			return true;
+		}
+
+		// Returns false only once the queue has been closed and drained
+		bool Pop(T& OutValue)
+		{
+			uint32 Spins = 0;
+			for (;;)
+			{
+				uint32 Epoch = PushEpoch.load(std::memory_order_seq_cst);
+				if (Queue.TryPop(OutValue))
+				{
+					break;
+				}
+
+				if (bClosed.load(std::memory_order_acquire))
+				{
+					return Queue.TryPop(OutValue) ? NotifyPopped() : false;
+				}
+
+				if (Spins++ < SpinCount)
+				{
+					continue;
+				}
+
+				NumWaitingConsumers.fetch_add(1, std::memory_order_seq_cst);
+				FutexWait(&PushEpoch, Epoch);
+				NumWaitingConsumers.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			return NotifyPopped();
+		}
+
+		bool TryPop(T& OutValue)
+		{
+			return Queue.TryPop(OutValue) ? NotifyPopped() : false;
+		}
+
+		// Wakes every sleeping consumer; Pop() returns false once the queue is empty
+		void Close()
+		{
+			bClosed.store(true, std::memory_order_release);
+			PushEpoch.fetch_add(1, std::memory_order_seq_cst);
+			FutexWakeAll(&PushEpoch);
+		}
+
+		bool IsClosed() const
+		{
+			return bClosed.load(std::memory_order_acquire);
+		}
+
+		TQueue& GetQueue()
+		{
+			return Queue;
+		}
+
+	protected:
+		bool NotifyPopped()
+		{
+			PopEpoch.fetch_add(1, std::memory_order_seq_cst);
+			if (NumWaitingProducers.load(std::memory_order_seq_cst) > 0)
+			{
+				FutexWakeOne(&PopEpoch);
+			}
+			return true;
+		}
+
+		TQueue Queue;
+		uint32 SpinCount;
+		std::atomic<bool> bClosed{false};
+		uint8 Pad0[CacheLineSize];
+
+		std::atomic<uint32> PushEpoch{0};
+		std::atomic<uint32> NumWaitingConsumers{0};
+		uint8 Pad1[CacheLineSize - 2 * sizeof(std::atomic<uint32>)];
+
+		std::atomic<uint32> PopEpoch{0};
+		std::atomic<uint32> NumWaitingProducers{0};
+		uint8 Pad2[CacheLineSize - 2 * sizeof(std::atomic<uint32>)];
+	};
+}